@@ -0,0 +1,147 @@
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/OrderGateway.h"
+#include "../src/implementations/BTreeOrderBook.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace order_matching;
+using namespace order_matching::utils;
+
+//
+// Producer-to-match latency through the order gateway: each producer stamps
+// an order just before sending it, the matching thread stamps it again once
+// the engine has applied it. Producers send at a fixed pace so the figures
+// show the gateway's own cost rather than the depth of a saturated queue;
+// the last line of each table runs unpaced for throughput.
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const size_t SYMBOLS = 4;
+
+struct LatencyResult {
+    std::vector<uint64_t> latencies;    // ns, one per order
+    double seconds;
+};
+
+// Each producer owns the ids [p * per_producer, (p + 1) * per_producer) and
+// cancels its own orders a while after sending them, so the books stay a
+// steady size. interval_ns = 0 sends as fast as the ring allows
+template <typename Gateway>
+LatencyResult run_gateway(size_t producers, size_t per_producer, uint64_t interval_ns) {
+    MatchingEngine engine;
+    for (size_t s = 0; s < SYMBOLS; ++s) {
+        std::string name = "SYM" + std::to_string(s);
+        SymbolId id = engine.create_order_book(name, std::make_unique<BTreeOrderBook<>>(name));
+        engine.get_order_book(id)->reserve(16384);
+    }
+
+    size_t total = producers * per_producer;
+    std::vector<uint64_t> sent(total);
+    LatencyResult result;
+    result.latencies.resize(total);
+
+    // sent[id] is written before the order is pushed, so the ring's release
+    // makes it visible here
+    Gateway gateway(engine, 65536);
+    gateway.set_command_handler([&sent, &result](const OrderCommand& c) {
+        if (c.type == CommandType::ADD) {
+            result.latencies[c.order.order_id] = now_ns() - sent[c.order.order_id];
+        }
+    });
+    gateway.start();
+
+    uint64_t begin = now_ns();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&gateway, &sent, p, per_producer, interval_ns] {
+            std::mt19937 rng(uint32_t(42 + p));
+            std::uniform_int_distribution<Price> offset_dist(1, 8);
+            const size_t lag = 2048;
+            Order::OrderId first = p * per_producer;
+            uint64_t next = now_ns();
+            for (Order::OrderId id = first; id < first + per_producer; ++id) {
+                Side side = (rng() & 1) ? BUY : SELL;
+                Price offset = offset_dist(rng);
+                Price price = side == BUY ? 10000 - offset : 10000 + offset;
+                if (rng() % 8 == 0) {
+                    price = side == BUY ? 10000 + 2 : 10000 - 2;
+                }
+                SymbolId symbol = SymbolId(id % SYMBOLS);
+
+                if (interval_ns > 0) {
+                    next += interval_ns;
+                    while (now_ns() < next) {
+                        cpu_relax();
+                    }
+                }
+                sent[id] = now_ns();
+                gateway.submit_order(symbol, id, side, price, 10);
+                if (id >= first + lag) {
+                    gateway.cancel_order(SymbolId((id - lag) % SYMBOLS), id - lag);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    gateway.stop();
+    result.seconds = (now_ns() - begin) / 1e9;
+    return result;
+}
+
+void report(const char* name, LatencyResult result) {
+    std::vector<uint64_t>& l = result.latencies;
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l[std::min(l.size() - 1, size_t(p * l.size()))]; };
+    std::cout << "  " << std::left << std::setw(26) << name << std::right
+              << std::setw(11) << pct(0.50) << std::setw(11) << pct(0.90) << std::setw(11) << pct(0.99)
+              << std::setw(11) << pct(0.999) << std::setw(11) << l.back()
+              << std::setw(9) << std::fixed << std::setprecision(2) << l.size() / result.seconds / 1e6
+              << std::endl;
+}
+
+void print_header(const char* title) {
+    std::cout << "\n=== " << title << " ===" << std::endl;
+    std::cout << "  " << std::left << std::setw(26) << "ns" << std::right
+              << std::setw(11) << "p50" << std::setw(11) << "p90" << std::setw(11) << "p99"
+              << std::setw(11) << "p99.9" << std::setw(11) << "max" << std::setw(9) << "M/s" << std::endl;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Order Gateway Latency Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Each producer paces one order every 2us; cores: " << std::thread::hardware_concurrency() << std::endl;
+
+    const size_t orders = 200000;
+    const uint64_t interval = 2000;
+
+    print_header("SPSC Gateway (1 feed handler)");
+    report("busy-spin", run_gateway<SpscOrderGateway<BusySpinWait>>(1, orders, interval));
+    report("backoff", run_gateway<SpscOrderGateway<BackoffWait>>(1, orders, interval));
+    report("busy-spin, unpaced", run_gateway<SpscOrderGateway<BusySpinWait>>(1, orders, 0));
+
+    print_header("MPSC Gateway (client sessions)");
+    for (size_t producers : {1, 2, 4}) {
+        std::string name = std::to_string(producers) + " session" + (producers == 1 ? "" : "s") + ", busy-spin";
+        report(name.c_str(), run_gateway<MpscOrderGateway<BusySpinWait>>(producers, orders / producers, interval));
+    }
+    report("4 sessions, backoff", run_gateway<MpscOrderGateway<BackoffWait>>(4, orders / 4, interval));
+    report("4 sessions, unpaced", run_gateway<MpscOrderGateway<BusySpinWait>>(4, orders / 4, 0));
+
+    std::cout << "\nBenchmarks complete!" << std::endl;
+    return 0;
+}
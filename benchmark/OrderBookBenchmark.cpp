@@ -1,27 +1,87 @@
 #include "../src/utils/Timer.h"
 #include "../src/implementations/BTreeOrderBook.h"
+#include "../src/implementations/PriceLadderOrderBook.h"
+#include "../src/core/Journal.h"
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/ShardedMatchingEngine.h"
+#include "../src/core/Snapshot.h"
 #include "../src/core/Order.h"
+#include "../src/utils/KeySearch.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <iomanip>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
 
 using namespace order_matching;
 using namespace order_matching::utils;
 
+// Allocation counter: every global operator new in this binary bumps it, so
+// a benchmark can report how many system allocations a phase made. Atomic
+// because the sharded engine allocates on its worker threads
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// over-aligned types (B-tree nodes) - keep the malloc'd block just below
+// the aligned address so delete can find it
+void* operator new(std::size_t size, std::align_val_t align) {
+    ++allocation_count;
+    size_t alignment = static_cast<size_t>(align);
+    void* raw = std::malloc(size + alignment + sizeof(void*));
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    if (p) {
+        std::free(static_cast<void**>(p)[-1]);
+    }
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept {
+    operator delete(p, align);
+}
+
 void benchmark_add_order_warmedup_book() {
     std::cout << "\n=== Benchmark: Add Order (Warmed Up) ===" << std::endl;
 
-    BTreeOrderBook book("AAPL");
+    BTreeOrderBook<> book("AAPL");
 
     // Warm-up with 1000 orders
     for (int i = 0; i < 1000; ++i) {
-        auto order = std::make_shared<Order>(i, BUY, 100.0 + (i % 100) * 0.01, 10, "AAPL");
+        auto order = std::make_shared<Order>(i, BUY, 10000 + (i % 100), 10, book.get_symbol_id());
         book.add_order(order);
     }
 
     // Measure adding one more order
-    auto order = std::make_shared<Order>(1000, BUY, 105.0, 10, "AAPL");
+    auto order = std::make_shared<Order>(1000, BUY, 10500, 10, book.get_symbol_id());
     Timer timer;
     book.add_order(order);
     double elapsed = timer.elapsed_microseconds();
@@ -34,13 +94,13 @@ void benchmark_add_order_warmedup_book() {
 void benchmark_add_order_full_book() {
     std::cout << "\n=== Benchmark: Add Order (Full Book - 100k orders) ===" << std::endl;
 
-    BTreeOrderBook book("AAPL");
+    BTreeOrderBook<> book("AAPL");
 
     // Fill with 100,000 orders at different price levels
     std::cout << "Building order book with 100,000 orders..." << std::endl;
     for (int i = 0; i < 100000; ++i) {
-        double price = 100.0 + (i % 1000) * 0.01;  // 1000 different price levels
-        auto order = std::make_shared<Order>(i, BUY, price, 10, "AAPL");
+        Price price = 10000 + (i % 1000);  // 1000 different price levels (cent ticks)
+        auto order = std::make_shared<Order>(i, BUY, price, 10, book.get_symbol_id());
         book.add_order(order);
 
         if ((i + 1) % 10000 == 0) {
@@ -49,7 +109,7 @@ void benchmark_add_order_full_book() {
     }
 
     // Measure adding one more order
-    auto order = std::make_shared<Order>(100000, BUY, 105.0, 10, "AAPL");
+    auto order = std::make_shared<Order>(100000, BUY, 10500, 10, book.get_symbol_id());
     Timer timer;
     book.add_order(order);
     double elapsed = timer.elapsed_microseconds();
@@ -62,23 +122,23 @@ void benchmark_add_order_full_book() {
 void benchmark_match_orders() {
     std::cout << "\n=== Benchmark: Match Orders ===" << std::endl;
 
-    BTreeOrderBook book("AAPL");
+    BTreeOrderBook<> book("AAPL");
 
     // Add buy orders
     for (int i = 0; i < 100; ++i) {
-        auto order = std::make_shared<Order>(i, BUY, 100.0 - i * 0.01, 10, "AAPL");
+        auto order = std::make_shared<Order>(i, BUY, 10000 - i, 10, book.get_symbol_id());
         book.add_order(order);
     }
 
     // Add sell orders
     for (int i = 100; i < 200; ++i) {
-        auto order = std::make_shared<Order>(i, SELL, 100.0 + (i - 100) * 0.01, 10, "AAPL");
+        auto order = std::make_shared<Order>(i, SELL, 10000 + (i - 100), 10, book.get_symbol_id());
         book.add_order(order);
     }
 
     std::cout << "Order book state before matching:" << std::endl;
-    std::cout << "  Best Bid: $" << book.get_best_bid() << std::endl;
-    std::cout << "  Best Ask: $" << book.get_best_ask() << std::endl;
+    std::cout << "  Best Bid: $" << book.get_instrument().to_price(book.get_best_bid()) << std::endl;
+    std::cout << "  Best Ask: $" << book.get_instrument().to_price(book.get_best_ask()) << std::endl;
 
     // Measure matching
     Timer timer;
@@ -91,30 +151,805 @@ void benchmark_match_orders() {
     }
 }
 
+void benchmark_cancel_deep_level() {
+    std::cout << "\n=== Benchmark: Cancel (10k orders on one level) ===" << std::endl;
+
+    BTreeOrderBook<> book("AAPL");
+
+    const int depth = 10000;
+    for (int i = 0; i < depth; ++i) {
+        book.add_order(i, BUY, 10000, 10);
+    }
+
+    // cancel from the back half first - the worst case for a queue scan
+    Timer timer;
+    for (int i = depth - 1; i >= 0; --i) {
+        book.cancel_order(i);
+    }
+    double elapsed = timer.elapsed_microseconds();
+
+    std::cout << "Cancelled " << depth << " orders in " << elapsed << " microseconds" << std::endl;
+    std::cout << "Average time per cancel: " << (elapsed / depth) << " microseconds" << std::endl;
+}
+
+void benchmark_drifting_book() {
+    std::cout << "\n=== Benchmark: Drifting Price (200k orders, 500 live) ===" << std::endl;
+
+    BTreeOrderBook<> book("AAPL");
+
+    // every order rests one tick higher than the last and the oldest is
+    // cancelled, so the live book is a 500-level window sliding upward
+    const int total = 200000;
+    const int live = 500;
+    Timer timer;
+    for (int i = 0; i < total; ++i) {
+        book.add_order(i, BUY, 10000 + i, 10);
+        if (i >= live) {
+            book.cancel_order(i - live);
+        }
+    }
+    double elapsed = timer.elapsed_milliseconds();
+
+    std::cout << "Processed " << total << " adds + cancels in " << elapsed << " ms" << std::endl;
+    std::cout << "Live levels: " << book.get_level_count(BUY)
+              << ", tree height: " << book.get_tree_height(BUY) << std::endl;
+
+    Timer timer2;
+    auto levels = book.get_bid_levels(10);
+    double time2 = timer2.elapsed_microseconds();
+    std::cout << "get_bid_levels(10) after drift: " << time2 << " microseconds" << std::endl;
+}
+
+// same add/cancel/match flow against any OrderBook implementation
+double run_mixed_workload(OrderBook& book, int num_orders) {
+    Timer timer;
+    for (int i = 0; i < num_orders; ++i) {
+        Side side = (i % 2 == 0) ? BUY : SELL;
+        // bids rest below 100.00, asks above, every 10th order crosses
+        Price offset = 1 + (i * 7919) % 200;
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (i % 10 == 0) {
+            price = side == BUY ? 10000 + 5 : 10000 - 5;
+        }
+        book.add_order(i, side, price, 10);
+        if (i % 3 == 0 && i >= 100) {
+            book.cancel_order(i - 100);
+        }
+        if (i % 10 == 0) {
+            book.match_orders();
+        }
+    }
+    return timer.elapsed_milliseconds();
+}
+
+void benchmark_book_comparison() {
+    std::cout << "\n=== Benchmark: B-Tree vs Price Ladder (200k mixed ops) ===" << std::endl;
+
+    const int num_orders = 200000;
+    BTreeOrderBook<> btree("AAPL");
+    PriceLadderOrderBook ladder("AAPL");
+
+    double btree_ms = run_mixed_workload(btree, num_orders);
+    double ladder_ms = run_mixed_workload(ladder, num_orders);
+
+    std::cout << "BTreeOrderBook<32>:   " << btree_ms << " ms" << std::endl;
+    std::cout << "PriceLadderOrderBook: " << ladder_ms << " ms" << std::endl;
+}
+
+// add/cancel/match churn over ids [begin, end), matching into a reused
+// execution ring. Every order still resting 1000 ids later is cancelled, so the
+// live book stays bounded
+void run_churn(OrderBook& book, int begin, int end, ExecutionRing& executions) {
+    const int live = 1000;
+    for (int i = begin; i < end; ++i) {
+        Side side = (i % 2 == 0) ? BUY : SELL;
+        Price offset = 1 + (i * 7919) % 200;
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (i % 10 == 0) {
+            price = side == BUY ? 10000 + 5 : 10000 - 5;
+        }
+        book.add_order(i, side, price, 10);
+        if (i >= live) {
+            book.cancel_order(i - live);
+        }
+        if (i % 10 == 0) {
+            executions.clear();
+            book.match_orders(executions);
+        }
+    }
+}
+
+template <typename Book>
+void run_steady_state(const char* name) {
+    Book book("AAPL");
+    book.reserve(10000);
+    ExecutionRing executions(1024);
+
+    // warm up so the pools and the index reach the working set
+    const int warmup = 100000;
+    const int measured = 200000;
+    run_churn(book, 0, warmup, executions);
+
+    size_t before = allocation_count;
+    Timer timer;
+    run_churn(book, warmup, warmup + measured, executions);
+    double elapsed = timer.elapsed_milliseconds();
+    size_t allocations = allocation_count - before;
+
+    std::cout << "  " << name << ": " << elapsed << " ms, " << allocations
+              << " allocations (" << double(allocations) / measured << " per order)" << std::endl;
+}
+
+void benchmark_steady_state_allocations() {
+    std::cout << "\n=== Benchmark: Steady-State Allocations (200k add/cancel/match) ===" << std::endl;
+
+    run_steady_state<BTreeOrderBook<>>("BTreeOrderBook<32>  ");
+    run_steady_state<PriceLadderOrderBook>("PriceLadderOrderBook");
+}
+
+// order flow where every 4th order crosses the spread; either rested and
+// then matched (two passes) or matched on arrival (one)
+template <typename Book>
+double run_aggressive_flow(int num_orders, bool continuous) {
+    Book book("AAPL");
+    book.reserve(10000);
+    ExecutionRing executions(1024);
+
+    Timer timer;
+    for (int i = 0; i < num_orders; ++i) {
+        Side side = (i % 2 == 0) ? BUY : SELL;
+        Price offset = 1 + (i * 7919) % 100;
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (i % 4 == 0) {
+            price = side == BUY ? 10000 + 20 : 10000 - 20;
+        }
+
+        executions.clear();
+        if (continuous) {
+            book.add_order(i, side, price, 10, executions);
+        } else {
+            book.add_order(i, side, price, 10);
+            book.match_orders(executions);
+        }
+        if (i >= 1000) {
+            book.cancel_order(i - 1000);
+        }
+    }
+    return timer.elapsed_milliseconds();
+}
+
+void benchmark_match_on_arrival() {
+    std::cout << "\n=== Benchmark: Rest + Match vs Match on Arrival (200k orders) ===" << std::endl;
+
+    const int num_orders = 200000;
+    std::cout << "BTreeOrderBook<32>:   add + match_orders " << run_aggressive_flow<BTreeOrderBook<>>(num_orders, false)
+              << " ms, match on arrival " << run_aggressive_flow<BTreeOrderBook<>>(num_orders, true) << " ms" << std::endl;
+    std::cout << "PriceLadderOrderBook: add + match_orders " << run_aggressive_flow<PriceLadderOrderBook>(num_orders, false)
+              << " ms, match on arrival " << run_aggressive_flow<PriceLadderOrderBook>(num_orders, true) << " ms" << std::endl;
+}
+
+// How fills leave the book: add + match_orders() returning a fresh
+// std::vector<Trade> per call (the old API), then match on arrival through
+// the vector adapter into a reused buffer, a caller-owned execution ring
+// through the virtual interface, and a lambda sink inlined into the
+// matching loop. Same order flow as run_aggressive_flow
+enum class SinkKind { RETURNED_VECTOR, REUSED_VECTOR, RING, INLINED };
+
+template <typename Book>
+void run_sink_flow(const char* name, SinkKind kind, int num_orders) {
+    Book book("AAPL");
+    book.reserve(10000);
+    std::vector<Trade> trades;
+    trades.reserve(1024);
+    ExecutionRing executions(1024);
+    Quantity filled = 0;
+    auto sink = [&filled](const Execution& execution) { filled += execution.quantity; };
+
+    size_t before = allocation_count;
+    Timer timer;
+    for (int i = 0; i < num_orders; ++i) {
+        Side side = (i % 2 == 0) ? BUY : SELL;
+        Price offset = 1 + (i * 7919) % 100;
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (i % 4 == 0) {
+            price = side == BUY ? 10000 + 20 : 10000 - 20;
+        }
+
+        switch (kind) {
+        case SinkKind::RETURNED_VECTOR:
+            book.add_order(i, side, price, 10);
+            filled += Quantity(book.match_orders().size());
+            break;
+        case SinkKind::REUSED_VECTOR:
+            trades.clear();
+            book.add_order(i, side, price, 10, trades);
+            break;
+        case SinkKind::RING:
+            executions.clear();
+            book.add_order(i, side, price, 10, executions);
+            break;
+        case SinkKind::INLINED:
+            book.add_order_with(i, side, price, 10, sink);
+            break;
+        }
+        if (i >= 1000) {
+            book.cancel_order(i - 1000);
+        }
+    }
+    double elapsed = timer.elapsed_milliseconds();
+    size_t allocations = allocation_count - before;
+
+    std::cout << "  " << name << ": " << elapsed << " ms, " << allocations << " allocations" << std::endl;
+}
+
+void benchmark_execution_sinks() {
+    std::cout << "\n=== Benchmark: Execution Delivery (200k orders, BTreeOrderBook<32>) ===" << std::endl;
+
+    const int num_orders = 200000;
+    run_sink_flow<BTreeOrderBook<>>("add + match_orders()  ", SinkKind::RETURNED_VECTOR, num_orders);
+    run_sink_flow<BTreeOrderBook<>>("reused vector<Trade>  ", SinkKind::REUSED_VECTOR, num_orders);
+    run_sink_flow<BTreeOrderBook<>>("ExecutionRing         ", SinkKind::RING, num_orders);
+    run_sink_flow<BTreeOrderBook<>>("inlined sink          ", SinkKind::INLINED, num_orders);
+}
+
+// FOK orders that cannot fill against a deep ask side: the subtree-total
+// query vs summing the depth snapshot the way a check had to before
+template <typename Book>
+void run_fok_rejects(const char* name, int rejects) {
+    Book book("AAPL");
+    for (int i = 0; i < 20000; ++i) {
+        book.add_order(i, SELL, 10000 + (i % 5000), 10);
+    }
+    ExecutionRing executions;
+
+    size_t before = allocation_count;
+    Timer fast;
+    int refused = 0;
+    for (int i = 0; i < rejects; ++i) {
+        Price limit = 10000 + (i * 7919) % 5000;
+        refused += !book.add_order(100000 + i, BUY, limit, 1000000, FOK, executions);
+    }
+    double fast_ms = fast.elapsed_milliseconds();
+    size_t allocations = allocation_count - before;
+
+    Timer slow;
+    Quantity checked = 0;
+    for (int i = 0; i < rejects; ++i) {
+        Price limit = 10000 + (i * 7919) % 5000;
+        for (const auto& level : book.get_ask_levels(5000)) {
+            if (level.price > limit) {
+                break;
+            }
+            checked += level.quantity;
+        }
+    }
+    double slow_ms = slow.elapsed_milliseconds();
+
+    std::cout << "  " << name << ": " << refused << " refused in " << fast_ms << " ms ("
+              << allocations << " allocations), summing levels " << slow_ms << " ms" << std::endl;
+    if (checked < 0 || book.get_ask_count() != 20000 || executions.size() != 0) {
+        std::cout << "  book changed by a refused FOK!" << std::endl;
+    }
+}
+
+void benchmark_fok_rejects() {
+    std::cout << "\n=== Benchmark: FOK Rejects (5000 ask levels, 5k rejects) ===" << std::endl;
+
+    run_fok_rejects<BTreeOrderBook<>>("BTreeOrderBook<32>  ", 5000);
+    run_fok_rejects<PriceLadderOrderBook>("PriceLadderOrderBook", 5000);
+}
+
+// Amend flow over a 10k-order book: in-place modify_order vs cancel + add
+// of a replacement. Alternates quantity-down (keeps priority) and price moves
+template <typename Book>
+void run_amends(const char* name, int amends) {
+    Book native("AAPL");
+    Book replace("AAPL");
+    for (int i = 0; i < 10000; ++i) {
+        Side side = (i % 2 == 0) ? BUY : SELL;
+        Price price = side == BUY ? 9999 - (i % 100) : 10001 + (i % 100);
+        native.add_order(i, side, price, 1000);
+        replace.add_order(i, side, price, 1000);
+    }
+
+    Timer modify_timer;
+    for (int i = 0; i < amends; ++i) {
+        int id = int((long(i) * 7919) % 10000);
+        const Order* order = native.find_order(id);
+        Price price = order->get_price() + (i % 2 == 0 ? 0 : (order->get_side() == BUY ? -1 : 1));
+        native.modify_order(id, price, order->get_remaining_quantity() - 1);
+    }
+    double modify_ms = modify_timer.elapsed_milliseconds();
+
+    Timer replace_timer;
+    for (int i = 0; i < amends; ++i) {
+        int id = int((long(i) * 7919) % 10000);
+        const Order* order = replace.find_order(id);
+        Side side = order->get_side();
+        Price price = order->get_price() + (i % 2 == 0 ? 0 : (side == BUY ? -1 : 1));
+        Quantity qty = order->get_remaining_quantity() - 1;
+        replace.cancel_order(id);
+        replace.add_order(id, side, price, qty);
+    }
+    double replace_ms = replace_timer.elapsed_milliseconds();
+
+    std::cout << "  " << name << ": modify_order " << modify_ms << " ms, cancel + add "
+              << replace_ms << " ms" << std::endl;
+}
+
+void benchmark_amends() {
+    std::cout << "\n=== Benchmark: Amend in Place vs Cancel + Add (500k amends) ===" << std::endl;
+
+    run_amends<BTreeOrderBook<>>("BTreeOrderBook<32>  ", 500000);
+    run_amends<PriceLadderOrderBook>("PriceLadderOrderBook", 500000);
+}
+
+// Engine throughput against batch size: 4 symbols, prices clustered on a
+// few ticks so batches share levels, about one order in 8 crossing. Messages
+// arrive in slices of 1024; each slice is submitted, then the slice from
+// two slices back is cancelled so the books stay bounded. Batch size 0
+// is the one-at-a-time path (submit_order + match_orders per message)
+double run_batched_flow(const std::vector<OrderMessage>& messages, size_t batch_size) {
+    MatchingEngine engine;
+    SymbolId symbols[4];
+    const char* names[4] = {"AAPL", "MSFT", "GOOGL", "TSLA"};
+    for (int s = 0; s < 4; ++s) {
+        symbols[s] = engine.create_order_book(names[s], std::make_unique<BTreeOrderBook<>>(names[s]));
+        engine.get_order_book(symbols[s])->reserve(4096);
+    }
+    if (batch_size > 0) {
+        engine.set_batch_size(batch_size);
+    }
+    ExecutionRing executions(4096);
+    std::vector<CancelMessage> cancels;
+    cancels.reserve(1024);
+
+    const size_t slice = 1024;
+    Timer timer;
+    for (size_t begin = 0; begin < messages.size(); begin += slice) {
+        size_t end = std::min(messages.size(), begin + slice);
+        executions.clear();
+        if (batch_size > 0) {
+            engine.submit_batch(messages.data() + begin, end - begin, executions);
+        } else {
+            for (size_t i = begin; i < end; ++i) {
+                const OrderMessage& m = messages[i];
+                engine.submit_order(m.symbol_id, m.order_id, m.side, m.price, m.quantity);
+                engine.match_orders(m.symbol_id, executions);
+            }
+        }
+        if (begin >= 2 * slice) {
+            cancels.clear();
+            for (size_t i = begin - 2 * slice; i < end - 2 * slice; ++i) {
+                cancels.push_back(CancelMessage{messages[i].symbol_id, messages[i].order_id});
+            }
+            engine.cancel_batch(cancels);
+        }
+    }
+    return timer.elapsed_milliseconds();
+}
+
+void benchmark_batch_sizes() {
+    std::cout << "\n=== Benchmark: Batched Submission (400k orders, 4 symbols) ===" << std::endl;
+
+    const size_t num_orders = 400000;
+    std::vector<OrderMessage> messages;
+    messages.reserve(num_orders);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Price> offset_dist(1, 8);
+    for (size_t i = 0; i < num_orders; ++i) {
+        Side side = (rng() & 1) ? BUY : SELL;
+        Price offset = offset_dist(rng);
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (rng() % 8 == 0) {
+            price = side == BUY ? 10000 + 2 : 10000 - 2;
+        }
+        messages.push_back(OrderMessage{SymbolId(rng() % 4), side, i, price, 10});
+    }
+
+    double single_ms = run_batched_flow(messages, 0);
+    std::cout << "  one at a time: " << single_ms << " ms ("
+              << std::fixed << std::setprecision(2) << num_orders / single_ms / 1000.0 << " M orders/s)" << std::endl;
+    for (size_t batch_size : {1, 8, 32, 128, 256, 1024}) {
+        double ms = run_batched_flow(messages, batch_size);
+        std::cout << "  batch " << std::setw(4) << batch_size << ":    " << ms << " ms ("
+                  << num_orders / ms / 1000.0 << " M orders/s)" << std::endl;
+    }
+}
+
+// Submit-to-flush time for the whole flow on a given number of workers;
+// the calling thread is the single producer
+double run_sharded_flow(const std::vector<OrderCommand>& commands, size_t symbol_count, size_t workers) {
+    ShardedMatchingEngine engine(workers);
+    for (size_t s = 0; s < symbol_count; ++s) {
+        std::string name = "SYM" + std::to_string(s);
+        SymbolId id = engine.create_order_book(name, std::make_unique<BTreeOrderBook<>>(name));
+        engine.get_order_book(id)->reserve(16384);
+    }
+    engine.start();
+
+    Timer timer;
+    for (const OrderCommand& c : commands) {
+        const OrderMessage& m = c.order;
+        if (c.type == CommandType::CANCEL) {
+            engine.cancel_order(m.symbol_id, m.order_id);
+        } else {
+            engine.submit_order(m.symbol_id, m.order_id, m.side, m.price, m.quantity);
+        }
+    }
+    engine.flush();
+    double ms = timer.elapsed_milliseconds();
+    engine.stop();
+    return ms;
+}
+
+void benchmark_sharded_scaling() {
+    const size_t symbol_count = 16;
+    const size_t num_orders = 1000000;
+    std::cout << "\n=== Benchmark: Sharded Engine Scaling (" << num_orders / 1000 << "k orders, "
+              << symbol_count << " symbols) ===" << std::endl;
+
+    // same shape as the batched flow: mostly passive, one in eight crosses,
+    // and each order is cancelled a while after it was sent
+    std::vector<OrderCommand> commands;
+    commands.reserve(num_orders * 2);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Price> offset_dist(1, 8);
+    const size_t lag = 4096;
+    for (size_t i = 0; i < num_orders; ++i) {
+        Side side = (rng() & 1) ? BUY : SELL;
+        Price offset = offset_dist(rng);
+        Price price = side == BUY ? 10000 - offset : 10000 + offset;
+        if (rng() % 8 == 0) {
+            price = side == BUY ? 10000 + 2 : 10000 - 2;
+        }
+        commands.push_back(OrderCommand{CommandType::ADD, LIMIT,
+                                        OrderMessage{SymbolId(rng() % symbol_count), side, i, price, 10}});
+        if (i >= lag) {
+            OrderMessage cancel = commands[commands.size() - 1 - lag].order;
+            commands.push_back(OrderCommand{CommandType::CANCEL, LIMIT, cancel});
+        }
+    }
+
+    // the producer needs a core too, so stop one short of the machine
+    size_t max_workers = std::min<size_t>(8, std::max(2u, std::thread::hardware_concurrency()) - 1);
+    double base_ms = 0;
+    for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+        double ms = run_sharded_flow(commands, symbol_count, workers);
+        if (workers == 1) {
+            base_ms = ms;
+        }
+        std::cout << "  " << workers << " worker" << (workers == 1 ? ": " : "s:") << " " << std::setw(8) << ms
+                  << " ms (" << std::fixed << std::setprecision(2) << commands.size() / ms / 1000.0
+                  << " M commands/s, " << base_ms / ms << "x)" << std::endl;
+    }
+}
+
+// Continuous flow through the engine, optionally journaled; the time runs
+// until the journal has written everything out
+double run_journaled_flow(const std::vector<OrderMessage>& messages, Journal* journal) {
+    MatchingEngine engine;
+    const char* names[] = {"SYM0", "SYM1", "SYM2", "SYM3"};
+    for (const char* name : names) {
+        SymbolId id = engine.create_order_book(name, std::make_unique<BTreeOrderBook<>>(name));
+        engine.get_order_book(id)->reserve(4096);
+    }
+    engine.set_journal(journal);
+    ExecutionRing executions(4096);
+
+    Timer timer;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        const OrderMessage& m = messages[i];
+        executions.clear();
+        engine.submit_order(m.symbol_id, m.order_id, m.side, m.price, m.quantity, executions);
+        if (i >= 2048) {
+            engine.cancel_order(messages[i - 2048].symbol_id, messages[i - 2048].order_id);
+        }
+    }
+    if (journal) {
+        journal->flush();
+    }
+    return timer.elapsed_microseconds();
+}
+
+void benchmark_journal() {
+    std::cout << "\n=== Benchmark: Journal (400k orders) ===" << std::endl;
+
+    const size_t num_orders = 400000;
+    std::vector<OrderMessage> messages;
+    messages.reserve(num_orders);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Price> offset_dist(1, 8);
+    for (size_t i = 0; i < num_orders; ++i) {
+        Side side = (rng() & 1) ? BUY : SELL;
+        Price price = side == BUY ? 10000 - offset_dist(rng) : 10000 + offset_dist(rng);
+        if (rng() % 8 == 0) {
+            price = side == BUY ? 10000 + 2 : 10000 - 2;
+        }
+        messages.push_back(OrderMessage{SymbolId(rng() % 4), side, i, price, 10});
+    }
+
+    const char* path = "benchmark_journal.bin";
+    std::remove(path);
+    double plain_us = run_journaled_flow(messages, nullptr);
+    double journaled_us;
+    uint64_t bytes;
+    {
+        Journal journal(path);
+        journaled_us = run_journaled_flow(messages, &journal);
+        bytes = journal.get_bytes_written();
+    }
+    std::remove(path);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  no journal:  " << plain_us * 1000.0 / num_orders << " ns/order" << std::endl;
+    std::cout << "  journaled:   " << journaled_us * 1000.0 / num_orders << " ns/order (+"
+              << (journaled_us - plain_us) * 1000.0 / num_orders << " ns), "
+              << bytes / journaled_us << " MB/s sustained, "
+              << bytes / sizeof(JournalRecord) << " records" << std::endl;
+
+    // the writer alone: how fast records reach the file
+    const size_t records = 2000000;
+    double append_us;
+    {
+        Journal journal(path);
+        JournalRecord record{JournalRecordType::ADD, 0, 0, 0, 0, 0, 0, 0, 0, 10000, 10};
+        Timer timer;
+        for (size_t i = 0; i < records; ++i) {
+            record.order_id = i;
+            journal.append(record);
+        }
+        journal.flush();
+        append_us = timer.elapsed_microseconds();
+    }
+    std::remove(path);
+    std::cout << "  raw append:  " << append_us * 1000.0 / records << " ns/record, "
+              << records * sizeof(JournalRecord) / append_us << " MB/s" << std::endl;
+}
+
+// The same flow as run_sink_flow with the ring sink, with and without an
+// order event queue attached; the queue is drained every 64 orders, as a
+// consumer thread keeping up would
+template <typename Book>
+void run_order_event_flow(const char* name, int num_orders) {
+    double elapsed_ms[2];
+    size_t allocations[2];
+    uint64_t events = 0;
+    for (int attached = 0; attached < 2; ++attached) {
+        Book book("AAPL");
+        book.reserve(10000);
+        ExecutionRing executions(1024);
+        OrderEventQueue queue(1 << 12);
+        OrderEvent batch[256];
+        if (attached) {
+            book.set_order_events(&queue);
+        }
+
+        size_t before = allocation_count;
+        Timer timer;
+        for (int i = 0; i < num_orders; ++i) {
+            Side side = (i % 2 == 0) ? BUY : SELL;
+            Price offset = 1 + (i * 7919) % 100;
+            Price price = side == BUY ? 10000 - offset : 10000 + offset;
+            if (i % 4 == 0) {
+                price = side == BUY ? 10000 + 20 : 10000 - 20;
+            }
+            executions.clear();
+            book.add_order(i, side, price, 10, executions);
+            if (i >= 1000) {
+                book.cancel_order(i - 1000);
+            }
+            if (i % 64 == 0) {
+                while (queue.pop_batch(batch, 256) > 0) {
+                }
+            }
+        }
+        elapsed_ms[attached] = timer.elapsed_milliseconds();
+        allocations[attached] = allocation_count - before;
+        if (attached) {
+            events = book.get_order_sequence();
+            book.set_order_events(nullptr);
+        }
+    }
+
+    std::cout << "  " << name << ": " << elapsed_ms[0] * 1e6 / num_orders << " -> "
+              << elapsed_ms[1] * 1e6 / num_orders << " ns/order (+"
+              << (elapsed_ms[1] - elapsed_ms[0]) * 1e6 / events << " ns/event), " << events << " events, "
+              << allocations[0] << " -> " << allocations[1] << " allocations" << std::endl;
+}
+
+void benchmark_order_events() {
+    std::cout << "\n=== Benchmark: Order Event Feed (200k orders) ===" << std::endl;
+
+    const int num_orders = 200000;
+    run_order_event_flow<BTreeOrderBook<>>("BTreeOrderBook<32>  ", num_orders);
+    run_order_event_flow<PriceLadderOrderBook>("PriceLadderOrderBook", num_orders);
+}
+
+// Rebuilding a 1M-order book two ways: restoring a snapshot (one bulk load
+// per book) and replaying the same orders one add_order at a time
+template <typename Book>
+void run_snapshot_restore(const char* name, const std::vector<OrderMessage>& messages) {
+    const char* path = "benchmark_snapshot.bin";
+
+    MatchingEngine source;
+    source.create_order_book(name, std::make_unique<Book>(name));
+    OrderBook* book = source.get_order_book(SymbolId(0));
+    book->reserve(messages.size());
+    for (const OrderMessage& m : messages) {
+        book->add_order(m.order_id, m.side, m.price, m.quantity);
+    }
+
+    Timer write_timer;
+    bool written = write_snapshot(path, source);
+    double write_ms = write_timer.elapsed_milliseconds();
+
+    MatchingEngine restored;
+    restored.create_order_book(name, std::make_unique<Book>(name));
+    restored.get_order_book(SymbolId(0))->reserve(messages.size());
+    Timer restore_timer;
+    bool loaded = written && restore_snapshot(path, restored);
+    double restore_ms = restore_timer.elapsed_milliseconds();
+    std::remove(path);
+
+    MatchingEngine replayed;
+    replayed.create_order_book(name, std::make_unique<Book>(name));
+    OrderBook* replay_book = replayed.get_order_book(SymbolId(0));
+    replay_book->reserve(messages.size());
+    Timer replay_timer;
+    for (const OrderMessage& m : messages) {
+        replay_book->add_order(m.order_id, m.side, m.price, m.quantity);
+    }
+    double replay_ms = replay_timer.elapsed_milliseconds();
+
+    OrderBook* restored_book = restored.get_order_book(SymbolId(0));
+    bool same = loaded && restored_book->get_bid_count() == replay_book->get_bid_count() &&
+                restored_book->get_ask_count() == replay_book->get_ask_count() &&
+                restored_book->get_best_bid() == replay_book->get_best_bid();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(22) << name << std::right
+              << "write " << std::setw(7) << write_ms << " ms, restore " << std::setw(7) << restore_ms
+              << " ms, replay " << std::setw(7) << replay_ms << " ms (" << std::setprecision(2)
+              << replay_ms / restore_ms << "x)" << (same ? "" : "  MISMATCH") << std::endl;
+}
+
+void benchmark_snapshot_restore() {
+    std::cout << "\n=== Benchmark: Snapshot Restore vs Replay (1M orders) ===" << std::endl;
+
+    // 50k levels a side, ten orders each, arriving in random order
+    const size_t levels = 50000;
+    std::vector<OrderMessage> messages;
+    messages.reserve(2 * levels * 10);
+    for (size_t l = 0; l < levels; ++l) {
+        for (size_t k = 0; k < 10; ++k) {
+            messages.push_back(OrderMessage{0, BUY, 0, Price(100000 - 1 - l), Quantity(10 + k)});
+            messages.push_back(OrderMessage{0, SELL, 0, Price(100000 + l), Quantity(10 + k)});
+        }
+    }
+    std::shuffle(messages.begin(), messages.end(), std::mt19937(42));
+    for (size_t i = 0; i < messages.size(); ++i) {
+        messages[i].order_id = i + 1;
+    }
+
+    run_snapshot_restore<BTreeOrderBook<>>("BTreeOrderBook<32>", messages);
+    run_snapshot_restore<PriceLadderOrderBook>("PriceLadderOrderBook", messages);
+}
+
+void benchmark_node_search() {
+    std::cout << "\n=== Benchmark: Node Key Search (" << key_search_isa() << ") ===" << std::endl;
+
+    std::mt19937 rng(7);
+    const int lookups = 2000000;
+    for (size_t n : {15, 31, 63, 127}) {
+        std::vector<Price> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = 10000 + Price(i) * 3;
+        }
+        std::vector<Price> probes(1024);
+        std::uniform_int_distribution<Price> probe_dist(keys.front() - 2, keys.back() + 2);
+        for (auto& probe : probes) {
+            probe = probe_dist(rng);
+        }
+
+        // the sums keep the compiler from dropping the searches
+        size_t sink = 0;
+        Timer timer1;
+        for (int i = 0; i < lookups; ++i) {
+            Price probe = probes[i & 1023];
+            sink += std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+        }
+        double binary_ns = timer1.elapsed_microseconds() * 1000.0 / lookups;
+
+        Timer timer2;
+        for (int i = 0; i < lookups; ++i) {
+            sink += lower_bound_scalar(keys.data(), n, probes[i & 1023]);
+        }
+        double scalar_ns = timer2.elapsed_microseconds() * 1000.0 / lookups;
+
+        Timer timer3;
+        for (int i = 0; i < lookups; ++i) {
+            sink += lower_bound_keys(keys.data(), n, probes[i & 1023]);
+        }
+        double simd_ns = timer3.elapsed_microseconds() * 1000.0 / lookups;
+
+        std::cout << "  " << std::setw(3) << n << " keys: binary " << binary_ns << " ns, scalar count "
+                  << scalar_ns << " ns, " << key_search_isa() << " " << simd_ns << " ns"
+                  << (sink == 0 ? " " : "") << std::endl;
+    }
+}
+
+// one order per level over a wide price range, so every add, lookup and
+// cancel has to descend the tree
+template <size_t Degree>
+void run_degree_workload(const std::vector<Price>& prices) {
+    const int num_levels = int(prices.size());
+    BTreeOrderBook<Degree> book("AAPL");
+
+    Timer timer1;
+    for (int i = 0; i < num_levels; ++i) {
+        book.add_order(i, BUY, prices[i], 10);
+    }
+    double insert_ns = timer1.elapsed_microseconds() * 1000.0 / num_levels;
+
+    // joins an existing level - a pure find
+    Timer timer2;
+    for (int i = 0; i < num_levels; ++i) {
+        book.add_order(num_levels + i, BUY, prices[i], 10);
+    }
+    double find_ns = timer2.elapsed_microseconds() * 1000.0 / num_levels;
+
+    // cancelling both orders empties the level, which is erased from the tree
+    Timer timer3;
+    for (int i = 0; i < num_levels; ++i) {
+        book.cancel_order(i);
+        book.cancel_order(num_levels + i);
+    }
+    double cancel_ns = timer3.elapsed_microseconds() * 1000.0 / num_levels;
+
+    std::cout << "  BTreeOrderBook<" << std::setw(2) << Degree << ">: insert " << insert_ns << " ns, find "
+              << find_ns << " ns, cancel+erase " << cancel_ns << " ns" << std::endl;
+}
+
+void benchmark_tree_degrees() {
+    std::cout << "\n=== Benchmark: B-Tree Degree (100k levels, " << key_search_isa() << " search) ===" << std::endl;
+
+    const int num_levels = 100000;
+    std::vector<Price> prices(num_levels);
+    for (int i = 0; i < num_levels; ++i) {
+        prices[i] = 10000 + Price(i) * 2;
+    }
+    std::shuffle(prices.begin(), prices.end(), std::mt19937(42));
+
+    run_degree_workload<8>(prices);
+    run_degree_workload<16>(prices);
+    run_degree_workload<32>(prices);
+    run_degree_workload<64>(prices);
+}
+
 void benchmark_query_operations() {
     std::cout << "\n=== Benchmark: Query Operations ===" << std::endl;
 
-    BTreeOrderBook book("AAPL");
+    BTreeOrderBook<> book("AAPL");
 
     // Fill book
     for (int i = 0; i < 10000; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
+        Price price = 10000 + (i % 100);
         Side side = (i % 2 == 0) ? BUY : SELL;
-        auto order = std::make_shared<Order>(i, side, price, 10, "AAPL");
+        auto order = std::make_shared<Order>(i, side, price, 10, book.get_symbol_id());
         book.add_order(order);
     }
 
     // Benchmark get_best_bid
     Timer timer1;
-    double bid = book.get_best_bid();
+    Price bid = book.get_best_bid();
     double time1 = timer1.elapsed_microseconds();
-    std::cout << "get_best_bid(): " << time1 << " microseconds (result: $" << bid << ")" << std::endl;
+    std::cout << "get_best_bid(): " << time1 << " microseconds (result: $" << book.get_instrument().to_price(bid) << ")" << std::endl;
 
     // Benchmark get_best_ask
     Timer timer2;
-    double ask = book.get_best_ask();
+    Price ask = book.get_best_ask();
     double time2 = timer2.elapsed_microseconds();
-    std::cout << "get_best_ask(): " << time2 << " microseconds (result: $" << ask << ")" << std::endl;
+    std::cout << "get_best_ask(): " << time2 << " microseconds (result: $" << book.get_instrument().to_price(ask) << ")" << std::endl;
 
     // Benchmark get_bid_levels
     Timer timer3;
@@ -134,6 +969,21 @@ int main() {
     benchmark_add_order_warmedup_book();
     benchmark_add_order_full_book();
     benchmark_match_orders();
+    benchmark_cancel_deep_level();
+    benchmark_drifting_book();
+    benchmark_book_comparison();
+    benchmark_steady_state_allocations();
+    benchmark_match_on_arrival();
+    benchmark_execution_sinks();
+    benchmark_fok_rejects();
+    benchmark_amends();
+    benchmark_batch_sizes();
+    benchmark_sharded_scaling();
+    benchmark_journal();
+    benchmark_order_events();
+    benchmark_snapshot_restore();
+    benchmark_node_search();
+    benchmark_tree_degrees();
     benchmark_query_operations();
 
     std::cout << "\nBenchmarks complete!" << std::endl;
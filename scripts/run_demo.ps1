@@ -26,26 +26,14 @@ $env:PATH = "$msys2Path;$env:PATH"
 $projectRoot = Get-Location
 Write-Host "Project root: $projectRoot" -ForegroundColor Cyan
 
-# 3. Create visualization directory if needed
-if (-not (Test-Path "visualization\data")) {
-    New-Item -ItemType Directory -Path "visualization\data" -Force | Out-Null
+# 3. Open the browser once the engine is up - it serves the page and pushes
+#    book updates itself on http://localhost:8080
+$browserJob = Start-Job -ScriptBlock {
+    Start-Sleep -Seconds 2
+    Start-Process "http://localhost:8080"
 }
 
-# 4. Start web server in background
-Write-Host "`nStarting web server..." -ForegroundColor Yellow
-$webJob = Start-Job -ScriptBlock {
-    param($root)
-    Set-Location "$root\visualization"
-    python -m http.server 8080
-} -ArgumentList $projectRoot
-
-Start-Sleep -Seconds 2
-
-# 5. Open browser
-Write-Host "Opening browser..." -ForegroundColor Yellow
-Start-Process "http://localhost:8080"
-
-# 6. Run the executable FROM the project root (like CLion does)
+# 4. Run the executable FROM the project root (like CLion does)
 Write-Host "`nStarting Order Matching Engine..." -ForegroundColor Green
 Write-Host "You should see output below:" -ForegroundColor Cyan
 Write-Host "=============================" -ForegroundColor Green
@@ -54,7 +42,5 @@ Write-Host "=============================" -ForegroundColor Green
 & ".\cmake-build-debug-msys2-mingw64\ordermatching.exe"
 
 # Cleanup
-Write-Host "`nStopping web server..." -ForegroundColor Yellow
-Stop-Job $webJob -ErrorAction SilentlyContinue
-Remove-Job $webJob -ErrorAction SilentlyContinue
+Remove-Job $browserJob -Force -ErrorAction SilentlyContinue
 Write-Host "Done!" -ForegroundColor Green
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "DepthPublisher.h"
+
+#include <algorithm>
+
+namespace order_matching {
+
+    namespace {
+
+        uint64_t level_key(Price price, uint8_t side) {
+            return uint64_t(price) * 2 + side;
+        }
+
+    } // namespace
+
+    DepthPublisher::~DepthPublisher() {
+        for (auto& feed : feeds_) {
+            if (feed->book->get_level_updates() == &feed->updates) {
+                feed->book->set_level_updates(nullptr);
+            }
+        }
+    }
+
+    void DepthPublisher::add_book(OrderBook* book) {
+        feeds_.push_back(std::make_unique<Feed>(book, ring_capacity_));
+        book->set_level_updates(&feeds_.back()->updates);
+    }
+
+    void DepthPublisher::request_snapshots() {
+        for (auto& feed : feeds_) {
+            feed->snapshot_due = true;
+        }
+    }
+
+    size_t DepthPublisher::publish() {
+        size_t published = 0;
+        for (auto& feed : feeds_) {
+            Feed& f = *feed;
+            SymbolId symbol_id = f.book->get_symbol_id();
+            updates_received_ += f.updates.size();
+
+            // every change is queued and the level's index entry moved to the
+            // latest, so each level goes out once, at its last change, and
+            // sequences rise. Reserving the ring's size up front keeps the
+            // index's pointers valid; both only grow with the ring
+            pending_.reserve(f.updates.size());
+            pending_index_.reserve(f.updates.size());
+            f.updates.drain([this, symbol_id](const LevelUpdate& u) {
+                pending_.push_back(DepthUpdate{u.sequence, u.price, u.quantity, u.order_count, symbol_id, u.side, {}});
+                uint64_t key = level_key(u.price, u.side);
+                if (!pending_index_.insert(key, &pending_.back())) {
+                    pending_index_.erase(key);
+                    pending_index_.insert(key, &pending_.back());
+                }
+            });
+            for (const DepthUpdate& d : pending_) {
+                uint64_t key = level_key(d.price, d.side);
+                if (pending_index_.find(key) != &d) {
+                    continue;   // superseded later in the round
+                }
+                pending_index_.erase(key);
+                if (update_handler_) {
+                    update_handler_(d);
+                }
+                ++published;
+            }
+            pending_.clear();
+
+            if (++f.rounds_since_snapshot >= snapshot_interval_) {
+                f.snapshot_due = true;
+            }
+            if (f.snapshot_due) {
+                send_snapshot(f);
+            }
+        }
+        updates_published_ += published;
+        return published;
+    }
+
+    // the ring was just drained, so the book's sequence covers every update
+    // sent so far; a side never has more levels than orders
+    void DepthPublisher::send_snapshot(Feed& feed) {
+        OrderBook* book = feed.book;
+        snapshot_.symbol_id = book->get_symbol_id();
+        snapshot_.sequence = book->get_level_sequence();
+        snapshot_.bids = book->get_bid_levels(std::min(snapshot_depth_, book->get_bid_count()));
+        snapshot_.asks = book->get_ask_levels(std::min(snapshot_depth_, book->get_ask_count()));
+        if (snapshot_handler_) {
+            snapshot_handler_(snapshot_);
+        }
+        feed.snapshot_due = false;
+        feed.rounds_since_snapshot = 0;
+        ++snapshots_published_;
+    }
+
+} // namespace order_matching
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+#include "LevelUpdate.h"
+#include "OrderBook.h"
+#include "../utils/FlatIdMap.h"
+
+namespace order_matching {
+
+    // One entry of the incremental depth feed: the aggregate now resting at
+    // price on side of a book, 0 if the level is gone
+    struct DepthUpdate {
+        uint64_t sequence;      // the book's level sequence (LevelUpdate)
+        Price price;
+        Quantity quantity;
+        uint32_t order_count;
+        SymbolId symbol_id;
+        uint8_t side;           // Side
+        uint8_t reserved[7];
+    };
+
+    static_assert(std::is_trivially_copyable<DepthUpdate>::value, "depth updates are copied around as raw data");
+
+    // Full depth of one book, for consumers that join late or lose their
+    // place. Updates with a sequence above the snapshot's apply on top of it
+    struct DepthSnapshot {
+        SymbolId symbol_id;
+        uint64_t sequence;
+        std::vector<OrderBook::Level> bids;     // best first
+        std::vector<OrderBook::Level> asks;
+    };
+
+    //
+    // Turns the level updates of a set of books into an incremental depth
+    // feed. Each book pushes its changes to a ring the publisher owns;
+    // publish(), on the books' thread, drains them, conflates repeated
+    // changes to one level within the round to the last one, and hands the
+    // rest to the update handler in sequence order - so the cost of a round
+    // follows what
+    // changed, not how deep the books are. Every snapshot_interval rounds,
+    // and on request, a book's full depth also goes to the snapshot handler,
+    // after that round's updates.
+    class DepthPublisher {
+    public:
+        typedef std::function<void(const DepthUpdate&)> UpdateHandler;
+        typedef std::function<void(const DepthSnapshot&)> SnapshotHandler;
+
+        explicit DepthPublisher(size_t snapshot_interval = 50,
+                                size_t snapshot_depth = std::numeric_limits<size_t>::max(),
+                                size_t ring_capacity = 4096)
+            : snapshot_interval_(snapshot_interval), snapshot_depth_(snapshot_depth),
+              ring_capacity_(ring_capacity) {}
+
+        // detaches from the books still attached
+        ~DepthPublisher();
+
+        DepthPublisher(const DepthPublisher&) = delete;
+        DepthPublisher& operator=(const DepthPublisher&) = delete;
+
+        // Attaches book (replacing any ring it had). Its first round sends a
+        // snapshot. The book must stay alive until the publisher is gone
+        void add_book(OrderBook* book);
+
+        void set_update_handler(UpdateHandler handler) { update_handler_ = std::move(handler); }
+        void set_snapshot_handler(SnapshotHandler handler) { snapshot_handler_ = std::move(handler); }
+
+        // a snapshot of every book with the next round (a consumer joined)
+        void request_snapshots();
+
+        // One round. Returns how many updates were sent after conflation
+        size_t publish();
+
+        uint64_t get_updates_received() const { return updates_received_; }
+        uint64_t get_updates_published() const { return updates_published_; }
+        uint64_t get_snapshots_published() const { return snapshots_published_; }
+
+    private:
+        struct Feed {
+            OrderBook* book;
+            LevelUpdateRing updates;
+            size_t rounds_since_snapshot;
+            bool snapshot_due;
+
+            Feed(OrderBook* b, size_t capacity)
+                : book(b), updates(capacity), rounds_since_snapshot(0), snapshot_due(true) {}
+        };
+
+        size_t snapshot_interval_;
+        size_t snapshot_depth_;
+        size_t ring_capacity_;
+        std::vector<std::unique_ptr<Feed>> feeds_;
+
+        UpdateHandler update_handler_;
+        SnapshotHandler snapshot_handler_;
+
+        // a round's updates, and each level's latest one among them; both
+        // are emptied, not freed, between rounds
+        std::vector<DepthUpdate> pending_;
+        utils::FlatIdMap<DepthUpdate> pending_index_;
+        DepthSnapshot snapshot_;
+
+        uint64_t updates_received_ = 0;
+        uint64_t updates_published_ = 0;
+        uint64_t snapshots_published_ = 0;
+
+        void send_snapshot(Feed& feed);
+    };
+
+    // Consumer side of the feed for one book: depth rebuilt from a snapshot
+    // and the updates that follow it. Updates before the first snapshot, or
+    // already covered by it, are ignored
+    class DepthBook {
+    private:
+        std::map<Price, OrderBook::Level, std::greater<Price>> bids_;
+        std::map<Price, OrderBook::Level> asks_;
+        uint64_t sequence_ = 0;
+        bool synced_ = false;
+
+        template <typename Levels>
+        static std::vector<OrderBook::Level> top(const Levels& levels, size_t max_levels) {
+            std::vector<OrderBook::Level> out;
+            for (auto it = levels.begin(); it != levels.end() && out.size() < max_levels; ++it) {
+                out.push_back(it->second);
+            }
+            return out;
+        }
+
+        template <typename Levels>
+        static void set_level(Levels& levels, const DepthUpdate& update) {
+            if (update.quantity > 0) {
+                levels.insert_or_assign(update.price, OrderBook::Level(update.price, update.quantity, update.order_count));
+            } else {
+                levels.erase(update.price);
+            }
+        }
+
+    public:
+        void apply(const DepthSnapshot& snapshot) {
+            bids_.clear();
+            asks_.clear();
+            for (const OrderBook::Level& level : snapshot.bids) {
+                bids_.emplace(level.price, level);
+            }
+            for (const OrderBook::Level& level : snapshot.asks) {
+                asks_.emplace(level.price, level);
+            }
+            sequence_ = snapshot.sequence;
+            synced_ = true;
+        }
+
+        // false if the update was ignored
+        bool apply(const DepthUpdate& update) {
+            if (!synced_ || update.sequence <= sequence_) {
+                return false;
+            }
+            if (update.side == BUY) {
+                set_level(bids_, update);
+            } else {
+                set_level(asks_, update);
+            }
+            return true;
+        }
+
+        bool is_synced() const { return synced_; }
+        size_t get_level_count(Side side) const { return side == BUY ? bids_.size() : asks_.size(); }
+
+        std::vector<OrderBook::Level> get_bid_levels(size_t max_levels = 10) const { return top(bids_, max_levels); }
+        std::vector<OrderBook::Level> get_ask_levels(size_t max_levels = 10) const { return top(asks_, max_levels); }
+    };
+
+} // namespace order_matching
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <type_traits>
+
+#include "Instrument.h"
+#include "Order.h"
+#include "../utils/RingBuffer.h"
+
+namespace order_matching {
+
+    // One fill, as reported by the matching loop. Plain data: no strings and
+    // no clock read, so reporting a fill is a handful of stores into
+    // whatever sink the caller supplied
+    struct Execution {
+        typedef unsigned long TradeId;
+
+        TradeId trade_id;
+        Order::OrderId buy_order_id;
+        Order::OrderId sell_order_id;
+        Price price;        // in ticks
+        Quantity quantity;  // in lots
+        SymbolId symbol_id;
+    };
+
+    static_assert(std::is_trivially_copyable<Execution>::value, "executions are copied around as raw data");
+
+    // Caller-owned, preallocated execution queue for the virtual OrderBook
+    // interface
+    typedef utils::RingBuffer<Execution> ExecutionRing;
+
+} // namespace order_matching
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace order_matching {
+
+    // Fixed-point representation used everywhere inside the engine:
+    // prices are whole ticks and quantities are whole lots
+    typedef std::int64_t Price;
+    typedef std::int64_t Quantity;
+
+    // Dense per-engine symbol number, assigned by SymbolRegistry when a book
+    // is created. Orders and trades carry this instead of the symbol string
+    typedef std::uint32_t SymbolId;
+
+    // per-symbol contract spec. Converts between decimal prices/sizes at the
+    // edges (order entry, display) and the integer ticks/lots used internally
+    struct Instrument {
+        std::string symbol;
+        double tick_size;
+        double lot_size;
+
+        explicit Instrument(const std::string& sym, double tick = 0.01, double lot = 1.0)
+            : symbol(sym), tick_size(tick), lot_size(lot) {}
+
+        Price to_ticks(double price) const {
+            return static_cast<Price>(std::llround(price / tick_size));
+        }
+
+        double to_price(Price ticks) const {
+            return static_cast<double>(ticks) * tick_size;
+        }
+
+        Quantity to_lots(double qty) const {
+            return static_cast<Quantity>(std::llround(qty / lot_size));
+        }
+
+        double to_quantity(Quantity lots) const {
+            return static_cast<double>(lots) * lot_size;
+        }
+    };
+
+} // namespace order_matching
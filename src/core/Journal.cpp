@@ -0,0 +1,191 @@
+#include "Journal.h"
+#include "MatchingEngine.h"
+
+#include <filesystem>
+#include <system_error>
+
+namespace order_matching {
+
+    namespace {
+
+        // Cuts a record left half written by a crash off the end of the file,
+        // so what is appended next starts on a record boundary. False if the
+        // file could not be truncated
+        bool drop_torn_tail(const std::string& path) {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(path, error)) {
+                return true;    // nothing there yet, or a device
+            }
+            uintmax_t size = std::filesystem::file_size(path, error);
+            if (error) {
+                return false;
+            }
+            if (size % sizeof(JournalRecord) != 0) {
+                std::filesystem::resize_file(path, size - size % sizeof(JournalRecord), error);
+            }
+            return !error;
+        }
+
+    } // namespace
+
+    Journal::Journal(const std::string& path, size_t queue_capacity)
+        : file_(drop_torn_tail(path) ? std::fopen(path.c_str(), "ab") : nullptr), queue_(queue_capacity) {
+        if (file_) {
+            std::fseek(file_, 0, SEEK_END);
+            long size = std::ftell(file_);
+            next_sequence_ = size > 0 ? uint64_t(size) / sizeof(JournalRecord) : 0;
+            written_.store(next_sequence_);
+            writer_ = std::thread(&Journal::run_writer, this);
+        }
+    }
+
+    Journal::~Journal() {
+        close();
+    }
+
+    void Journal::append(JournalRecord record) {
+        if (!file_ || failed_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        record.sequence = next_sequence_++;
+        utils::BackoffWait wait;
+        while (!queue_.try_push(record)) {
+            wait.wait();
+        }
+    }
+
+    bool Journal::flush() {
+        while (written_.load(std::memory_order_acquire) < next_sequence_) {
+            if (failed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return !failed_.load(std::memory_order_acquire);
+    }
+
+    void Journal::close() {
+        if (!file_) {
+            return;
+        }
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    // Drains the queue into one group until it is full or the queue runs
+    // dry, then writes and flushes the group in one go. Backs off while idle
+    // so the writer does not take a core from the matcher. Once a write or
+    // flush fails nothing more is written - a journal with a hole in it
+    // would replay wrong - and the queue is only drained so append never
+    // waits on it
+    void Journal::run_writer() {
+        std::vector<JournalRecord> group(GROUP_SIZE);
+        utils::BackoffWait wait;
+        while (true) {
+            size_t n = 0;
+            while (n < GROUP_SIZE) {
+                size_t popped = queue_.pop_batch(group.data() + n, GROUP_SIZE - n);
+                if (popped == 0) {
+                    break;
+                }
+                n += popped;
+            }
+            if (n > 0) {
+                if (!failed_.load(std::memory_order_relaxed)) {
+                    bool ok = std::fwrite(group.data(), sizeof(JournalRecord), n, file_) == n;
+                    ok = std::fflush(file_) == 0 && ok;
+                    if (ok) {
+                        written_.fetch_add(n, std::memory_order_release);
+                    } else {
+                        failed_.store(true, std::memory_order_release);
+                    }
+                }
+                wait.reset();
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire) && queue_.empty()) {
+                break;
+            }
+            wait.wait();
+        }
+    }
+
+    bool Journal::read(const std::string& path, std::vector<JournalRecord>& records) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        JournalRecord chunk[1024];
+        size_t n;
+        while ((n = std::fread(chunk, sizeof(JournalRecord), 1024, file)) > 0) {
+            records.insert(records.end(), chunk, chunk + n);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    size_t replay_journal(const std::string& path, MatchingEngine& engine, uint64_t from_sequence) {
+        std::vector<JournalRecord> records;
+        if (!Journal::read(path, records)) {
+            return 0;
+        }
+
+        ExecutionRing executions;
+        std::vector<OrderMessage> batch;
+        size_t applied = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            const JournalRecord& r = records[i];
+            if (r.sequence < from_sequence) {
+                continue;
+            }
+            Side side = Side(r.side);
+            executions.clear();
+            switch (r.type) {
+            case JournalRecordType::ADD:
+                engine.submit_order(r.symbol_id, r.order_id, side, r.price, r.quantity, OrderType(r.order_type),
+                                    executions);
+                break;
+            case JournalRecordType::REST:
+                engine.submit_order(r.symbol_id, r.order_id, side, r.price, r.quantity);
+                break;
+            case JournalRecordType::BATCH_ADD: {
+                // the rest of the group is the run of BATCH_ADDs for this symbol
+                batch.clear();
+                size_t end = i;
+                for (; end < records.size() && records[end].type == JournalRecordType::BATCH_ADD &&
+                       records[end].symbol_id == r.symbol_id; ++end) {
+                    const JournalRecord& m = records[end];
+                    batch.push_back(OrderMessage{m.symbol_id, Side(m.side), m.order_id, m.price, m.quantity});
+                }
+                OrderBook* book = engine.get_order_book(r.symbol_id);
+                if (book) {
+                    book->add_orders(batch.data(), batch.size());
+                    book->match_orders(executions);
+                }
+                applied += end - i - 1;
+                i = end - 1;
+                break;
+            }
+            case JournalRecordType::CANCEL:
+                engine.cancel_order(r.symbol_id, r.order_id);
+                break;
+            case JournalRecordType::MODIFY:
+                engine.modify_order(r.symbol_id, r.order_id, r.price, r.quantity);
+                break;
+            case JournalRecordType::AMEND:
+                engine.modify_order(r.symbol_id, r.order_id, r.price, r.quantity, executions);
+                break;
+            case JournalRecordType::MATCH:
+                engine.match_orders(r.symbol_id, executions);
+                break;
+            case JournalRecordType::TRADE:
+                continue;
+            }
+            ++applied;
+        }
+        return applied;
+    }
+
+} // namespace order_matching
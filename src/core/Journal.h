@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Execution.h"
+#include "Instrument.h"
+#include "Order.h"
+#include "../utils/SpscQueue.h"
+
+namespace order_matching {
+
+    class MatchingEngine;
+
+    // What a journal record describes. Replaying the order records in file
+    // order rebuilds the books: ADD matches on arrival, REST only rests (a
+    // later MATCH runs the pass), consecutive BATCH_ADDs of one symbol are
+    // one add_orders group followed by a match pass. MODIFY amends without
+    // matching, AMEND is the continuous amend that matches if it crosses.
+    // TRADE records are the fills those produced, kept for downstream
+    // consumers; replay skips them
+    enum class JournalRecordType : uint8_t { ADD, REST, BATCH_ADD, CANCEL, MODIFY, MATCH, TRADE, AMEND };
+
+    // One fixed-size record. For TRADE, order_id is the buy order and
+    // contra_order_id the sell order; sequence is the record's position in
+    // the file, stamped by append (a reopened journal carries on counting)
+    struct JournalRecord {
+        JournalRecordType type;
+        uint8_t side;           // Side
+        uint8_t order_type;     // OrderType, ADD only
+        uint8_t reserved;
+        SymbolId symbol_id;
+        uint64_t sequence;
+        uint64_t order_id;
+        uint64_t contra_order_id;
+        uint64_t trade_id;
+        Price price;            // in ticks
+        Quantity quantity;      // in lots
+    };
+
+    static_assert(std::is_trivially_copyable<JournalRecord>::value, "journal records are written as raw bytes");
+    static_assert(sizeof(JournalRecord) == 56, "the on-disk record layout is fixed");
+
+    //
+    // Append-only binary journal. The matching thread appends records to a
+    // lock-free queue and carries on; a dedicated writer thread drains it and
+    // writes whole groups with one fwrite and one fflush, so the matching
+    // thread never waits on the file. append only waits if the writer falls
+    // a full queue behind.
+    //
+    // A journal opened over a file whose last record was cut short by a
+    // crash truncates that record first, so new records start on a record
+    // boundary.
+    //
+    // One thread appends (the engine's matching thread).
+    class Journal {
+    public:
+        explicit Journal(const std::string& path, size_t queue_capacity = 65536);
+        ~Journal();
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        // false if the file could not be opened; append is then a no-op
+        bool is_open() const { return file_ != nullptr; }
+
+        void append(JournalRecord record);
+
+        // Blocks until everything appended so far has been handed to the OS.
+        // False, without waiting further, once the journal has failed
+        bool flush();
+
+        // Sticky: a write or flush to the file failed (disk full, I/O
+        // error). Records from the failed group on are not in the file and
+        // not counted as written; later appends are dropped
+        bool has_failed() const { return failed_.load(std::memory_order_acquire); }
+
+        // Writes out what is queued, joins the writer and closes the file
+        void close();
+
+        uint64_t get_records_appended() const { return next_sequence_; }
+        uint64_t get_records_written() const { return written_.load(std::memory_order_acquire); }
+        uint64_t get_bytes_written() const { return get_records_written() * sizeof(JournalRecord); }
+
+        // Reads every record of a journal file; false if it cannot be opened.
+        // A partly written last record (a crash mid-write) is ignored
+        static bool read(const std::string& path, std::vector<JournalRecord>& records);
+
+    private:
+        static constexpr size_t GROUP_SIZE = 4096;   // records per write
+
+        std::FILE* file_;
+        utils::SpscQueue<JournalRecord> queue_;
+        std::thread writer_;
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> failed_{false};
+        uint64_t next_sequence_ = 0;            // appender side
+
+        alignas(utils::CACHE_LINE) std::atomic<uint64_t> written_{0};
+
+        void run_writer();
+    };
+
+    // Rebuilds books from a journal: applies its order records to engine,
+    // which must already have a book for each symbol id in the file and no
+    // journal attached. from_sequence skips what a snapshot already holds
+    // (see restore_snapshot). Returns how many order records were applied,
+    // or 0 if the file cannot be read
+    size_t replay_journal(const std::string& path, MatchingEngine& engine, uint64_t from_sequence = 0);
+
+} // namespace order_matching
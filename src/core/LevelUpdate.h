@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Instrument.h"
+#include "../utils/RingBuffer.h"
+
+namespace order_matching {
+
+    // A price level's new aggregate after a book changed it. quantity and
+    // order_count are what rests at price now - both 0 once the level is
+    // gone. sequence counts the book's level changes, one per update
+    struct LevelUpdate {
+        uint64_t sequence;
+        Price price;            // in ticks
+        Quantity quantity;      // in lots
+        uint32_t order_count;
+        uint8_t side;           // Side
+        uint8_t reserved[3];
+    };
+
+    static_assert(std::is_trivially_copyable<LevelUpdate>::value, "level updates are copied around as raw data");
+    static_assert(sizeof(LevelUpdate) == 32, "two level updates per cache line");
+
+    // Caller-owned, preallocated queue a book pushes its level updates to
+    typedef utils::RingBuffer<LevelUpdate> LevelUpdateRing;
+
+} // namespace order_matching
@@ -1,82 +1,372 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
-#include <map>
 #include <string>
+#include <vector>
+#include "Journal.h"
 #include "OrderBook.h"
 #include "Order.h"
+#include "OrderMessage.h"
+#include "SymbolRegistry.h"
 #include "Trade.h"
 
 namespace order_matching {
 
 //
 // matching engine that manages multiple order books (one per symbol: ie. AAPL, TSLA)
+//
+// Symbols are interned when their book is created and books sit in a flat
+// vector indexed by SymbolId, so routing an order is an array index. The
+// string overloads resolve the symbol once through the registry and are
+// meant for the edges (setup, display).
 class MatchingEngine {
 private:
-    // Order books by symbol
-    std::map<std::string, std::unique_ptr<OrderBook>> order_books_;
+    SymbolRegistry symbols_;
+
+    // Order books by SymbolId
+    std::vector<std::unique_ptr<OrderBook>> order_books_;
+
+    // submit_batch works in chunks of this many messages
+    size_t batch_size_ = DEFAULT_BATCH_SIZE;
+
+    // per-book message groups of the current chunk (by SymbolId) and the
+    // books that have one; cleared, not freed, between chunks
+    std::vector<std::vector<OrderMessage>> batch_groups_;
+    std::vector<SymbolId> batch_books_;
+
+    // not owned; null when nothing is persisted
+    Journal* journal_ = nullptr;
+
+    OrderBook* book_for(SymbolId symbol_id) const {
+        return symbol_id < order_books_.size() ? order_books_[symbol_id].get() : nullptr;
+    }
+
+    void journal_order(JournalRecordType type, SymbolId symbol_id, Order::OrderId id, Side side, Price price,
+                       Quantity quantity, OrderType order_type = LIMIT) {
+        journal_->append(JournalRecord{type, uint8_t(side), uint8_t(order_type), 0, symbol_id, 0, id, 0, 0,
+                                       price, quantity});
+    }
+
+    void journal_trade(SymbolId symbol_id, unsigned long trade_id, Order::OrderId buy_id, Order::OrderId sell_id,
+                       Price price, Quantity quantity) {
+        journal_->append(JournalRecord{JournalRecordType::TRADE, 0, 0, 0, symbol_id, 0, buy_id, sell_id, trade_id,
+                                       price, quantity});
+    }
+
+    // fills a call pushed to executions / trades, from position from on
+    void journal_executions(const ExecutionRing& executions, size_t from) {
+        for (size_t i = from; i < executions.size(); ++i) {
+            const Execution& e = executions[i];
+            journal_trade(e.symbol_id, e.trade_id, e.buy_order_id, e.sell_order_id, e.price, e.quantity);
+        }
+    }
+
+    void journal_trades(const std::vector<Trade>& trades, size_t from) {
+        for (size_t i = from; i < trades.size(); ++i) {
+            const Trade& t = trades[i];
+            journal_trade(t.get_symbol_id(), t.get_trade_id(), t.get_buy_order_id(), t.get_sell_order_id(),
+                          t.get_price(), t.get_quantity());
+        }
+    }
 
 public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+
     MatchingEngine() {}
     ~MatchingEngine() {}
 
-    // Set OrderBook
-    void create_order_book(const std::string& symbol, std::unique_ptr<OrderBook> book) {
-        order_books_[symbol] = std::move(book);
+    // Set OrderBook - returns the symbol's id
+    SymbolId create_order_book(const std::string& symbol, std::unique_ptr<OrderBook> book) {
+        SymbolId id = symbols_.intern(symbol);
+        if (id >= order_books_.size()) {
+            order_books_.resize(id + 1);
+            batch_groups_.resize(id + 1);
+        }
+        book->set_symbol_id(id);
+        order_books_[id] = std::move(book);
+        return id;
+    }
+
+    // Create a book of the given implementation for an instrument
+    SymbolId create_order_book(const Instrument& instrument, OrderBookType type = OrderBookType::BTREE) {
+        return create_order_book(instrument.symbol, make_order_book(type, instrument));
+    }
+
+    // INVALID_SYMBOL if no book was created for symbol
+    SymbolId get_symbol_id(const std::string& symbol) const {
+        return symbols_.find(symbol);
+    }
+
+    const std::string& get_symbol(SymbolId symbol_id) const {
+        return symbols_.name(symbol_id);
     }
 
     // Get OrderBook (needed for export)
+    OrderBook* get_order_book(SymbolId symbol_id) {
+        return book_for(symbol_id);
+    }
+
     OrderBook* get_order_book(const std::string& symbol) {
-        auto it = order_books_.find(symbol);
-        if (it != order_books_.end()) {
-            return it->second.get();
-        }
-        return nullptr;
+        return book_for(symbols_.find(symbol));
+    }
+
+    // Every accepted add, cancel and amend, and every fill, is appended to
+    // journal from now on (null stops journaling). The journal must outlive
+    // its use here; the engine's calling thread is its one appender
+    void set_journal(Journal* journal) {
+        journal_ = journal;
+    }
+
+    Journal* get_journal() const {
+        return journal_;
     }
 
     // Submit an order to the appropriate book
-    bool submit_order(std::shared_ptr<Order> order) {
-        auto it = order_books_.find(order->get_symbol());
-        if (it != order_books_.end()) {
-            return it->second->add_order(order);
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            bool accepted = book->add_order(id, side, price, quantity);
+            if (accepted && journal_) {
+                journal_order(JournalRecordType::REST, symbol_id, id, side, price, quantity);
+            }
+            return accepted;
         }
         return false; // No book for this symbol
     }
 
+    // Continuous mode: the order matches on arrival, fills are appended to trades
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity,
+                      std::vector<Trade>& trades) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            size_t from = trades.size();
+            bool accepted = book->add_order(id, side, price, quantity, trades);
+            if (accepted && journal_) {
+                journal_order(JournalRecordType::ADD, symbol_id, id, side, price, quantity);
+                journal_trades(trades, from);
+            }
+            return accepted;
+        }
+        return false;
+    }
+
+    // Continuous mode into a caller-owned execution ring, no per-fill
+    // allocation. type selects limit, market, IOC or FOK handling
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity,
+                      OrderType type, ExecutionRing& executions) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            size_t from = executions.size();
+            bool accepted = book->add_order(id, side, price, quantity, type, executions);
+            if (accepted && journal_) {
+                journal_order(JournalRecordType::ADD, symbol_id, id, side, price, quantity, type);
+                journal_executions(executions, from);
+            }
+            return accepted;
+        }
+        return false;
+    }
+
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity,
+                      ExecutionRing& executions) {
+        return submit_order(symbol_id, id, side, price, quantity, LIMIT, executions);
+    }
+
+    bool submit_order(const std::shared_ptr<Order>& order) {
+        OrderBook* book = order ? book_for(order->get_symbol_id()) : nullptr;
+        if (book) {
+            bool accepted = book->add_order(order);
+            if (accepted && journal_) {
+                journal_order(JournalRecordType::REST, order->get_symbol_id(), order->get_order_id(),
+                              order->get_side(), order->get_price(), order->get_remaining_quantity());
+            }
+            return accepted;
+        }
+        return false;
+    }
+
+    // Batched entry. Messages are taken batch_size at a time and grouped by
+    // book; each book rests its group with one level lookup per distinct
+    // price (OrderBook::add_orders) and then runs one match pass, with fills
+    // pushed to executions. Messages for unknown symbols are skipped.
+    // Journaled as the messages each book's group accepted, so replay only
+    // sees input that rested. Returns how many orders were accepted
+    size_t submit_batch(const OrderMessage* orders, size_t count, ExecutionRing& executions) {
+        size_t accepted = 0;
+        for (size_t begin = 0; begin < count; begin += batch_size_) {
+            size_t end = std::min(count, begin + batch_size_);
+            for (size_t i = begin; i < end; ++i) {
+                SymbolId symbol_id = orders[i].symbol_id;
+                if (book_for(symbol_id) == nullptr) {
+                    continue;
+                }
+                std::vector<OrderMessage>& group = batch_groups_[symbol_id];
+                if (group.empty()) {
+                    batch_books_.push_back(symbol_id);
+                }
+                group.push_back(orders[i]);
+            }
+
+            for (SymbolId symbol_id : batch_books_) {
+                std::vector<OrderMessage>& group = batch_groups_[symbol_id];
+                OrderBook* book = order_books_[symbol_id].get();
+                size_t from = executions.size();
+                accepted += book->add_orders(group.data(), group.size());
+                book->match_orders(executions);
+                if (journal_) {
+                    for (size_t i = 0; i < group.size(); ++i) {
+                        const OrderMessage& m = group[i];
+                        if (book->batch_accepted(i)) {
+                            journal_order(JournalRecordType::BATCH_ADD, symbol_id, m.order_id, m.side, m.price,
+                                          m.quantity);
+                        }
+                    }
+                    journal_executions(executions, from);
+                }
+                group.clear();
+            }
+            batch_books_.clear();
+        }
+        return accepted;
+    }
+
+    size_t submit_batch(const std::vector<OrderMessage>& orders, ExecutionRing& executions) {
+        return submit_batch(orders.data(), orders.size(), executions);
+    }
+
+    // Cancels are a direct id lookup in their book, so they need no grouping.
+    // Returns how many were cancelled
+    size_t cancel_batch(const CancelMessage* cancels, size_t count) {
+        size_t cancelled = 0;
+        for (size_t i = 0; i < count; ++i) {
+            cancelled += cancel_order(cancels[i].symbol_id, cancels[i].order_id);
+        }
+        return cancelled;
+    }
+
+    size_t cancel_batch(const std::vector<CancelMessage>& cancels) {
+        return cancel_batch(cancels.data(), cancels.size());
+    }
+
+    // Messages per submit_batch chunk: larger chunks share more level
+    // lookups and match passes, smaller ones match sooner
+    void set_batch_size(size_t batch_size) {
+        batch_size_ = std::max<size_t>(batch_size, 1);
+    }
+
+    size_t get_batch_size() const {
+        return batch_size_;
+    }
+
     // Cancel an order
+    bool cancel_order(SymbolId symbol_id, Order::OrderId order_id) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            bool cancelled = book->cancel_order(order_id);
+            if (cancelled && journal_) {
+                journal_order(JournalRecordType::CANCEL, symbol_id, order_id, BUY, 0, 0);
+            }
+            return cancelled;
+        }
+        return false;
+    }
+
     bool cancel_order(const std::string& symbol, Order::OrderId order_id) {
-        auto it = order_books_.find(symbol);
-        if (it != order_books_.end()) {
-            return it->second->cancel_order(order_id);
+        return cancel_order(symbols_.find(symbol), order_id);
+    }
+
+    // Amend a resting order's price and quantity in place, see OrderBook
+    const Order* modify_order(SymbolId symbol_id, Order::OrderId order_id, Price price, Quantity quantity) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            const Order* order = book->modify_order(order_id, price, quantity);
+            if (order && journal_) {
+                journal_order(JournalRecordType::MODIFY, symbol_id, order_id, order->get_side(), price, quantity);
+            }
+            return order;
+        }
+        return nullptr;
+    }
+
+    const Order* modify_order(const std::string& symbol, Order::OrderId order_id, Price price, Quantity quantity) {
+        return modify_order(symbols_.find(symbol), order_id, price, quantity);
+    }
+
+    // Continuous mode amend: a crossing amend matches before it rests, fills
+    // are pushed to executions
+    bool modify_order(SymbolId symbol_id, Order::OrderId order_id, Price price, Quantity quantity,
+                      ExecutionRing& executions) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            const Order* order = book->find_order(order_id);
+            Side side = order ? order->get_side() : BUY;
+            size_t from = executions.size();
+            bool accepted = book->modify_order(order_id, price, quantity, executions);
+            if (accepted && journal_) {
+                journal_order(JournalRecordType::AMEND, symbol_id, order_id, side, price, quantity);
+                journal_executions(executions, from);
+            }
+            return accepted;
         }
         return false;
     }
 
     // Run matching for a specific symbol
-    std::vector<Trade> match_orders(const std::string& symbol) {
-        auto it = order_books_.find(symbol);
-        if (it != order_books_.end()) {
-            return it->second->match_orders();
+    std::vector<Trade> match_orders(SymbolId symbol_id) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            std::vector<Trade> trades = book->match_orders();
+            if (!trades.empty() && journal_) {
+                journal_order(JournalRecordType::MATCH, symbol_id, 0, BUY, 0, 0);
+                journal_trades(trades, 0);
+            }
+            return trades;
         }
         return {};
     }
 
-    // Get market data
-    double get_best_bid(const std::string& symbol) const {
-        auto it = order_books_.find(symbol);
-        if (it != order_books_.end()) {
-            return it->second->get_best_bid();
-        }
-        return 0.0;
+    std::vector<Trade> match_orders(const std::string& symbol) {
+        return match_orders(symbols_.find(symbol));
     }
 
-    double get_best_ask(const std::string& symbol) const {
-        auto it = order_books_.find(symbol);
-        if (it != order_books_.end()) {
-            return it->second->get_best_ask();
+    // pushes fills to executions; false if there is no book for the symbol
+    bool match_orders(SymbolId symbol_id, ExecutionRing& executions) {
+        OrderBook* book = book_for(symbol_id);
+        if (book) {
+            size_t from = executions.size();
+            book->match_orders(executions);
+            if (executions.size() != from && journal_) {
+                journal_order(JournalRecordType::MATCH, symbol_id, 0, BUY, 0, 0);
+                journal_executions(executions, from);
+            }
+            return true;
         }
-        return 0.0;
+        return false;
+    }
+
+    // Get market data (prices in ticks of the symbol's instrument)
+    Price get_best_bid(SymbolId symbol_id) const {
+        OrderBook* book = book_for(symbol_id);
+        return book ? book->get_best_bid() : 0;
+    }
+
+    Price get_best_ask(SymbolId symbol_id) const {
+        OrderBook* book = book_for(symbol_id);
+        return book ? book->get_best_ask() : 0;
+    }
+
+    Price get_best_bid(const std::string& symbol) const {
+        return get_best_bid(symbols_.find(symbol));
+    }
+
+    Price get_best_ask(const std::string& symbol) const {
+        return get_best_ask(symbols_.find(symbol));
+    }
+
+    size_t get_symbol_count() const {
+        return symbols_.size();
     }
 };
 
-} // namespace order_matching
\ No newline at end of file
+} // namespace order_matching
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <chrono>
-#include <string>
+
+#include "Instrument.h"
 
 namespace order_matching {
 
@@ -9,6 +10,13 @@ namespace order_matching {
 
     enum OrderStatus { NEW, PARTIALLY_FILLED, FILLED, CANCELLED };
 
+    // LIMIT rests whatever does not trade; MARKET trades at any price and
+    // IOC up to its limit, both dropping the rest; FOK fills in full or not
+    // at all
+    enum OrderType { LIMIT, MARKET, IOC, FOK };
+
+    struct PriceLevel;
+
     class Order {
     public:
         typedef unsigned long OrderId;
@@ -16,32 +24,45 @@ namespace order_matching {
     private:
         OrderId order_id;
         Side side;
-        double price;
-        double quantity;
-        double remaining_quantity;
-        std::string symbol;
+        Price price;                  // in ticks
+        Quantity quantity;            // in lots
+        Quantity remaining_quantity;
+        SymbolId symbol_id;
+        OrderType type;
         OrderStatus status;
         long timestamp;  // Simple timestamp
 
+        // intrusive queue hooks, owned by the PriceLevel the order rests at
+        friend struct PriceLevel;
+        Order* prev_in_level;
+        Order* next_in_level;
+        PriceLevel* level;
+
     public:
-        Order(OrderId id, Side s, double p, double qty, const std::string& sym)
+        Order(OrderId id, Side s, Price p, Quantity qty, SymbolId sym, OrderType t = LIMIT)
             : order_id(id), side(s), price(p), quantity(qty),
-              remaining_quantity(qty), symbol(sym), status(NEW) {
+              remaining_quantity(qty), symbol_id(sym), type(t), status(NEW),
+              prev_in_level(nullptr), next_in_level(nullptr), level(nullptr) {
             timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
         }
 
         // getters
         OrderId get_order_id() const { return order_id; }
         Side get_side() const { return side; }
-        double get_price() const { return price; }
-        double get_quantity() const { return quantity; }
-        double get_remaining_quantity() const { return remaining_quantity; }
-        const std::string& get_symbol() const { return symbol; }
+        Price get_price() const { return price; }
+        Quantity get_quantity() const { return quantity; }
+        Quantity get_remaining_quantity() const { return remaining_quantity; }
+        SymbolId get_symbol_id() const { return symbol_id; }
+        OrderType get_type() const { return type; }
         OrderStatus get_status() const { return status; }
         long get_timestamp() const { return timestamp; }
 
+        // resting state - null level means the order is not in a book
+        PriceLevel* get_level() const { return level; }
+        Order* get_next_in_level() const { return next_in_level; }
+
         // setters
-        void set_remaining_quantity(double qty) {
+        void set_remaining_quantity(Quantity qty) {
             remaining_quantity = qty;
             if (remaining_quantity <= 0) {
                 status = FILLED;
@@ -54,6 +75,19 @@ namespace order_matching {
             status = CANCELLED;
         }
 
+        // replaces the price and open quantity, keeping what already traded.
+        // A new price or a larger quantity goes to the back of the queue, so
+        // it takes a fresh timestamp
+        void amend(Price p, Quantity remaining) {
+            if (p != price || remaining > remaining_quantity) {
+                timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            }
+            quantity += remaining - remaining_quantity;
+            price = p;
+            remaining_quantity = remaining;
+            status = remaining_quantity < quantity ? PARTIALLY_FILLED : NEW;
+        }
+
         bool is_filled() const {
             return remaining_quantity <= 0;
         }
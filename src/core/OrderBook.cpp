@@ -1,8 +1 @@
 #include "OrderBook.h"
-
-namespace order_matching {
-
-    // Define the static member
-    unsigned long OrderBook::next_trade_id = 1;
-
-} // namespace order_matching
\ No newline at end of file
@@ -1,48 +1,365 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
+#include "Execution.h"
+#include "Instrument.h"
+#include "LevelUpdate.h"
 #include "Order.h"
+#include "OrderEvent.h"
+#include "OrderMessage.h"
+#include "PriceLevel.h"
+#include "Snapshot.h"
+#include "TopOfBook.h"
 #include "Trade.h"
+#include "../utils/Seqlock.h"
 
 namespace order_matching {
 
     class OrderBook {
     public:
+        explicit OrderBook(const Instrument& instrument) : instrument_(instrument) {}
         virtual ~OrderBook() {}
 
-        // Core operations
-        virtual bool add_order(std::shared_ptr<Order> order) = 0;
+        // Core operations. Orders are created in the book's own storage and
+        // the id is the handle for cancels and lookups while they rest
+        virtual bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity) = 0;
         virtual bool cancel_order(Order::OrderId order_id) = 0;
-        virtual std::vector<Trade> match_orders() = 0;
 
-        // queries - return 0 if no orders
-        virtual double get_best_bid() const = 0;
-        virtual double get_best_ask() const = 0;
+        // Rests a batch of orders (the messages' symbol ids are not checked).
+        // Orders for the same side and price join their level together, in
+        // arrival order, behind a single level lookup. Nothing is matched -
+        // run match_orders after. Returns how many were accepted; empty
+        // orders and ids already resting are skipped
+        virtual size_t add_orders(const OrderMessage* orders, size_t count) = 0;
+
+        // Whether the last add_orders call accepted its message at index
+        bool batch_accepted(size_t index) const {
+            return index < batch_orders_.size() && batch_orders_[index] != nullptr;
+        }
+
+        // Amends a resting order in place to price and open quantity. The
+        // same price with less quantity keeps queue priority; anything else
+        // moves the order to the back of the queue at price. The Order and
+        // its id stay the same. Returns the amended order, nullptr if the id
+        // is not resting or the amend was refused (quantity <= 0). Like
+        // add_order it does not match - a crossing amend waits for
+        // match_orders. Continuous mode uses the overload below
+        virtual const Order* modify_order(Order::OrderId order_id, Price price, Quantity quantity) = 0;
+
+        // Continuous amend: an amend that crosses the spread trades first,
+        // like an incoming order at its new price and quantity, with fills
+        // pushed to executions, and only the remainder rests, at the back of
+        // the queue. True if the amend was accepted, whether the order then
+        // traded, rested or both
+        virtual bool modify_order(Order::OrderId order_id, Price price, Quantity quantity,
+                                  ExecutionRing& executions) = 0;
+        virtual void match_orders(ExecutionRing& executions) = 0;    // pushes fills to executions
+
+        // Continuous matching: the order first trades against the opposite
+        // side up to its limit price and only the remainder rests. Fills are
+        // pushed to executions. True if the order was accepted, whether it
+        // traded, rested or both.
+        // Market orders ignore price; market and IOC remainders are
+        // cancelled rather than rested, and they are refused if nothing
+        // traded. FOK is refused without touching the book unless
+        // get_available_quantity covers it in full
+        virtual bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                               ExecutionRing& executions) = 0;
+
+        bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity,
+                       ExecutionRing& executions) {
+            return add_order(id, side, price, quantity, LIMIT, executions);
+        }
+
+        // std::vector<Trade> adapters over the execution interface: fills go
+        // through the book's scratch ring and are appended to trades
+        void match_orders(std::vector<Trade>& trades) {
+            match_orders(scratch_executions_);
+            append_trades(trades);
+        }
+
+        bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                       std::vector<Trade>& trades) {
+            bool accepted = add_order(id, side, price, quantity, type, scratch_executions_);
+            append_trades(trades);
+            return accepted;
+        }
+
+        bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity,
+                       std::vector<Trade>& trades) {
+            return add_order(id, side, price, quantity, LIMIT, trades);
+        }
+
+        // Adapters for callers that build Order objects. The book rests its
+        // own copy, so fills and cancels show up through find_order rather
+        // than on the caller's object. Only limit orders can rest
+        bool add_order(const std::shared_ptr<Order>& order) {
+            if (!order || order->get_symbol_id() != symbol_id_ || order->get_type() != LIMIT) {
+                return false;
+            }
+            return add_order(order->get_order_id(), order->get_side(), order->get_price(),
+                             order->get_remaining_quantity());
+        }
+
+        std::vector<Trade> match_orders() {
+            std::vector<Trade> trades;
+            trades.reserve(100);
+            match_orders(trades);
+            return trades;
+        }
+
+        // Resting order by id, nullptr once it has filled or been cancelled
+        virtual const Order* find_order(Order::OrderId order_id) const = 0;
+
+        // Pre-size order, level and index storage for this many resting orders
+        virtual void reserve(size_t orders) = 0;
+
+        // Snapshot support. export_orders appends every resting order in
+        // price-time order (see SnapshotOrder); load_orders rebuilds an
+        // empty book from that sequence in one pass and returns false, with
+        // the book untouched, unless is_loadable holds. Ids already loaded
+        // are skipped
+        virtual void export_orders(std::vector<SnapshotOrder>& orders) const = 0;
+        virtual bool load_orders(const SnapshotOrder* orders, size_t count) = 0;
+
+        // whether load_orders would take the sequence: nothing rests in the
+        // book and the sequence is in order. Books that cannot hold every
+        // price add their own limits
+        virtual bool is_loadable(const SnapshotOrder* orders, size_t count) const {
+            return get_bid_count() + get_ask_count() == 0 && snapshot_bid_count(orders, count) <= count;
+        }
+
+        // trade ids carry on from a snapshot instead of restarting at 1
+        unsigned long get_next_trade_id() const { return next_trade_id; }
+        void set_next_trade_id(unsigned long id) { next_trade_id = id; }
+
+        // queries - prices in ticks, return 0 if no orders
+        virtual Price get_best_bid() const = 0;
+        virtual Price get_best_ask() const = 0;
+        virtual Quantity get_best_bid_size() const = 0;
+        virtual Quantity get_best_ask_size() const = 0;
         virtual size_t get_bid_count() const = 0;
         virtual size_t get_ask_count() const = 0;
         virtual size_t get_total_orders() const = 0;
 
+        // Resting quantity on side that an incoming order limited at limit
+        // could trade against: asks at or below it, bids at or above it
+        virtual Quantity get_available_quantity(Side side, Price limit) const = 0;
+
         // Order book levels for display
         struct Level {
-            double price;
-            double quantity;
+            Price price;
+            Quantity quantity;
             size_t order_count;
 
-            Level(double p, double qty, size_t orders)
+            Level(Price p, Quantity qty, size_t orders)
                 : price(p), quantity(qty), order_count(orders) {}
         };
 
         virtual std::vector<Level> get_bid_levels(size_t max_levels = 10) const = 0;
         virtual std::vector<Level> get_ask_levels(size_t max_levels = 10) const = 0;
 
+        // tick/lot spec used to convert to and from display units
+        const Instrument& get_instrument() const { return instrument_; }
+        const std::string& get_symbol() const { return instrument_.symbol; }
+
+        // id stamped on this book's orders and trades. 0 for a standalone
+        // book; the engine assigns the registry id when it takes the book
+        SymbolId get_symbol_id() const { return symbol_id_; }
+        void set_symbol_id(SymbolId id) { symbol_id_ = id; }
+
+        // Lock-free BBO snapshot, safe from any thread while the book's own
+        // thread keeps mutating it: the book republishes after every call
+        // that changes it (one publish per call, not per fill)
+        TopOfBook get_top_of_book() const { return top_of_book_.load(); }
+
+        // Level-change feed. While a ring is set, every call that changes a
+        // level pushes one LevelUpdate per change to it, in the order they
+        // happen (a sweep reports each fill). The ring is the caller's and is
+        // drained on the book's thread; null, the default, stops the feed.
+        // The sequence counts changes whether or not a ring is set
+        void set_level_updates(LevelUpdateRing* updates) { level_updates_ = updates; }
+        LevelUpdateRing* get_level_updates() const { return level_updates_; }
+        uint64_t get_level_sequence() const { return level_sequence_; }
+
+        // Order-by-order feed. While a queue is set, every add, cancel, fill
+        // and amend of a resting order pushes one OrderEvent, in the order
+        // they happen; another thread may drain the queue. A full queue
+        // drops the event - get_order_events_dropped counts them and the
+        // consumer sees the gap in sequence. Null, the default, stops it
+        void set_order_events(OrderEventQueue* events) { order_events_ = events; }
+        OrderEventQueue* get_order_events() const { return order_events_; }
+        uint64_t get_order_sequence() const { return order_sequence_; }
+        uint64_t get_order_events_dropped() const { return order_events_dropped_; }
+
     protected:
-        std::string symbol_;
-        static unsigned long next_trade_id;
+        Instrument instrument_;
+        SymbolId symbol_id_ = 0;
+        // per book, so books on different threads share nothing; a fill is
+        // identified by (symbol id, trade id)
+        unsigned long next_trade_id = 1;
 
         Trade::TradeId generate_trade_id() {
             return next_trade_id++;
         }
+
+        // add_orders scratch, kept to reuse its capacity. The book fills
+        // batch_orders_ (null for a refused message, and it stays null for
+        // one refused later on); group_by_level then lists the accepted
+        // positions level by level in batch_index_
+        std::vector<Order*> batch_orders_;
+        std::vector<uint32_t> batch_index_;
+
+        // Groups the accepted orders of a batch by side and price in one
+        // pass: a small hash table maps each level to a chain of positions,
+        // so each level becomes one run of batch_index_ in arrival order
+        void group_by_level(const OrderMessage* orders) {
+            const uint32_t none = ~uint32_t(0);
+            size_t count = batch_orders_.size();
+            size_t slots = 16;
+            while (slots < 2 * count) {
+                slots <<= 1;
+            }
+            batch_table_.assign(slots, none);
+            batch_next_.assign(count, none);
+            batch_heads_.clear();
+            batch_tails_.clear();
+
+            for (uint32_t i = 0; i < count; ++i) {
+                if (batch_orders_[i] == nullptr) {
+                    continue;
+                }
+                const OrderMessage& message = orders[i];
+                uint64_t key = uint64_t(message.price) * 2 + uint64_t(message.side);
+                size_t slot = size_t((key * 0x9E3779B97F4A7C15ull) >> 40) & (slots - 1);
+                for (;; slot = (slot + 1) & (slots - 1)) {
+                    uint32_t group = batch_table_[slot];
+                    if (group == none) {
+                        batch_table_[slot] = uint32_t(batch_heads_.size());
+                        batch_heads_.push_back(i);
+                        batch_tails_.push_back(i);
+                        break;
+                    }
+                    const OrderMessage& head = orders[batch_heads_[group]];
+                    if (head.price == message.price && head.side == message.side) {
+                        batch_next_[batch_tails_[group]] = i;
+                        batch_tails_[group] = i;
+                        break;
+                    }
+                }
+            }
+
+            batch_index_.clear();
+            for (uint32_t head : batch_heads_) {
+                for (uint32_t i = head; i != none; i = batch_next_[i]) {
+                    batch_index_.push_back(i);
+                }
+            }
+        }
+
+        // end of every mutating call, from the book's thread; a null level is
+        // an empty side
+        void publish_top_of_book(const PriceLevel* best_bid, const PriceLevel* best_ask) {
+            TopOfBook top;
+            top.bid_price = best_bid ? best_bid->price : 0;
+            top.bid_size = best_bid ? best_bid->total_quantity : 0;
+            top.bid_orders = best_bid ? uint32_t(best_bid->order_count) : 0;
+            top.ask_price = best_ask ? best_ask->price : 0;
+            top.ask_size = best_ask ? best_ask->total_quantity : 0;
+            top.ask_orders = best_ask ? uint32_t(best_ask->order_count) : 0;
+            top.last_trade_price = last_trade_price_;
+            top.last_trade_quantity = last_trade_quantity_;
+            top.sequence = ++top_sequence_;
+            top_of_book_.store(top);
+        }
+
+        // after every change to a level's quantity or order count, while
+        // the level is still alive (an emptied one reports 0)
+        void level_changed(Side side, const PriceLevel* level) {
+            ++level_sequence_;
+            if (level_updates_) {
+                level_updates_->push(LevelUpdate{level_sequence_, level->price, level->total_quantity,
+                                                 uint32_t(level->order_count), uint8_t(side), {}});
+            }
+        }
+
+        void order_event(OrderEventType type, const Order* order, Price price, Quantity quantity,
+                         uint64_t trade_id = 0, bool keeps_priority = false) {
+            ++order_sequence_;
+            if (order_events_ &&
+                !order_events_->try_push(OrderEvent{order_sequence_, order->get_order_id(), price, quantity, trade_id,
+                                                    type, uint8_t(order->get_side()), uint8_t(keeps_priority), {}})) {
+                ++order_events_dropped_;
+            }
+        }
+
+        // called per fill; only reaches readers with the next publish
+        void record_trade(Price price, Quantity quantity) {
+            last_trade_price_ = price;
+            last_trade_quantity_ = quantity;
+        }
+
+        // load_orders' precondition on the sequence: every bid before every
+        // ask, bids by falling price, asks by rising price, and each order
+        // with 0 < remaining <= quantity. Returns how many are bids, or
+        // count + 1 if the sequence is not in order
+        static size_t snapshot_bid_count(const SnapshotOrder* orders, size_t count) {
+            size_t bids = 0;
+            while (bids < count && orders[bids].side == BUY) {
+                ++bids;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                const SnapshotOrder& o = orders[i];
+                bool ordered = i == 0 || i == bids ||
+                               (i < bids ? orders[i - 1].price >= o.price : orders[i - 1].price <= o.price);
+                if ((i >= bids && o.side != SELL) || !ordered || o.remaining_quantity <= 0 ||
+                    o.remaining_quantity > o.quantity) {
+                    return count + 1;
+                }
+            }
+            return bids;
+        }
+
+        // limit that lets a market order cross every opposite level
+        static Price marketable_limit(Side side) {
+            return side == BUY ? std::numeric_limits<Price>::max() : std::numeric_limits<Price>::min();
+        }
+
+    private:
+        ExecutionRing scratch_executions_{256};
+
+        utils::Seqlock<TopOfBook> top_of_book_;
+        uint64_t top_sequence_ = 0;
+        Price last_trade_price_ = 0;
+        Quantity last_trade_quantity_ = 0;
+
+        LevelUpdateRing* level_updates_ = nullptr;     // not owned
+        uint64_t level_sequence_ = 0;
+
+        OrderEventQueue* order_events_ = nullptr;      // not owned
+        uint64_t order_sequence_ = 0;
+        uint64_t order_events_dropped_ = 0;
+
+        // group_by_level's hash table (slot -> group) and chains
+        std::vector<uint32_t> batch_table_;
+        std::vector<uint32_t> batch_next_;
+        std::vector<uint32_t> batch_heads_;
+        std::vector<uint32_t> batch_tails_;
+
+        void append_trades(std::vector<Trade>& trades) {
+            scratch_executions_.drain([&trades](const Execution& e) {
+                trades.emplace_back(e.trade_id, e.buy_order_id, e.sell_order_id, e.price, e.quantity, e.symbol_id);
+            });
+        }
     };
 
+    // Available book implementations, selectable per symbol
+    enum class OrderBookType { BTREE, PRICE_LADDER };
+
+    // defined with the implementations (implementations/OrderBookFactory.cpp)
+    std::unique_ptr<OrderBook> make_order_book(OrderBookType type, const Instrument& instrument);
+
 } // namespace order_matching
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Instrument.h"
+#include "Order.h"
+#include "../utils/SpscQueue.h"
+
+namespace order_matching {
+
+    // What happened to one resting order
+    //   ADD      the order now rests: price, quantity (its open size)
+    //   CANCEL   it left the book unfilled: quantity is what was open
+    //   EXECUTE  it traded: price, quantity filled, trade_id of the fill
+    //   AMEND    it was amended to price, quantity; keeps_priority says
+    //            whether it kept its place in the queue or went to the back
+    // An aggressive order only shows up once its remainder rests; its fills
+    // are the EXECUTEs of the orders it traded with
+    enum class OrderEventType : uint8_t { ADD, CANCEL, EXECUTE, AMEND };
+
+    // One order-by-order (L3) message. sequence counts the book's order
+    // events, one per message, so a consumer sees a gap if any were lost
+    struct OrderEvent {
+        uint64_t sequence;
+        Order::OrderId order_id;
+        Price price;                // in ticks
+        Quantity quantity;          // in lots
+        uint64_t trade_id;          // EXECUTE only
+        OrderEventType type;
+        uint8_t side;               // Side
+        uint8_t keeps_priority;     // AMEND only
+        uint8_t reserved[5];
+    };
+
+    static_assert(std::is_trivially_copyable<OrderEvent>::value, "order events are copied around as raw data");
+    static_assert(sizeof(OrderEvent) == 48, "the message layout is fixed");
+
+    // Bounded, preallocated ring from the book's thread to one consumer
+    // thread. It never grows: an event that finds it full is dropped and
+    // counted by the book
+    typedef utils::SpscQueue<OrderEvent> OrderEventQueue;
+
+} // namespace order_matching
@@ -0,0 +1,238 @@
+#include "OrderFile.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace order_matching {
+
+    namespace {
+
+        const char ORDER_FILE_MAGIC[8] = {'O', 'M', 'E', 'O', 'R', 'D', 'R', '\0'};
+        const uint32_t ORDER_FILE_VERSION = 1;
+
+        size_t padded(size_t bytes) {
+            return (bytes + 7) & ~size_t(7);
+        }
+
+        // [begin, end) of one CSV field
+        struct Field {
+            const char* begin;
+            const char* end;
+
+            bool equals(const char* text) const {
+                size_t n = std::strlen(text);
+                if (size_t(end - begin) != n) {
+                    return false;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    if (std::toupper(static_cast<unsigned char>(begin[i])) != std::toupper(static_cast<unsigned char>(text[i]))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+        // splits line at commas into fields, dropping a trailing \r
+        void split(const char* line, const char* end, std::vector<Field>& fields) {
+            fields.clear();
+            if (end > line && end[-1] == '\r') {
+                --end;
+            }
+            const char* begin = line;
+            for (const char* p = line; p <= end; ++p) {
+                if (p == end || *p == ',') {
+                    fields.push_back(Field{begin, p});
+                    begin = p + 1;
+                }
+            }
+        }
+
+        // strtod needs a terminated string; fields are short, so copy them
+        bool parse_double(const Field& field, double& value) {
+            char buffer[64];
+            size_t n = size_t(field.end - field.begin);
+            if (n == 0 || n >= sizeof(buffer)) {
+                return false;
+            }
+            std::memcpy(buffer, field.begin, n);
+            buffer[n] = '\0';
+            char* parsed;
+            value = std::strtod(buffer, &parsed);
+            return parsed == buffer + n;
+        }
+
+        // false rather than wrapping on values past uint64_t
+        bool parse_uint(const Field& field, uint64_t& value) {
+            if (field.begin == field.end) {
+                return false;
+            }
+            const uint64_t max = std::numeric_limits<uint64_t>::max();
+            value = 0;
+            for (const char* p = field.begin; p != field.end; ++p) {
+                if (*p < '0' || *p > '9') {
+                    // a timestamp written as a float still reads; 2^64 is
+                    // exact as a double, so the bound is too
+                    double d;
+                    if (!parse_double(field, d) || !(d >= 0 && d < 18446744073709551616.0)) {
+                        return false;
+                    }
+                    value = uint64_t(d);
+                    return true;
+                }
+                uint64_t digit = uint64_t(*p - '0');
+                if (value > (max - digit) / 10) {
+                    return false;
+                }
+                value = value * 10 + digit;
+            }
+            return true;
+        }
+
+    } // namespace
+
+    bool convert_order_csv(const std::string& csv_path, const std::string& out_path, double tick_size,
+                           double lot_size, size_t* skipped) {
+        // an empty file has no header, nor any mapping to scan
+        utils::MappedFile csv(csv_path);
+        if (!csv.is_open() || csv.size() == 0) {
+            return false;
+        }
+        const char* p = csv.data();
+        const char* end = p + csv.size();
+        auto next_line = [&p, end](const char*& line_end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+            line_end = nl ? nl : end;
+        };
+
+        // header row: where each column is
+        enum { ORDER_ID, TIMESTAMP, SYMBOL, SIDE, PRICE, QUANTITY, COLUMNS };
+        const char* names[COLUMNS] = {"order_id", "timestamp", "symbol", "side", "price", "quantity"};
+        size_t column[COLUMNS];
+        std::vector<Field> fields;
+        const char* line_end;
+        next_line(line_end);
+        split(p, line_end, fields);
+        for (size_t c = 0; c < COLUMNS; ++c) {
+            column[c] = fields.size();
+            for (size_t f = 0; f < fields.size(); ++f) {
+                if (fields[f].equals(names[c])) {
+                    column[c] = f;
+                }
+            }
+            if (column[c] == fields.size()) {
+                return false;
+            }
+        }
+        p = line_end == end ? end : line_end + 1;
+
+        Instrument instrument("", tick_size, lot_size);
+        std::vector<std::string> symbols;
+        std::unordered_map<std::string, uint32_t> symbol_index;
+        std::vector<OrderFileRecord> records;
+        size_t bad_rows = 0;
+        while (p < end) {
+            next_line(line_end);
+            split(p, line_end, fields);
+            p = line_end == end ? end : line_end + 1;
+            if (fields.size() == 1 && fields[0].begin == fields[0].end) {
+                continue;   // blank line
+            }
+
+            OrderFileRecord r = {};
+            double price, quantity;
+            bool ok = fields.size() >= COLUMNS && parse_uint(fields[column[ORDER_ID]], r.order_id) &&
+                      parse_uint(fields[column[TIMESTAMP]], r.timestamp_us) &&
+                      parse_double(fields[column[PRICE]], price) && parse_double(fields[column[QUANTITY]], quantity);
+            const Field& side = fields.size() >= COLUMNS ? fields[column[SIDE]] : fields[0];
+            ok = ok && (side.equals("BUY") || side.equals("SELL"));
+            if (ok) {
+                r.side = uint8_t(side.equals("BUY") ? BUY : SELL);
+                r.price = instrument.to_ticks(price);
+                r.quantity = instrument.to_lots(quantity);
+                ok = r.price > 0 && r.quantity > 0;
+            }
+            if (!ok) {
+                ++bad_rows;
+                continue;
+            }
+
+            const Field& symbol = fields[column[SYMBOL]];
+            std::string name(symbol.begin, symbol.end);
+            auto found = symbol_index.find(name);
+            if (found == symbol_index.end()) {
+                found = symbol_index.emplace(name, uint32_t(symbols.size())).first;
+                symbols.push_back(name);
+            }
+            r.symbol = found->second;
+            records.push_back(r);
+        }
+        if (skipped) {
+            *skipped = bad_rows;
+        }
+
+        std::FILE* file = std::fopen(out_path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        OrderFileHeader header = {};
+        std::memcpy(header.magic, ORDER_FILE_MAGIC, sizeof(header.magic));
+        header.version = ORDER_FILE_VERSION;
+        header.symbol_count = uint32_t(symbols.size());
+        header.record_count = records.size();
+        header.tick_size = tick_size;
+        header.lot_size = lot_size;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+        const char padding[8] = {};
+        for (size_t s = 0; ok && s < symbols.size(); ++s) {
+            const std::string& name = symbols[s];
+            uint32_t length[2] = {uint32_t(name.size()), 0};
+            ok = std::fwrite(length, sizeof(length), 1, file) == 1 &&
+                 std::fwrite(name.data(), 1, name.size(), file) == name.size() &&
+                 std::fwrite(padding, 1, padded(name.size()) - name.size(), file) == padded(name.size()) - name.size();
+        }
+        ok = ok && std::fwrite(records.data(), sizeof(OrderFileRecord), records.size(), file) == records.size();
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok) {
+            std::remove(out_path.c_str());
+        }
+        return ok;
+    }
+
+    OrderFile::OrderFile(const std::string& path) : file_(path) {
+        if (!file_.is_open() || file_.size() < sizeof(OrderFileHeader)) {
+            return;
+        }
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, ORDER_FILE_MAGIC, sizeof(header_.magic)) != 0 ||
+            header_.version != ORDER_FILE_VERSION) {
+            return;
+        }
+
+        size_t offset = sizeof(header_);
+        for (uint32_t s = 0; s < header_.symbol_count; ++s) {
+            uint32_t length;
+            if (file_.size() - offset < 8) {
+                return;
+            }
+            std::memcpy(&length, file_.data() + offset, sizeof(length));
+            offset += 8;
+            if (file_.size() - offset < padded(length)) {
+                return;
+            }
+            symbols_.emplace_back(file_.data() + offset, length);
+            offset += padded(length);
+        }
+        if ((file_.size() - offset) / sizeof(OrderFileRecord) < header_.record_count) {
+            return;
+        }
+        records_ = reinterpret_cast<const OrderFileRecord*>(file_.data() + offset);
+        valid_ = true;
+    }
+
+} // namespace order_matching
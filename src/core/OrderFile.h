@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Instrument.h"
+#include "Order.h"
+#include "../utils/MappedFile.h"
+
+namespace order_matching {
+
+    // One order of a recorded order flow, prices and quantities already in
+    // ticks and lots. symbol indexes the file's symbol table
+    struct OrderFileRecord {
+        uint64_t timestamp_us;          // as recorded
+        uint64_t order_id;
+        Price price;                    // in ticks
+        Quantity quantity;              // in lots
+        uint32_t symbol;
+        uint8_t side;                   // Side
+        uint8_t reserved[3];
+    };
+
+    static_assert(std::is_trivially_copyable<OrderFileRecord>::value, "order records are mapped straight from disk");
+    static_assert(sizeof(OrderFileRecord) == 40, "the on-disk record layout is fixed");
+
+    // File layout: OrderFileHeader, then per symbol its name length (uint32,
+    // padded to 8 bytes) and name padded to 8 bytes, then record_count
+    // OrderFileRecords. Records start 8-byte aligned, so a mapped file is
+    // used in place
+    struct OrderFileHeader {
+        char magic[8];                  // "OMEORDR\0"
+        uint32_t version;
+        uint32_t symbol_count;
+        uint64_t record_count;
+        double tick_size;               // of every symbol in the file
+        double lot_size;
+    };
+
+    // Parses a CSV with the columns written by data/synthetic_generator.py
+    // and data/binance_downloader.py (order_id, timestamp, symbol, side,
+    // price, quantity, in any order) into the binary format above, snapping
+    // prices and quantities to tick_size and lot_size. Rows that do not
+    // parse, overflow their field or round to a non-positive price or
+    // quantity, are skipped and counted in skipped. False if either file
+    // cannot be opened, the CSV is empty or its header lacks a column
+    bool convert_order_csv(const std::string& csv_path, const std::string& out_path, double tick_size = 0.01,
+                           double lot_size = 1.0, size_t* skipped = nullptr);
+
+    // Read-only view of a converted order file, mapped in place
+    class OrderFile {
+    private:
+        utils::MappedFile file_;
+        OrderFileHeader header_ = {};
+        std::vector<std::string> symbols_;
+        const OrderFileRecord* records_ = nullptr;
+        bool valid_ = false;
+
+    public:
+        explicit OrderFile(const std::string& path);
+
+        OrderFile(const OrderFile&) = delete;
+        OrderFile& operator=(const OrderFile&) = delete;
+
+        // false if the file is missing, truncated or not an order file
+        bool is_open() const { return valid_; }
+
+        const std::vector<std::string>& symbols() const { return symbols_; }
+        const OrderFileRecord* records() const { return records_; }
+        size_t size() const { return valid_ ? size_t(header_.record_count) : 0; }
+        double tick_size() const { return header_.tick_size; }
+        double lot_size() const { return header_.lot_size; }
+    };
+
+} // namespace order_matching
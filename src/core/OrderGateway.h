@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "Execution.h"
+#include "MatchingEngine.h"
+#include "OrderMessage.h"
+#include "../utils/MpscQueue.h"
+#include "../utils/SpscQueue.h"
+#include "../utils/WaitStrategy.h"
+
+namespace order_matching {
+
+//
+// Ingress for a MatchingEngine: producers hand fixed-size OrderCommands to a
+// lock-free ring and return at once; one matching thread drains the ring in
+// batches and applies each command to the engine in arrival order (orders,
+// and amends that cross, match on arrival). Queue picks the producer side -
+// SpscQueue for a single feed handler, MpscQueue for several client
+// sessions - and Wait what a thread does while the ring is empty (matching
+// thread) or full (producer).
+//
+// The engine belongs to the matching thread once start() has been called:
+// books are created before, and read again only after stop().
+template <typename Queue, typename Wait = utils::BusySpinWait>
+class OrderGateway {
+public:
+    // Both are called on the matching thread: every fill, and every command
+    // once it has been applied
+    typedef std::function<void(const Execution&)> ExecutionHandler;
+    typedef std::function<void(const OrderCommand&)> CommandHandler;
+
+    // commands taken off the ring per pass
+    static constexpr size_t BATCH_SIZE = 64;
+
+    explicit OrderGateway(MatchingEngine& engine, size_t capacity = 65536)
+        : engine_(engine), queue_(capacity) {}
+
+    ~OrderGateway() { stop(); }
+
+    OrderGateway(const OrderGateway&) = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    // Must be set before start()
+    void set_execution_handler(ExecutionHandler handler) { execution_handler_ = std::move(handler); }
+    void set_command_handler(CommandHandler handler) { command_handler_ = std::move(handler); }
+
+    // Runs the matching loop on its own thread until stop()
+    void start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        stopping_.store(false);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    // Applies everything already queued, then joins
+    void stop() {
+        if (!running_.load()) {
+            return;
+        }
+        stopping_.store(true, std::memory_order_release);
+        thread_.join();
+        running_.store(false);
+    }
+
+    // Producer side. Commands may be queued before start(); once the ring is
+    // full these wait for the matching thread to make room. Whether several
+    // threads may call them at once depends on Queue
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity,
+                      OrderType type = LIMIT) {
+        return send(OrderCommand{CommandType::ADD, type, OrderMessage{symbol_id, side, id, price, quantity}});
+    }
+
+    bool cancel_order(SymbolId symbol_id, Order::OrderId order_id) {
+        return send(OrderCommand{CommandType::CANCEL, LIMIT, OrderMessage{symbol_id, BUY, order_id, 0, 0}});
+    }
+
+    bool modify_order(SymbolId symbol_id, Order::OrderId order_id, Price price, Quantity quantity) {
+        return send(OrderCommand{CommandType::MODIFY, LIMIT, OrderMessage{symbol_id, BUY, order_id, price, quantity}});
+    }
+
+    bool send(const OrderCommand& command) {
+        Wait wait;
+        while (!queue_.try_push(command)) {
+            wait.wait();
+        }
+        return true;
+    }
+
+    // false instead of waiting when the ring is full
+    bool try_send(const OrderCommand& command) { return queue_.try_push(command); }
+
+    // Matching side, for callers that drive the engine from a thread of
+    // their own instead of start(): applies one batch, returns its size
+    size_t poll() {
+        OrderCommand batch[BATCH_SIZE];
+        size_t n = queue_.pop_batch(batch, BATCH_SIZE);
+        for (size_t i = 0; i < n; ++i) {
+            apply(batch[i]);
+        }
+        if (n > 0) {
+            processed_.fetch_add(n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Commands applied so far
+    size_t get_commands_processed() const { return processed_.load(std::memory_order_acquire); }
+
+private:
+    MatchingEngine& engine_;
+    Queue queue_;
+    ExecutionRing executions_;
+    ExecutionHandler execution_handler_;
+    CommandHandler command_handler_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+
+    alignas(utils::CACHE_LINE) std::atomic<size_t> processed_{0};
+
+    // exits once stop was requested and the ring is empty
+    void run() {
+        Wait wait;
+        while (true) {
+            if (poll() > 0) {
+                wait.reset();
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire) && queue_.empty()) {
+                break;
+            }
+            wait.wait();
+        }
+    }
+
+    void apply(const OrderCommand& command) {
+        const OrderMessage& order = command.order;
+        switch (command.type) {
+        case CommandType::ADD:
+            engine_.submit_order(order.symbol_id, order.order_id, order.side, order.price, order.quantity,
+                                 command.order_type, executions_);
+            break;
+        case CommandType::CANCEL:
+            engine_.cancel_order(order.symbol_id, order.order_id);
+            break;
+        case CommandType::MODIFY:
+            engine_.modify_order(order.symbol_id, order.order_id, order.price, order.quantity, executions_);
+            break;
+        }
+
+        if (!executions_.empty()) {
+            if (execution_handler_) {
+                executions_.drain(execution_handler_);
+            } else {
+                executions_.clear();
+            }
+        }
+        if (command_handler_) {
+            command_handler_(command);
+        }
+    }
+};
+
+// One feed handler thread producing
+template <typename Wait = utils::BusySpinWait>
+using SpscOrderGateway = OrderGateway<utils::SpscQueue<OrderCommand>, Wait>;
+
+// Any number of client session threads producing
+template <typename Wait = utils::BusySpinWait>
+using MpscOrderGateway = OrderGateway<utils::MpscQueue<OrderCommand>, Wait>;
+
+} // namespace order_matching
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Instrument.h"
+#include "Order.h"
+
+namespace order_matching {
+
+    // Order entry as it arrives off the wire, before the book owns an Order.
+    // Plain data so batches can sit in contiguous arrays
+    struct OrderMessage {
+        SymbolId symbol_id;
+        Side side;
+        Order::OrderId order_id;
+        Price price;        // in ticks
+        Quantity quantity;  // in lots
+    };
+
+    struct CancelMessage {
+        SymbolId symbol_id;
+        Order::OrderId order_id;
+    };
+
+    // One fixed-size command for the queues between threads. CANCEL only
+    // reads symbol_id and order_id; MODIFY takes the new price and quantity
+    enum class CommandType : uint8_t { ADD, CANCEL, MODIFY };
+
+    struct OrderCommand {
+        CommandType type;
+        OrderType order_type;   // ADD only
+        OrderMessage order;
+    };
+
+} // namespace order_matching
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Order.h"
+
+namespace order_matching {
+
+    // All resting orders at one price, in time priority. Orders are chained
+    // through their own prev/next hooks (intrusive list), so an order can be
+    // unlinked from anywhere in the queue in O(1) given just the Order*.
+    // Running totals are kept on every add, removal and fill so depth
+    // queries never have to visit individual orders.
+    struct PriceLevel {
+        Price price;
+        Order* head;
+        Order* tail;
+        Quantity total_quantity;    // Sum of remaining quantity of the queue
+        size_t order_count;
+
+        explicit PriceLevel(Price p = 0)
+            : price(p), head(nullptr), tail(nullptr), total_quantity(0), order_count(0) {}
+
+        // levels are referenced by address from their orders
+        PriceLevel(const PriceLevel&) = delete;
+        PriceLevel& operator=(const PriceLevel&) = delete;
+
+        bool empty() const { return head == nullptr; }
+        Order* front() const { return head; }
+
+        void push_back(Order* order) {
+            order->level = this;
+            order->prev_in_level = tail;
+            order->next_in_level = nullptr;
+            if (tail) {
+                tail->next_in_level = order;
+            } else {
+                head = order;
+            }
+            tail = order;
+            total_quantity += order->remaining_quantity;
+            ++order_count;
+        }
+
+        void erase(Order* order) {
+            if (order->prev_in_level) {
+                order->prev_in_level->next_in_level = order->next_in_level;
+            } else {
+                head = order->next_in_level;
+            }
+            if (order->next_in_level) {
+                order->next_in_level->prev_in_level = order->prev_in_level;
+            } else {
+                tail = order->prev_in_level;
+            }
+            order->prev_in_level = nullptr;
+            order->next_in_level = nullptr;
+            order->level = nullptr;
+            total_quantity -= order->remaining_quantity;
+            --order_count;
+        }
+
+        // an order in this queue traded qty (call alongside set_remaining_quantity)
+        void reduce_quantity(Quantity qty) {
+            total_quantity -= qty;
+        }
+
+        void pop_front() {
+            erase(head);
+        }
+
+        // moves other's whole queue here (used when levels are relocated)
+        void take_from(PriceLevel& other) {
+            price = other.price;
+            head = other.head;
+            tail = other.tail;
+            total_quantity = other.total_quantity;
+            order_count = other.order_count;
+            for (Order* order = head; order; order = order->next_in_level) {
+                order->level = this;
+            }
+            other.head = nullptr;
+            other.tail = nullptr;
+            other.total_quantity = 0;
+            other.order_count = 0;
+        }
+    };
+
+} // namespace order_matching
@@ -0,0 +1,384 @@
+#include "PushServer.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace order_matching {
+
+namespace {
+
+// requests are a GET line and a few headers; anything longer is dropped
+const size_t MAX_REQUEST_BYTES = 8192;
+
+#ifdef _WIN32
+typedef SOCKET socket_t;
+typedef WSAPOLLFD poll_entry;
+// no pipe to wake WSAPoll with, so the loop looks for new frames this often
+const int POLL_TIMEOUT_MS = 10;
+
+void close_socket(socket_t s) { closesocket(s); }
+bool would_block() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+int poll_sockets(poll_entry* entries, size_t count, int timeout) { return WSAPoll(entries, ULONG(count), timeout); }
+
+void set_nonblocking(socket_t s) {
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+}
+#else
+typedef int socket_t;
+typedef pollfd poll_entry;
+// woken through the pipe; the timeout only bounds how long stop() waits
+const int POLL_TIMEOUT_MS = 500;
+
+void close_socket(socket_t s) { ::close(s); }
+bool would_block() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+int poll_sockets(poll_entry* entries, size_t count, int timeout) { return ::poll(entries, nfds_t(count), timeout); }
+
+void set_nonblocking(socket_t s) {
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+}
+#endif
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;    // a closed browser is not a SIGPIPE
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+poll_entry poll_for(intptr_t s, short events) {
+    poll_entry entry;
+    entry.fd = socket_t(s);
+    entry.events = events;
+    entry.revents = 0;
+    return entry;
+}
+
+std::string response(const char* status, const char* content_type, const std::string& body) {
+    std::ostringstream out;
+    out << "HTTP/1.1 " << status << "\r\n"
+        << "Content-Type: " << content_type << "\r\n"
+        << "Content-Length: " << body.size() << "\r\n"
+        << "Cache-Control: no-cache\r\n"
+        << "Connection: close\r\n\r\n"
+        << body;
+    return out.str();
+}
+
+} // namespace
+
+struct PushServer::Client {
+    intptr_t socket;
+    std::string request;        // read until the blank line ending the headers
+    std::string out;            // bytes still to send
+    size_t sent = 0;
+    uint64_t version = 0;       // frame last queued, 0 for none yet
+    bool streaming = false;     // subscribed to /events
+    bool closing = false;       // a plain response: close once it is sent
+    bool dropped = false;
+
+    explicit Client(intptr_t s) : socket(s) {}
+};
+
+PushServer::PushServer(uint16_t port, std::string page_path, size_t max_clients)
+    : port_(port), page_path_(std::move(page_path)), max_clients_(max_clients) {}
+
+PushServer::~PushServer() {
+    stop();
+}
+
+bool PushServer::start() {
+    if (is_running()) {
+        return true;
+    }
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return false;
+    }
+#endif
+    socket_t s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (intptr_t(s) == -1) {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(addr);
+    if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s, 16) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        close_socket(s);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    set_nonblocking(s);
+    listener_ = intptr_t(s);
+    port_ = ntohs(addr.sin_port);
+
+#ifndef _WIN32
+    int wake[2];
+    if (pipe(wake) == 0) {
+        wake_read_ = wake[0];
+        wake_write_ = wake[1];
+        set_nonblocking(wake_read_);
+        set_nonblocking(wake_write_);
+    }
+#endif
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&PushServer::run, this);
+    return true;
+}
+
+void PushServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+#ifndef _WIN32
+    if (wake_write_ >= 0) {
+        ssize_t ignored = ::write(wake_write_, "x", 1);
+        (void)ignored;
+    }
+#endif
+    thread_.join();
+    close_all();
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (wake_read_ >= 0) {
+        ::close(wake_read_);
+        ::close(wake_write_);
+        wake_read_ = wake_write_ = -1;
+    }
+#endif
+}
+
+// Event-stream framing: every line of the frame becomes a data: line and a
+// blank line ends the event, so a frame with newlines arrives whole
+void PushServer::publish(const std::string& frame) {
+    std::string event;
+    event.reserve(frame.size() + 16);
+    size_t start = 0;
+    while (start <= frame.size()) {
+        size_t end = frame.find('\n', start);
+        if (end == std::string::npos) {
+            end = frame.size();
+        }
+        if (end > start || end < frame.size()) {
+            event.append("data: ").append(frame, start, end - start).append("\n");
+        }
+        start = end + 1;
+    }
+    event.append("\n");
+
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex_);
+        frame_.swap(event);
+        ++frame_version_;
+    }
+    frames_published_.fetch_add(1, std::memory_order_relaxed);
+#ifndef _WIN32
+    if (wake_write_ >= 0) {
+        ssize_t ignored = ::write(wake_write_, "x", 1);   // a full pipe already means "wake up"
+        (void)ignored;
+    }
+#endif
+}
+
+void PushServer::run() {
+    std::vector<poll_entry> entries;
+    std::string frame;
+    uint64_t frame_version = 0;
+    char buffer[4096];
+
+    while (running_.load(std::memory_order_acquire)) {
+        // readable to take requests and notice closed browsers; writable
+        // only while something is waiting to go out
+        entries.clear();
+        entries.push_back(poll_for(listener_, POLLIN));
+        size_t first_client = 1;
+        if (wake_read_ >= 0) {
+            entries.push_back(poll_for(wake_read_, POLLIN));
+            first_client = 2;
+        }
+        for (const auto& client : clients_) {
+            entries.push_back(poll_for(client->socket, short(client->out.empty() ? POLLIN : POLLIN | POLLOUT)));
+        }
+        if (poll_sockets(entries.data(), entries.size(), POLL_TIMEOUT_MS) < 0 && !would_block()) {
+            break;
+        }
+        if (wake_read_ >= 0 && (entries[1].revents & POLLIN)) {
+#ifndef _WIN32
+            while (::read(wake_read_, buffer, sizeof(buffer)) > 0) {
+            }
+#endif
+        }
+
+        size_t polled = clients_.size();
+        for (size_t i = 0; i < polled; ++i) {
+            Client& client = *clients_[i];
+            short revents = entries[first_client + i].revents;
+            if (revents & (POLLERR | POLLNVAL)) {
+                client.dropped = true;
+                continue;
+            }
+            if (revents & (POLLIN | POLLHUP)) {
+                int n = int(::recv(socket_t(client.socket), buffer, sizeof(buffer), 0));
+                if (n == 0 || (n < 0 && !would_block())) {
+                    client.dropped = true;
+                } else if (n > 0 && !client.streaming && !client.closing) {
+                    client.request.append(buffer, size_t(n));
+                    if (client.request.find("\r\n\r\n") != std::string::npos) {
+                        handle_request(client);
+                    } else if (client.request.size() > MAX_REQUEST_BYTES) {
+                        client.dropped = true;
+                    }
+                }
+            }
+        }
+        if (entries[0].revents & POLLIN) {
+            accept_clients();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            if (frame_version_ != frame_version) {
+                frame = frame_;
+                frame_version = frame_version_;
+            }
+        }
+
+        size_t streams = 0;
+        for (const auto& c : clients_) {
+            Client& client = *c;
+            if (client.dropped) {
+                continue;
+            }
+            // a stream takes the newest frame only once the last one is out
+            if (client.streaming && client.out.empty() && client.version != frame_version && frame_version != 0) {
+                if (client.version != 0) {
+                    frames_conflated_.fetch_add(frame_version - client.version - 1, std::memory_order_relaxed);
+                }
+                client.out = frame;
+                client.sent = 0;
+                client.version = frame_version;
+                frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            }
+            while (client.sent < client.out.size()) {
+                int n = int(::send(socket_t(client.socket), client.out.data() + client.sent,
+                                   int(client.out.size() - client.sent), SEND_FLAGS));
+                if (n < 0) {
+                    client.dropped = !would_block();
+                    break;
+                }
+                client.sent += size_t(n);
+            }
+            if (client.sent == client.out.size()) {
+                client.out.clear();
+                client.sent = 0;
+                client.dropped = client.dropped || client.closing;
+            }
+            streams += client.streaming && !client.dropped;
+        }
+
+        for (size_t i = 0; i < clients_.size();) {
+            if (clients_[i]->dropped) {
+                close_socket(socket_t(clients_[i]->socket));
+                clients_[i] = std::move(clients_.back());
+                clients_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        client_count_.store(streams, std::memory_order_relaxed);
+    }
+}
+
+void PushServer::accept_clients() {
+    while (true) {
+        socket_t s = ::accept(socket_t(listener_), nullptr, nullptr);
+        if (intptr_t(s) == -1) {
+            return;
+        }
+        if (clients_.size() >= max_clients_) {
+            close_socket(s);
+            continue;
+        }
+        set_nonblocking(s);
+        int on = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+#ifdef SO_NOSIGPIPE
+        setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        clients_.push_back(std::make_unique<Client>(intptr_t(s)));
+    }
+}
+
+// GET /events subscribes; GET / serves the page, read fresh each time so it
+// can be edited while the engine runs
+void PushServer::handle_request(Client& client) {
+    std::istringstream line(client.request.substr(0, client.request.find("\r\n")));
+    std::string method, target;
+    line >> method >> target;
+    target = target.substr(0, target.find('?'));
+    client.request.clear();
+
+    if (method != "GET") {
+        client.out = response("405 Method Not Allowed", "text/plain", "GET only\n");
+        client.closing = true;
+    } else if (target == "/events") {
+        client.out = "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/event-stream\r\n"
+                     "Cache-Control: no-cache\r\n"
+                     "Connection: keep-alive\r\n\r\n"
+                     "retry: 1000\n\n";
+        client.streaming = true;
+    } else if (target == "/" || target == "/index.html") {
+        std::ifstream file(page_path_, std::ios::binary);
+        std::ostringstream page;
+        page << file.rdbuf();
+        client.out = file ? response("200 OK", "text/html; charset=utf-8", page.str())
+                          : response("404 Not Found", "text/plain", "page not found: " + page_path_ + "\n");
+        client.closing = true;
+    } else {
+        client.out = response("404 Not Found", "text/plain", "not found\n");
+        client.closing = true;
+    }
+}
+
+void PushServer::close_all() {
+    for (const auto& client : clients_) {
+        close_socket(socket_t(client->socket));
+    }
+    clients_.clear();
+    client_count_.store(0, std::memory_order_relaxed);
+    if (listener_ != -1) {
+        close_socket(socket_t(listener_));
+        listener_ = -1;
+    }
+}
+
+} // namespace order_matching
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace order_matching {
+
+    //
+    // Small HTTP server on loopback that pushes the latest state of the books
+    // to browsers as Server-Sent Events: the page at /, the event stream at
+    // /events. All socket work happens on the server's own thread;
+    // publish() only swaps in the newest frame and wakes it.
+    //
+    // A client has at most one frame in flight. Frames published while it is
+    // still taking the previous one are conflated to the newest, so a slow
+    // browser sees fewer frames, never stale ones, and holds no backlog.
+    class PushServer {
+    public:
+        // port 0 takes any free port (see get_port)
+        explicit PushServer(uint16_t port = 8080, std::string page_path = "visualization/index.html",
+                            size_t max_clients = 32);
+
+        // stops the server
+        ~PushServer();
+
+        PushServer(const PushServer&) = delete;
+        PushServer& operator=(const PushServer&) = delete;
+
+        // Binds 127.0.0.1:port and starts the server thread. False if the
+        // port could not be bound
+        bool start();
+
+        // Closes every connection and joins the server thread
+        void stop();
+
+        // The frame sent to every stream from now on, as one event; it may
+        // span lines. Safe from any thread
+        void publish(const std::string& frame);
+
+        bool is_running() const { return running_.load(std::memory_order_acquire); }
+        uint16_t get_port() const { return port_; }
+        size_t get_client_count() const { return client_count_.load(std::memory_order_relaxed); }
+
+        uint64_t get_frames_published() const { return frames_published_.load(std::memory_order_relaxed); }
+        uint64_t get_frames_sent() const { return frames_sent_.load(std::memory_order_relaxed); }
+        // frames a stream skipped because it was still busy with an earlier one
+        uint64_t get_frames_conflated() const { return frames_conflated_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Client;
+
+        uint16_t port_;
+        std::string page_path_;
+        size_t max_clients_;
+
+        // sockets are stored as intptr_t so the header stays free of
+        // platform headers; -1 is none
+        intptr_t listener_ = -1;
+        int wake_read_ = -1;
+        int wake_write_ = -1;
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+
+        // the newest frame, already in event-stream form, and its number
+        std::mutex frame_mutex_;
+        std::string frame_;
+        uint64_t frame_version_ = 0;
+
+        // owned by the server thread
+        std::vector<std::unique_ptr<Client>> clients_;
+
+        std::atomic<size_t> client_count_{0};
+        std::atomic<uint64_t> frames_published_{0};
+        std::atomic<uint64_t> frames_sent_{0};
+        std::atomic<uint64_t> frames_conflated_{0};
+
+        void run();
+        void accept_clients();
+        void handle_request(Client& client);
+        void close_all();
+    };
+
+} // namespace order_matching
@@ -0,0 +1,209 @@
+#include "ShardedMatchingEngine.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace order_matching {
+
+namespace {
+
+// pins the calling thread to one core; best effort, a failure just leaves
+// it to the scheduler
+void pin_to_core(size_t core) {
+#ifdef __linux__
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+} // namespace
+
+ShardedMatchingEngine::ShardedMatchingEngine(size_t workers, bool pin_threads, size_t queue_capacity)
+    : pin_threads_(pin_threads) {
+    workers = std::max<size_t>(workers, 1);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>(queue_capacity));
+    }
+}
+
+ShardedMatchingEngine::~ShardedMatchingEngine() {
+    stop();
+}
+
+SymbolId ShardedMatchingEngine::create_order_book(const std::string& symbol, std::unique_ptr<OrderBook> book) {
+    if (running_.load()) {
+        return INVALID_SYMBOL;
+    }
+    SymbolId id = symbols_.intern(symbol);
+    if (id >= shard_of_.size()) {
+        shard_of_.resize(id + 1);
+        for (auto& worker : workers_) {
+            worker->books.resize(id + 1);
+        }
+        shard_of_[id] = id % workers_.size();
+    }
+
+    book->set_symbol_id(id);
+    workers_[shard_of_[id]]->books[id] = std::move(book);
+    return id;
+}
+
+SymbolId ShardedMatchingEngine::create_order_book(const Instrument& instrument, OrderBookType type) {
+    return create_order_book(instrument.symbol, make_order_book(type, instrument));
+}
+
+OrderBook* ShardedMatchingEngine::get_order_book(SymbolId symbol_id) const {
+    if (symbol_id >= shard_of_.size()) {
+        return nullptr;
+    }
+    return workers_[shard_of_[symbol_id]]->books[symbol_id].get();
+}
+
+void ShardedMatchingEngine::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    stopping_.store(false);
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread(&ShardedMatchingEngine::run_worker, this, i);
+    }
+}
+
+void ShardedMatchingEngine::stop() {
+    if (!running_.load()) {
+        return;
+    }
+    stopping_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+    running_.store(false);
+}
+
+bool ShardedMatchingEngine::submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price,
+                                         Quantity quantity, OrderType type) {
+    return enqueue(OrderCommand{CommandType::ADD, type, OrderMessage{symbol_id, side, id, price, quantity}});
+}
+
+bool ShardedMatchingEngine::cancel_order(SymbolId symbol_id, Order::OrderId order_id) {
+    return enqueue(OrderCommand{CommandType::CANCEL, LIMIT, OrderMessage{symbol_id, BUY, order_id, 0, 0}});
+}
+
+bool ShardedMatchingEngine::modify_order(SymbolId symbol_id, Order::OrderId order_id, Price price,
+                                         Quantity quantity) {
+    return enqueue(OrderCommand{CommandType::MODIFY, LIMIT, OrderMessage{symbol_id, BUY, order_id, price, quantity}});
+}
+
+bool ShardedMatchingEngine::enqueue(const OrderCommand& command) {
+    SymbolId symbol_id = command.order.symbol_id;
+    if (!running_.load(std::memory_order_relaxed) || symbol_id >= shard_of_.size()) {
+        return false;
+    }
+    Worker& worker = *workers_[shard_of_[symbol_id]];
+    if (!worker.books[symbol_id]) {
+        return false;
+    }
+    // backpressure: a full queue means the worker is behind, wait for it
+    // without holding the core it may need
+    utils::BackoffWait wait;
+    while (!worker.queue.try_push(command)) {
+        wait.wait();
+    }
+    ++worker.submitted;
+    return true;
+}
+
+void ShardedMatchingEngine::flush() {
+    for (auto& worker : workers_) {
+        while (worker->processed.load(std::memory_order_acquire) < worker->submitted) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t ShardedMatchingEngine::get_commands_processed() const {
+    size_t total = 0;
+    for (const auto& worker : workers_) {
+        total += worker->processed.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+size_t ShardedMatchingEngine::get_execution_count() const {
+    size_t total = 0;
+    for (const auto& worker : workers_) {
+        total += worker->execution_count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+// Worker loop: drain the queue in batches, apply each command to its book,
+// publish progress once per batch. A pinned worker owns its core and spins
+// while idle; an unpinned one backs off so it does not starve the threads
+// sharing its core. Exits once stop was requested and the queue is empty
+void ShardedMatchingEngine::run_worker(size_t index) {
+    if (pin_threads_) {
+        pin_to_core(index);
+    }
+    Worker& worker = *workers_[index];
+    OrderCommand batch[64];
+    utils::BackoffWait idle;
+
+    while (true) {
+        size_t n = worker.queue.pop_batch(batch, 64);
+        if (n == 0) {
+            if (stopping_.load(std::memory_order_acquire) && worker.queue.empty()) {
+                break;
+            }
+            if (pin_threads_) {
+                utils::cpu_relax();
+            } else {
+                idle.wait();
+            }
+            continue;
+        }
+        idle.reset();
+        for (size_t i = 0; i < n; ++i) {
+            apply(worker, batch[i]);
+        }
+        worker.processed.fetch_add(n, std::memory_order_release);
+    }
+}
+
+void ShardedMatchingEngine::apply(Worker& worker, const OrderCommand& command) {
+    const OrderMessage& order = command.order;
+    OrderBook& book = *worker.books[order.symbol_id];
+
+    switch (command.type) {
+    case CommandType::ADD:
+        book.add_order(order.order_id, order.side, order.price, order.quantity, command.order_type,
+                       worker.executions);
+        break;
+    case CommandType::CANCEL:
+        book.cancel_order(order.order_id);
+        break;
+    case CommandType::MODIFY:
+        book.modify_order(order.order_id, order.price, order.quantity, worker.executions);
+        break;
+    }
+
+    if (!worker.executions.empty()) {
+        worker.execution_count.fetch_add(worker.executions.size(), std::memory_order_relaxed);
+        if (handler_) {
+            worker.executions.drain(handler_);
+        } else {
+            worker.executions.clear();
+        }
+    }
+}
+
+} // namespace order_matching
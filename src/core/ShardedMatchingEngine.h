@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Execution.h"
+#include "OrderBook.h"
+#include "OrderMessage.h"
+#include "SymbolRegistry.h"
+#include "../utils/SpscQueue.h"
+#include "../utils/WaitStrategy.h"
+
+namespace order_matching {
+
+//
+// Multi-threaded engine: books are sharded across worker threads, one
+// thread per shard, optionally pinned to a core. A worker owns its books
+// outright - nothing else touches them while it runs, so books need no
+// locks. Commands reach a worker through its own lock-free SPSC queue; a
+// symbol always maps to the same worker and queue, so per-symbol order is
+// preserved. Orders match on arrival (continuous mode). Pinned workers
+// spin while idle; unpinned ones back off (utils::BackoffWait).
+//
+// Threading contract: books are created before start(); submit_order,
+// cancel_order, modify_order and flush are called from one producer thread.
+// get_order_book is only safe once flush() has returned or after stop().
+class ShardedMatchingEngine {
+public:
+    // Called on the worker thread for each fill
+    typedef std::function<void(const Execution&)> ExecutionHandler;
+
+    explicit ShardedMatchingEngine(size_t workers, bool pin_threads = true, size_t queue_capacity = 65536);
+    ~ShardedMatchingEngine();
+
+    ShardedMatchingEngine(const ShardedMatchingEngine&) = delete;
+    ShardedMatchingEngine& operator=(const ShardedMatchingEngine&) = delete;
+
+    // Books are dealt to workers round-robin in creation order
+    SymbolId create_order_book(const std::string& symbol, std::unique_ptr<OrderBook> book);
+    SymbolId create_order_book(const Instrument& instrument, OrderBookType type = OrderBookType::BTREE);
+
+    // Must be set before start()
+    void set_execution_handler(ExecutionHandler handler) { handler_ = std::move(handler); }
+
+    void start();
+    void stop();    // processes everything already queued, then joins
+
+    // Enqueue for the symbol's worker, backing off while its queue is full.
+    // False if the engine is not running or has no book for the symbol. An
+    // amend that crosses the spread matches on arrival, like an add
+    bool submit_order(SymbolId symbol_id, Order::OrderId id, Side side, Price price, Quantity quantity,
+                      OrderType type = LIMIT);
+    bool cancel_order(SymbolId symbol_id, Order::OrderId order_id);
+    bool modify_order(SymbolId symbol_id, Order::OrderId order_id, Price price, Quantity quantity);
+
+    // Blocks until every worker has applied all commands submitted so far
+    void flush();
+
+    SymbolId get_symbol_id(const std::string& symbol) const { return symbols_.find(symbol); }
+    OrderBook* get_order_book(SymbolId symbol_id) const;
+
+    size_t get_worker_count() const { return workers_.size(); }
+    size_t get_worker_of(SymbolId symbol_id) const { return shard_of_[symbol_id]; }
+
+    // Totals over all workers; exact after flush()
+    size_t get_commands_processed() const;
+    size_t get_execution_count() const;
+
+private:
+    // Everything a worker touches is on its own cache lines: the queue's
+    // indices are padded inside SpscQueue, the counters here
+    struct alignas(utils::CACHE_LINE) Worker {
+        explicit Worker(size_t queue_capacity) : queue(queue_capacity) {}
+
+        utils::SpscQueue<OrderCommand> queue;
+
+        // this shard's books by SymbolId, null for other shards' symbols
+        std::vector<std::unique_ptr<OrderBook>> books;
+        ExecutionRing executions;
+        std::thread thread;
+
+        alignas(utils::CACHE_LINE) std::atomic<size_t> processed{0};
+        std::atomic<size_t> execution_count{0};
+
+        alignas(utils::CACHE_LINE) size_t submitted = 0;   // producer side
+    };
+
+    SymbolRegistry symbols_;
+    std::vector<size_t> shard_of_;          // worker index by SymbolId
+    std::vector<std::unique_ptr<Worker>> workers_;
+    ExecutionHandler handler_;
+    bool pin_threads_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+
+    bool enqueue(const OrderCommand& command);
+    void run_worker(size_t index);
+    void apply(Worker& worker, const OrderCommand& command);
+};
+
+} // namespace order_matching
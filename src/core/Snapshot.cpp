@@ -0,0 +1,142 @@
+#include "Snapshot.h"
+#include "MatchingEngine.h"
+#include "../utils/MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace order_matching {
+
+    namespace {
+
+        const char SNAPSHOT_MAGIC[8] = {'O', 'M', 'E', 'S', 'N', 'A', 'P', '\0'};
+        const uint32_t SNAPSHOT_VERSION = 1;
+
+        size_t padded(size_t bytes) {
+            return (bytes + 7) & ~size_t(7);
+        }
+
+    } // namespace
+
+    bool write_snapshot(const std::string& path, MatchingEngine& engine) {
+        std::string temp = path + ".tmp";
+        std::FILE* file = std::fopen(temp.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        SnapshotHeader header = {};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        for (SymbolId id = 0; id < engine.get_symbol_count(); ++id) {
+            header.book_count += engine.get_order_book(id) != nullptr;
+        }
+        header.journal_sequence = engine.get_journal() ? engine.get_journal()->get_records_appended() : 0;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+        std::vector<SnapshotOrder> orders;
+        const char padding[8] = {};
+        for (SymbolId id = 0; ok && id < engine.get_symbol_count(); ++id) {
+            OrderBook* book = engine.get_order_book(id);
+            if (!book) {
+                continue;
+            }
+            orders.clear();
+            book->export_orders(orders);
+
+            const std::string& name = engine.get_symbol(id);
+            SnapshotBookHeader book_header = {};
+            book_header.name_length = uint32_t(name.size());
+            book_header.order_count = orders.size();
+            book_header.next_trade_id = book->get_next_trade_id();
+            ok = std::fwrite(&book_header, sizeof(book_header), 1, file) == 1 &&
+                 std::fwrite(name.data(), 1, name.size(), file) == name.size() &&
+                 std::fwrite(padding, 1, padded(name.size()) - name.size(), file) == padded(name.size()) - name.size() &&
+                 std::fwrite(orders.data(), sizeof(SnapshotOrder), orders.size(), file) == orders.size();
+        }
+
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        // rename replaces the old snapshot in one step where the platform
+        // allows it; elsewhere the old one has to go first
+        if (std::rename(temp.c_str(), path.c_str()) != 0) {
+            std::remove(path.c_str());
+            return std::rename(temp.c_str(), path.c_str()) == 0;
+        }
+        return true;
+    }
+
+    // Two passes: every book header, name, target book and order sequence
+    // is checked before any book is touched, so a bad file leaves the
+    // engine as it was rather than half restored. Each book's is_loadable
+    // is the check its load_orders makes, window limits included, so the
+    // second pass only fails if a book changed in between
+    bool restore_snapshot(const std::string& path, MatchingEngine& engine, uint64_t* journal_sequence) {
+        utils::MappedFile file(path);
+        if (!file.is_open() || file.size() < sizeof(SnapshotHeader)) {
+            return false;
+        }
+
+        SnapshotHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SNAPSHOT_VERSION) {
+            return false;
+        }
+
+        struct BookLoad {
+            OrderBook* book;
+            const SnapshotOrder* orders;
+            size_t count;
+            uint64_t next_trade_id;
+        };
+        std::vector<BookLoad> loads;
+        size_t offset = sizeof(header);
+        for (uint32_t b = 0; b < header.book_count; ++b) {
+            SnapshotBookHeader book_header;
+            if (file.size() - offset < sizeof(book_header)) {
+                return false;
+            }
+            std::memcpy(&book_header, file.data() + offset, sizeof(book_header));
+            offset += sizeof(book_header);
+
+            size_t name_bytes = padded(book_header.name_length);
+            if (file.size() - offset < name_bytes ||
+                (file.size() - offset - name_bytes) / sizeof(SnapshotOrder) < book_header.order_count) {
+                return false;
+            }
+            std::string name(file.data() + offset, book_header.name_length);
+            offset += name_bytes;
+
+            // the book must exist, be empty and appear in the file only once
+            OrderBook* book = engine.get_order_book(name);
+            const SnapshotOrder* orders = reinterpret_cast<const SnapshotOrder*>(file.data() + offset);
+            if (!book || !book->is_loadable(orders, book_header.order_count)) {
+                return false;
+            }
+            for (const BookLoad& load : loads) {
+                if (load.book == book) {
+                    return false;
+                }
+            }
+            loads.push_back(BookLoad{book, orders, size_t(book_header.order_count), book_header.next_trade_id});
+            offset += book_header.order_count * sizeof(SnapshotOrder);
+        }
+
+        for (const BookLoad& load : loads) {
+            if (!load.book->load_orders(load.orders, load.count)) {
+                return false;
+            }
+            load.book->set_next_trade_id(load.next_trade_id);
+        }
+        if (journal_sequence) {
+            *journal_sequence = header.journal_sequence;
+        }
+        return true;
+    }
+
+} // namespace order_matching
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "Instrument.h"
+#include "Order.h"
+
+namespace order_matching {
+
+    class MatchingEngine;
+
+    // One resting order in a snapshot. A book exports its orders in
+    // price-time order - bids best price first, then asks best price first,
+    // each level front to back - and a book loads them back in that order
+    struct SnapshotOrder {
+        uint64_t order_id;
+        Price price;                    // in ticks
+        Quantity quantity;              // as entered (or last amended)
+        Quantity remaining_quantity;
+        uint8_t side;                   // Side
+        uint8_t reserved[7];
+    };
+
+    static_assert(std::is_trivially_copyable<SnapshotOrder>::value, "snapshot orders are mapped straight from disk");
+    static_assert(sizeof(SnapshotOrder) == 40, "the on-disk record layout is fixed");
+
+    // File layout: SnapshotHeader, then per book a SnapshotBookHeader, the
+    // symbol name padded to 8 bytes and order_count SnapshotOrders. Every
+    // array starts 8-byte aligned, so a mapped file is used in place
+    struct SnapshotHeader {
+        char magic[8];                  // "OMESNAP\0"
+        uint32_t version;
+        uint32_t book_count;
+        uint64_t journal_sequence;      // journal records already reflected
+    };
+
+    struct SnapshotBookHeader {
+        uint32_t name_length;
+        uint32_t reserved;
+        uint64_t order_count;
+        uint64_t next_trade_id;
+    };
+
+    // Writes every book's resting orders. The file is written beside path
+    // and renamed over it, so a crash never leaves a half snapshot. If the
+    // engine has a journal, the snapshot records how far into it it is
+    bool write_snapshot(const std::string& path, MatchingEngine& engine);
+
+    // Maps the file and bulk-loads each book (OrderBook::load_orders). The
+    // engine needs an empty book under every symbol in the file; false if
+    // one is missing, not empty or cannot hold the saved prices (a price
+    // ladder narrower than the saved range), or the file is not a valid
+    // snapshot, and then no book has been touched. journal_sequence, if given, receives
+    // where journal replay resumes
+    bool restore_snapshot(const std::string& path, MatchingEngine& engine, uint64_t* journal_sequence = nullptr);
+
+} // namespace order_matching
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Instrument.h"
+
+namespace order_matching {
+
+    const SymbolId INVALID_SYMBOL = std::numeric_limits<SymbolId>::max();
+
+    // Interns symbol strings into dense SymbolIds (0, 1, 2, ...) so the
+    // engine can route by array index. Strings are only looked up at the
+    // edges - book creation, display, external order entry.
+    class SymbolRegistry {
+    private:
+        std::vector<std::string> names_;
+        std::unordered_map<std::string, SymbolId> ids_;
+
+    public:
+        // existing id for symbol, or the next free one
+        SymbolId intern(const std::string& symbol) {
+            auto it = ids_.find(symbol);
+            if (it != ids_.end()) {
+                return it->second;
+            }
+            SymbolId id = static_cast<SymbolId>(names_.size());
+            names_.push_back(symbol);
+            ids_.emplace(symbol, id);
+            return id;
+        }
+
+        // INVALID_SYMBOL if the symbol was never interned
+        SymbolId find(const std::string& symbol) const {
+            auto it = ids_.find(symbol);
+            return it != ids_.end() ? it->second : INVALID_SYMBOL;
+        }
+
+        const std::string& name(SymbolId id) const {
+            return names_[id];
+        }
+
+        size_t size() const {
+            return names_.size();
+        }
+    };
+
+} // namespace order_matching
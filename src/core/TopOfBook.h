@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Instrument.h"
+
+namespace order_matching {
+
+    // Best bid and offer of one book as last published by its matching
+    // thread. An empty side reads 0 for price, size and count, like the
+    // book's own queries; last trade is 0 until the book has traded.
+    // sequence counts the book's mutations, so a reader can tell whether
+    // anything changed since its previous snapshot
+    struct TopOfBook {
+        Price bid_price;
+        Quantity bid_size;
+        uint32_t bid_orders;
+        uint32_t ask_orders;
+        Price ask_price;
+        Quantity ask_size;
+        Price last_trade_price;
+        Quantity last_trade_quantity;
+        uint64_t sequence;
+    };
+
+    static_assert(std::is_trivially_copyable<TopOfBook>::value, "top of book is published through a seqlock");
+
+} // namespace order_matching
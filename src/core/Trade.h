@@ -1,8 +1,9 @@
 #pragma once
 
-#include <string>
 #include <chrono>
 
+#include "Instrument.h"
+
 namespace order_matching {
 
     class Trade {
@@ -14,16 +15,16 @@ namespace order_matching {
         TradeId trade_id;
         OrderId buy_order_id;
         OrderId sell_order_id;
-        double price;
-        double quantity;
-        std::string symbol;
+        Price price;        // in ticks
+        Quantity quantity;  // in lots
+        SymbolId symbol_id;
         long timestamp;
 
     public:
         Trade(TradeId id, OrderId buy_id, OrderId sell_id,
-              double p, double qty, const std::string& sym)
+              Price p, Quantity qty, SymbolId sym)
             : trade_id(id), buy_order_id(buy_id), sell_order_id(sell_id),
-              price(p), quantity(qty), symbol(sym) {
+              price(p), quantity(qty), symbol_id(sym) {
             timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
         }
 
@@ -31,9 +32,9 @@ namespace order_matching {
         TradeId get_trade_id() const { return trade_id; }
         OrderId get_buy_order_id() const { return buy_order_id; }
         OrderId get_sell_order_id() const { return sell_order_id; }
-        double get_price() const { return price; }
-        double get_quantity() const { return quantity; }
-        const std::string& get_symbol() const { return symbol; }
+        Price get_price() const { return price; }
+        Quantity get_quantity() const { return quantity; }
+        SymbolId get_symbol_id() const { return symbol_id; }
         long get_timestamp() const { return timestamp; }
     };
 
@@ -1,264 +1,509 @@
 #include "BTreeOrderBook.h"
+#include "../utils/KeySearch.h"
 
 #include <algorithm>
+#include <limits>
 using namespace std;
 namespace order_matching {
 
-BTreeOrderBook::BTreeOrderBook(const std::string& symbol, size_t degree)
-    : degree_(degree),
-      min_keys_(degree - 1),
-      max_keys_(2 * degree - 1),
+template <size_t Degree>
+BTreeOrderBook<Degree>::BTreeOrderBook(const Instrument& instrument)
+    : OrderBook(instrument),
       bid_count_(0),
       ask_count_(0),
+      bid_levels_(0),
+      ask_levels_(0),
       total_orders_(0),
       total_orders_processed_(0),
       total_trades_(0) {
-    symbol_ = symbol;
-
     // Initialize empty B-Tree roots
-    buy_tree_root_ = new BTreeNode();
-    sell_tree_root_ = new BTreeNode();
+    buy_tree_root_ = node_pool_.create(true);
+    sell_tree_root_ = node_pool_.create(true);
+}
+
+template <size_t Degree>
+BTreeOrderBook<Degree>::~BTreeOrderBook() {
+    // levels and nodes are trivially destructible and go with their pools;
+    // resting orders are destroyed properly
+    orders_.for_each([this](Order* order) { order_pool_.destroy(order); });
 }
 
 
-bool BTreeOrderBook::add_order(std::shared_ptr<Order> order) {
-    if (!order || order->get_symbol() != symbol_) {
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::add_order(Order::OrderId id, Side side, Price price, Quantity quantity) {
+    // an id can only rest once
+    if (quantity <= 0 || orders_.find(id) != nullptr) {
         return false;
     }
+    rest_order(id, side, price, quantity);
+    ++total_orders_processed_;
+    publish_top();
+    return true;
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::add_order(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                       OrderType type, ExecutionRing& executions) {
+    return add_order_with(id, side, price, quantity, type,
+                          [&executions](const Execution& execution) { executions.push(execution); });
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::rest_order(Order::OrderId id, Side side, Price price, Quantity quantity) {
+    Order* order = order_pool_.create(id, side, price, quantity, symbol_id_);
 
     // insert into appropriate tree
-    if (order->get_side() == BUY) {
-        insert(buy_tree_root_, order->get_price(), order);
+    if (side == BUY) {
+        bid_levels_ += insert(buy_tree_root_, price, order);
         ++bid_count_;
     } else {
-        insert(sell_tree_root_, order->get_price(), order);
+        ask_levels_ += insert(sell_tree_root_, price, order);
         ++ask_count_;
     }
+    on_level_added(side, order->get_level());
+    level_changed(side, order->get_level());
+    order_event(OrderEventType::ADD, order, price, quantity);
 
-    // track order location for fast cancellation
-    order_location_[order->get_order_id()] = make_pair(order->get_side(), order->get_price());
+    // index the order itself for O(1) cancellation
+    orders_.insert(id, order);
 
     ++total_orders_;
-    ++total_orders_processed_;
-    return true;
 }
 
-bool BTreeOrderBook::cancel_order(Order::OrderId order_id) {
-    auto itr = order_location_.find(order_id);
-    if (itr == order_location_.end()) {
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::cancel_order(Order::OrderId order_id) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr) {
         return false;
     }
 
-    Side side = itr->second.first;
-    double price = itr->second.second;
+    PriceLevel* priceLvl = order->get_level();
 
-    PriceLevel* priceLvl = find_price_level(
-        side == BUY ? buy_tree_root_ : sell_tree_root_, price);
+    // unlink straight from the level, no queue scan
+    priceLvl->erase(order);
+    order->cancel();
 
-    if (!priceLvl) {
-        return false;
+    if (order->get_side() == BUY) {
+        adjust_quantity(buy_tree_root_, priceLvl->price, -order->get_remaining_quantity());
+        --bid_count_;
+    } else {
+        adjust_quantity(sell_tree_root_, priceLvl->price, -order->get_remaining_quantity());
+        --ask_count_;
     }
+    --total_orders_;
+    level_changed(order->get_side(), priceLvl);
+    order_event(OrderEventType::CANCEL, order, priceLvl->price, order->get_remaining_quantity());
 
-    auto& orders = priceLvl->orders;
-    for (auto it = orders.begin(); it != orders.end(); ++it) {
-        if ((*it)->get_order_id() == order_id) {
-            (*it)->cancel();
-            orders.erase(it);
-            order_location_.erase(order_id);
+    // reclaim the level once its last order is gone
+    remove_level_if_empty(order->get_side(), priceLvl);
 
-            if (side == BUY) {
-                --bid_count_;
-            } else {
-                --ask_count_;
-            }
-            --total_orders_;
+    release_order(order);
+    publish_top();
+    return true;
+}
 
-            // Clean up empty price levels if needed
-            if (orders.empty()) {
-                // Note: In a production system, you'd remove empty nodes
-                // but for simplicity we'll leave them
-            }
+template <size_t Degree>
+const Order* BTreeOrderBook<Degree>::modify_order(Order::OrderId order_id, Price price, Quantity quantity) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr || quantity <= 0) {
+        return nullptr;
+    }
 
-            return true;
-        }
+    Side side = order->get_side();
+    BTreeNode*& root = side == BUY ? buy_tree_root_ : sell_tree_root_;
+    PriceLevel* level = order->get_level();
+    Quantity old_quantity = order->get_remaining_quantity();
+
+    // quantity down at the same price keeps its place in the queue
+    if (price == level->price && quantity <= old_quantity) {
+        level->reduce_quantity(old_quantity - quantity);
+        adjust_quantity(root, price, quantity - old_quantity);
+        order->amend(price, quantity);
+        level_changed(side, level);
+        order_event(OrderEventType::AMEND, order, price, quantity, 0, true);
+        publish_top();
+        return order;
+    }
+
+    // otherwise requeue the same order at the back of its new level. The old
+    // level goes last, so an unchanged price reuses it rather than dropping
+    // and recreating it
+    level->erase(order);
+    adjust_quantity(root, level->price, -old_quantity);
+    order->amend(price, quantity);
+    if (side == BUY) {
+        bid_levels_ += insert(root, price, order);
+    } else {
+        ask_levels_ += insert(root, price, order);
     }
-    return false;
+    on_level_added(side, order->get_level());
+    if (order->get_level() != level) {
+        level_changed(side, level);
+    }
+    level_changed(side, order->get_level());
+    order_event(OrderEventType::AMEND, order, price, quantity);
+    remove_level_if_empty(side, level);
+    publish_top();
+    return order;
 }
 
-std::vector<Trade> BTreeOrderBook::match_orders() {
-    std::vector<Trade> trades;
-    trades.reserve(100);
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::modify_order(Order::OrderId order_id, Price price, Quantity quantity,
+                                          ExecutionRing& executions) {
+    return modify_order_with(order_id, price, quantity,
+                             [&executions](const Execution& execution) { executions.push(execution); });
+}
 
-    while (true) {
-        // get best bid and ask prices
-        double best_bid_price = get_best_bid();
-        double best_ask_price = get_best_ask();
+// Orders are created and indexed in arrival order, so duplicate ids keep
+// the first; then each run of one side and price takes a single descent
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::add_orders(const OrderMessage* orders, size_t count) {
+    batch_orders_.assign(count, nullptr);
+    for (size_t i = 0; i < count; ++i) {
+        const OrderMessage& message = orders[i];
+        if (message.quantity <= 0 || orders_.find(message.order_id) != nullptr) {
+            continue;
+        }
+        Order* order = order_pool_.create(message.order_id, message.side, message.price,
+                                          message.quantity, symbol_id_);
+        orders_.insert(message.order_id, order);
+        batch_orders_[i] = order;
+    }
+    group_by_level(orders);
+
+    for (size_t run = 0; run < batch_index_.size();) {
+        const OrderMessage& first = orders[batch_index_[run]];
+        size_t end = run;
+        Quantity run_quantity = 0;
+        for (; end < batch_index_.size(); ++end) {
+            const OrderMessage& message = orders[batch_index_[end]];
+            if (message.side != first.side || message.price != first.price) {
+                break;
+            }
+            run_quantity += message.quantity;
+        }
 
-        // check if prices cross
-        if (best_bid_price == 0 || best_ask_price == 0 || best_bid_price < best_ask_price) {
-            break;
+        bool created;
+        PriceLevel* level = locate_level(first.side == BUY ? buy_tree_root_ : sell_tree_root_,
+                                         first.price, run_quantity, created);
+        for (size_t i = run; i < end; ++i) {
+            Order* order = batch_orders_[batch_index_[i]];
+            level->push_back(order);
+            order_event(OrderEventType::ADD, order, order->get_price(), order->get_remaining_quantity());
+        }
+        if (first.side == BUY) {
+            bid_levels_ += created;
+            bid_count_ += end - run;
+        } else {
+            ask_levels_ += created;
+            ask_count_ += end - run;
         }
+        on_level_added(first.side, level);
+        level_changed(first.side, level);
+        run = end;
+    }
 
-        // get price levels
-        PriceLevel* bid_level = find_price_level(buy_tree_root_, best_bid_price);
-        PriceLevel* ask_level = find_price_level(sell_tree_root_, best_ask_price);
+    total_orders_ += batch_index_.size();
+    total_orders_processed_ += batch_index_.size();
+    publish_top();
+    return batch_index_.size();
+}
 
-        if (!bid_level || !ask_level || bid_level->orders.empty() || ask_level->orders.empty()) {
-            break;
-        }
+// drops a filled or cancelled order from the index and returns its slot
+template <size_t Degree>
+void BTreeOrderBook<Degree>::release_order(Order* order) {
+    orders_.erase(order->get_order_id());
+    order_pool_.destroy(order);
+}
 
-        // match orders at these levels
-        auto& buy_order = bid_level->orders.front();
-        auto& sell_order = ask_level->orders.front();
+template <size_t Degree>
+void BTreeOrderBook<Degree>::match_orders(ExecutionRing& executions) {
+    match_orders_with([&executions](const Execution& execution) { executions.push(execution); });
+}
 
-        // determine trade quantity
-        double trade_qty = min(buy_order->get_remaining_quantity(), sell_order->get_remaining_quantity());
+// takes quantity off a resting order at the front of its level; once filled
+// it leaves the book, and losing the level refreshes best
+template <size_t Degree>
+void BTreeOrderBook<Degree>::fill_resting(Side side, PriceLevel* level, Order* order, Quantity quantity) {
+    order->set_remaining_quantity(order->get_remaining_quantity() - quantity);
+    level->reduce_quantity(quantity);
+    adjust_quantity(side == BUY ? buy_tree_root_ : sell_tree_root_, level->price, -quantity);
+    if (!order->is_filled()) {
+        level_changed(side, level);
+        return;
+    }
+    level->pop_front();
+    level_changed(side, level);
+    if (side == BUY) {
+        --bid_count_;
+    } else {
+        --ask_count_;
+    }
+    --total_orders_;
+    remove_level_if_empty(side, level);
+    release_order(order);
+}
 
-        // create trade - using ask price
-        trades.emplace_back(
-            generate_trade_id(),
-            buy_order->get_order_id(),
-            sell_order->get_order_id(),
-            best_ask_price,
-            trade_qty,
-            symbol_
-        );
+template <size_t Degree>
+const Order* BTreeOrderBook<Degree>::find_order(Order::OrderId order_id) const {
+    return orders_.find(order_id);
+}
 
-        // update order quantities
-        buy_order->set_remaining_quantity(buy_order->get_remaining_quantity() - trade_qty);
-        sell_order->set_remaining_quantity(sell_order->get_remaining_quantity() - trade_qty);
+// every resting order needs a slot and at most one level. Non-root leaves
+// hold at least MIN_KEYS levels and there are fewer internal nodes than
+// leaves, which bounds the node count
+template <size_t Degree>
+void BTreeOrderBook<Degree>::reserve(size_t orders) {
+    order_pool_.reserve(orders);
+    level_pool_.reserve(orders);
+    node_pool_.reserve(2 * orders / MIN_KEYS + 2);
+    orders_.reserve(orders);
+}
 
-        // remove filled orders
-        if (buy_order->is_filled()) {
-            bid_level->orders.pop_front();
-            order_location_.erase(buy_order->get_order_id());
-            --bid_count_;
-            --total_orders_;
+// bids from the highest leaf backwards, asks from the lowest forwards
+template <size_t Degree>
+void BTreeOrderBook<Degree>::export_orders(std::vector<SnapshotOrder>& orders) const {
+    orders.reserve(orders.size() + total_orders_);
+    for (Side side : {BUY, SELL}) {
+        BTreeNode* leaf = side == BUY ? buy_tree_root_ : sell_tree_root_;
+        while (!leaf->is_leaf) {
+            leaf = side == BUY ? leaf->children[leaf->count] : leaf->children[0];
         }
+        for (; leaf != nullptr; leaf = side == BUY ? leaf->prev : leaf->next) {
+            for (size_t k = 0; k < leaf->count; ++k) {
+                const PriceLevel* level = leaf->levels[side == BUY ? leaf->count - 1 - k : k];
+                for (const Order* order = level->front(); order; order = order->get_next_in_level()) {
+                    orders.push_back(SnapshotOrder{order->get_order_id(), level->price, order->get_quantity(),
+                                                   order->get_remaining_quantity(), uint8_t(side), {}});
+                }
+            }
+        }
+    }
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::load_orders(const SnapshotOrder* orders, size_t count) {
+    if (!is_loadable(orders, count)) {
+        return false;
+    }
+    size_t bids = snapshot_bid_count(orders, count);
+    reserve(count);
+    load_side(BUY, orders, bids);
+    load_side(SELL, orders + bids, count - bids);
+    publish_top();
+    return true;
+}
 
-        if (sell_order->is_filled()) {
-            ask_level->orders.pop_front();
-            order_location_.erase(sell_order->get_order_id());
-            --ask_count_;
-            --total_orders_;
+// queues one side's orders level by level, then swaps its (empty) tree for
+// one built over the levels in ascending price order
+template <size_t Degree>
+void BTreeOrderBook<Degree>::load_side(Side side, const SnapshotOrder* orders, size_t count) {
+    std::vector<PriceLevel*> levels;
+    PriceLevel* level = nullptr;
+    size_t loaded = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const SnapshotOrder& o = orders[i];
+        if (orders_.find(o.order_id) != nullptr) {
+            continue;
+        }
+        Order* order = order_pool_.create(o.order_id, side, o.price, o.quantity, symbol_id_);
+        order->set_remaining_quantity(o.remaining_quantity);
+        if (level == nullptr || level->price != o.price) {
+            level = level_pool_.create(o.price);
+            levels.push_back(level);
         }
+        level->push_back(order);
+        orders_.insert(o.order_id, order);
+        order_event(OrderEventType::ADD, order, o.price, o.remaining_quantity);
+        ++loaded;
+    }
+    for (const PriceLevel* loaded_level : levels) {
+        level_changed(side, loaded_level);
+    }
+    if (side == BUY) {
+        std::reverse(levels.begin(), levels.end());
+    }
 
-        // increment total trades
-        ++total_trades_;
+    BTreeNode*& root = side == BUY ? buy_tree_root_ : sell_tree_root_;
+    node_pool_.destroy(root);
+    root = build_tree(levels);
+    if (side == BUY) {
+        bid_levels_ = levels.size();
+        bid_count_ = loaded;
+    } else {
+        ask_levels_ = levels.size();
+        ask_count_ = loaded;
     }
-    return trades;
+    total_orders_ += loaded;
+    total_orders_processed_ += loaded;
+    refresh_best(side);
+}
+
+template <size_t Degree>
+Price BTreeOrderBook<Degree>::get_best_bid() const {
+    return best_bid_.price;
+}
+
+template <size_t Degree>
+Price BTreeOrderBook<Degree>::get_best_ask() const {
+    return best_ask_.price;
 }
 
-double BTreeOrderBook::get_best_bid() const {
-    return find_best_price(buy_tree_root_, true);
+template <size_t Degree>
+Quantity BTreeOrderBook<Degree>::get_best_bid_size() const {
+    return best_bid_.level ? best_bid_.level->total_quantity : 0;
 }
 
-double BTreeOrderBook::get_best_ask() const {
-    return find_best_price(sell_tree_root_, false);
+template <size_t Degree>
+Quantity BTreeOrderBook<Degree>::get_best_ask_size() const {
+    return best_ask_.level ? best_ask_.level->total_quantity : 0;
 }
 
-size_t BTreeOrderBook::get_bid_count() const {
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::get_bid_count() const {
     return bid_count_;
 }
 
-size_t BTreeOrderBook::get_ask_count() const {
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::get_ask_count() const {
     return ask_count_;
 }
 
-size_t BTreeOrderBook::get_total_orders() const {
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::get_total_orders() const {
     return total_orders_processed_;
 }
 
-std::vector<OrderBook::Level> BTreeOrderBook::get_bid_levels(size_t max_levels) const {
+template <size_t Degree>
+std::vector<OrderBook::Level> BTreeOrderBook<Degree>::get_bid_levels(size_t max_levels) const {
     std::vector<Level> levels;
     levels.reserve(max_levels);
     collect_levels(buy_tree_root_, levels, max_levels, true);
     return levels;
 }
 
-std::vector<OrderBook::Level> BTreeOrderBook::get_ask_levels(size_t max_levels) const {
+template <size_t Degree>
+std::vector<OrderBook::Level> BTreeOrderBook<Degree>::get_ask_levels(size_t max_levels) const {
     std::vector<Level> levels;
     levels.reserve(max_levels);
     collect_levels(sell_tree_root_, levels, max_levels, false);
     return levels;
 }
 
+// Node arrays are fixed-size, so inserts and erases shift in place
+namespace {
+
+// Sizes of the nodes that hold n entries when every node is filled to max,
+// except that a short last node evens out with the one before it so both
+// keep at least min. With max >= 2 * min - 1 that always works
+std::vector<size_t> fill_sizes(size_t n, size_t max, size_t min) {
+    std::vector<size_t> sizes(n / max, max);
+    if (n % max != 0) {
+        sizes.push_back(n % max);
+    }
+    if (sizes.size() > 1 && sizes.back() < min) {
+        size_t total = sizes[sizes.size() - 2] + sizes.back();
+        sizes[sizes.size() - 2] = total - total / 2;
+        sizes.back() = total / 2;
+    }
+    return sizes;
+}
+
+// shift items[pos, size) one slot right and store value at pos
+template <typename T>
+void insert_at(T* items, size_t size, size_t pos, T value) {
+    std::copy_backward(items + pos, items + size, items + size + 1);
+    items[pos] = value;
+}
+
+// shift items[pos + 1, size) one slot left over pos
+template <typename T>
+void erase_at(T* items, size_t size, size_t pos) {
+    std::copy(items + pos + 1, items + size, items + pos);
+}
+
+} // namespace
+
 // B-Tree helper methods
-void BTreeOrderBook::insert(BTreeNode*& root, double price, std::shared_ptr<Order> order) {
+// returns true if a new price level was created
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::insert(BTreeNode*& root, Price price, Order* order) {
+    bool created;
+    locate_level(root, price, order->get_remaining_quantity(), created)->push_back(order);
+    return created;
+}
+
+// one descent to the level at price, creating it if needed. quantity is
+// what the caller is about to queue there; it is added to the subtree
+// totals on the way down
+template <size_t Degree>
+PriceLevel* BTreeOrderBook<Degree>::locate_level(BTreeNode*& root, Price price, Quantity quantity,
+                                                 bool& created) {
     // Handle root split if needed
-    if (root->keys.size() == max_keys_) {
-        BTreeNode* newRoot = new BTreeNode();
-        newRoot->is_leaf = false;
-        newRoot->children.push_back(root);
+    if (root->count == MAX_KEYS) {
+        BTreeNode* newRoot = node_pool_.create(false);
+        newRoot->children[0] = root;
         split_child(newRoot, 0);
         root = newRoot;
     }
 
-    // Insert into non-full node
+    // Insert into non-full node - orders only live in leaves, so always descend
     BTreeNode* current = root;
     while (!current->is_leaf) {
-        // Binary search for correct child
-        size_t i = binary_search_price(current->keys, price);
-
-        if (i < current->keys.size() && current->keys[i].price == price) {
-            current->keys[i].orders.push_back(order);
-            return;
-        }
+        size_t i = binary_search_price(current, price);
 
-        if (current->children[i]->keys.size() == max_keys_) {
+        if (current->children[i]->count == MAX_KEYS) {
             split_child(current, i);
-            if (price > current->keys[i].price) {
+            if (price > current->keys[i]) {
                 i++;
             }
         }
+        // the orders land somewhere under this child
+        current->child_quantity[i] += quantity;
         current = current->children[i];
     }
 
     // Insert into leaf
-    int i = binary_search_price(current->keys, price);
+    size_t i = binary_search_price(current, price);
 
-    if (i < current->keys.size() && current->keys[i].price == price) {
-        current->keys[i].orders.push_back(order);
-    } else {
-        PriceLevel newLevel(price);
-        newLevel.orders.push_back(order);
-        current->keys.insert(current->keys.begin() + i, newLevel);
+    created = !(i < current->count && current->keys[i] == price);
+    if (!created) {
+        return current->levels[i];
     }
-}
-
-// Binary search helper for better cache performance
-int BTreeOrderBook::binary_search_price(const std::vector<PriceLevel>& keys, double price) const {
-    int left = 0;
-    int right = keys.size();
 
-    while (left < right) {
-        int mid = left + (right - left) / 2;
-        if (keys[mid].price < price) {
-            left = mid + 1;
-        } else {
-            right = mid;
-        }
-    }
+    PriceLevel* newLevel = level_pool_.create(price);
+    insert_at(current->keys, current->count, i, price);
+    insert_at(current->levels, current->count, i, newLevel);
+    ++current->count;
+    return newLevel;
+}
 
-    return left;
+// Lower bound over a node's packed keys - a branch-free SIMD count of the
+// keys below price across all KEY_SLOTS (see utils/KeySearch.h)
+template <size_t Degree>
+int BTreeOrderBook<Degree>::binary_search_price(const BTreeNode* node, Price price) const {
+    return int(utils::lower_bound_fixed<KEY_SLOTS>(node->keys, price));
 }
 
 
-void BTreeOrderBook::split_child(BTreeNode* parent, int index) {
+template <size_t Degree>
+void BTreeOrderBook<Degree>::split_child(BTreeNode* parent, int index) {
     BTreeNode* child = parent->children[index];
-    int mid = child->keys.size() / 2;
+    size_t mid = child->count / 2;
 
-    BTreeNode* newNode = new BTreeNode();
-    newNode->is_leaf = child->is_leaf;
+    BTreeNode* newNode = node_pool_.create(child->is_leaf);
+    Price separator = child->keys[mid];
 
-    // For leaf nodes, we need to keep the middle key in the original node
-    // For internal nodes, the middle key moves up to the parent
+    // For leaf nodes the middle level stays in the original node and only its
+    // price goes up. For internal nodes the middle key moves up to the parent
     if (child->is_leaf) {
-        // Copy right half to new node (excluding middle)
-        newNode->keys.assign(child->keys.begin() + mid + 1, child->keys.end());
+        // Move right half to new node (excluding middle)
+        std::copy(child->keys + mid + 1, child->keys + child->count, newNode->keys);
+        std::copy(child->levels + mid + 1, child->levels + child->count, newNode->levels);
+        newNode->count = child->count - (mid + 1);
 
         // Keep left half including middle in original node
-        child->keys.resize(mid + 1);
+        child->resize(mid + 1);
 
         // link newNode to leaf chain. Links are only for leaf nodes
         newNode->next = child->next;
@@ -267,86 +512,376 @@ void BTreeOrderBook::split_child(BTreeNode* parent, int index) {
         }
         child->next = newNode;
         newNode->prev = child;
-
-        // Insert a copy of the middle key into parent
-        parent->keys.insert(parent->keys.begin() + index, child->keys[mid]);
     } else {
-        // keys only store routing data when a non-leaf is splitting
-        // Save middle key
-        PriceLevel middleKey = child->keys[mid];
-
-        // Copy right half to new node (excluding middle)
-        newNode->keys.assign(child->keys.begin() + mid + 1, child->keys.end());
-        child->keys.resize(mid);
+        // Move right half to new node (excluding middle)
+        std::copy(child->keys + mid + 1, child->keys + child->count, newNode->keys);
 
         // Move children pointers
-        newNode->children.assign(child->children.begin() + mid + 1, child->children.end());
-        child->children.resize(mid + 1);
-
-        // Insert middle key into parent
-        parent->keys.insert(parent->keys.begin() + index, middleKey);
+        std::copy(child->children + mid + 1, child->children + child->count + 1, newNode->children);
+        std::copy(child->child_quantity + mid + 1, child->child_quantity + child->count + 1,
+                  newNode->child_quantity);
+        newNode->count = child->count - (mid + 1);
+        child->resize(mid);
     }
 
-    parent->children.insert(parent->children.begin() + index + 1, newNode);
+    // Insert separator into parent - only an integer moves up
+    insert_at(parent->keys, parent->count, index, separator);
+    insert_at(parent->children, parent->count + 1, index + 1, newNode);
+    insert_at(parent->child_quantity, parent->count + 1, index + 1, node_quantity(newNode));
+    parent->child_quantity[index] = node_quantity(child);
+    ++parent->count;
 }
 
 
-BTreeOrderBook::PriceLevel* BTreeOrderBook::find_price_level(BTreeNode* root, double price) const {
+// Bulk load: leaves take the levels MAX_KEYS at a time and are chained as
+// they are made; each internal level then takes the nodes below it
+// MAX_KEYS + 1 at a time, with the highest price under a child as its
+// separator, until one node is left as the root
+template <size_t Degree>
+typename BTreeOrderBook<Degree>::BTreeNode* BTreeOrderBook<Degree>::build_tree(const std::vector<PriceLevel*>& levels) {
+    if (levels.empty()) {
+        return node_pool_.create(true);
+    }
+
+    std::vector<BTreeNode*> nodes;
+    std::vector<Price> highest;          // highest price under each of nodes
+    size_t next = 0;
+    BTreeNode* prev = nullptr;
+    for (size_t size : fill_sizes(levels.size(), MAX_KEYS, MIN_KEYS)) {
+        BTreeNode* leaf = node_pool_.create(true);
+        for (size_t i = 0; i < size; ++i, ++next) {
+            leaf->keys[i] = levels[next]->price;
+            leaf->levels[i] = levels[next];
+        }
+        leaf->count = size;
+        leaf->prev = prev;
+        if (prev) {
+            prev->next = leaf;
+        }
+        prev = leaf;
+        nodes.push_back(leaf);
+        highest.push_back(levels[next - 1]->price);
+    }
+
+    std::vector<BTreeNode*> parents;
+    std::vector<Price> parent_highest;
+    while (nodes.size() > 1) {
+        parents.clear();
+        parent_highest.clear();
+        next = 0;
+        for (size_t size : fill_sizes(nodes.size(), MAX_KEYS + 1, MIN_KEYS + 1)) {
+            BTreeNode* parent = node_pool_.create(false);
+            for (size_t i = 0; i < size; ++i, ++next) {
+                parent->children[i] = nodes[next];
+                parent->child_quantity[i] = node_quantity(nodes[next]);
+                if (i + 1 < size) {
+                    parent->keys[i] = highest[next];
+                }
+            }
+            parent->count = size - 1;
+            parents.push_back(parent);
+            parent_highest.push_back(highest[next - 1]);
+        }
+        nodes.swap(parents);
+        highest.swap(parent_highest);
+    }
+    return nodes.front();
+}
+
+template <size_t Degree>
+PriceLevel* BTreeOrderBook<Degree>::find_price_level(BTreeNode* root, Price price) const {
     if (!root) return nullptr;
 
     BTreeNode* current = root;
-    while (current) {
-        size_t i = binary_search_price(current->keys, price);
+    while (!current->is_leaf) {
+        current = current->children[binary_search_price(current, price)];
+    }
 
-        if (i < current->keys.size() && current->keys[i].price == price) {
-            return &current->keys[i];
-        }
+    size_t i = binary_search_price(current, price);
+    if (i < current->count && current->keys[i] == price) {
+        return current->levels[i];
+    }
+    return nullptr;
+}
+
+// adds delta to the subtree totals on the path to price; the level itself
+// keeps its own running total
+template <size_t Degree>
+void BTreeOrderBook<Degree>::adjust_quantity(BTreeNode* root, Price price, Quantity delta) {
+    for (BTreeNode* current = root; !current->is_leaf;) {
+        int i = binary_search_price(current, price);
+        current->child_quantity[i] += delta;
+        current = current->children[i];
+    }
+}
 
-        if (current->is_leaf) {
-            return nullptr;
+template <size_t Degree>
+Quantity BTreeOrderBook<Degree>::node_quantity(const BTreeNode* node) const {
+    Quantity total = 0;
+    if (node->is_leaf) {
+        for (size_t i = 0; i < node->count; ++i) {
+            total += node->levels[i]->total_quantity;
+        }
+    } else {
+        for (size_t i = 0; i <= node->count; ++i) {
+            total += node->child_quantity[i];
         }
+    }
+    return total;
+}
+
+// Child i covers (keys[i-1], keys[i]], so on the way down to limit every
+// child wholly on the taker's side of it is added from the node's totals
+// and only one child per level is descended into
+template <size_t Degree>
+Quantity BTreeOrderBook<Degree>::get_available_quantity(Side side, Price limit) const {
+    const BTreeNode* current = side == BUY ? buy_tree_root_ : sell_tree_root_;
+    Quantity total = 0;
 
+    while (!current->is_leaf) {
+        int i = binary_search_price(current, limit);
+        if (side == SELL) {
+            // asks at or below limit: every child left of i
+            for (int c = 0; c < i; ++c) {
+                total += current->child_quantity[c];
+            }
+        } else {
+            // bids at or above limit: every child right of i
+            for (int c = i + 1; c <= int(current->count); ++c) {
+                total += current->child_quantity[c];
+            }
+        }
         current = current->children[i];
     }
-    // if root is nullptr
-    return nullptr;
+
+    int i = binary_search_price(current, limit);
+    if (side == SELL) {
+        int end = i < int(current->count) && current->keys[i] == limit ? i + 1 : i;
+        for (int c = 0; c < end; ++c) {
+            total += current->levels[c]->total_quantity;
+        }
+    } else {
+        for (int c = i; c < int(current->count); ++c) {
+            total += current->levels[c]->total_quantity;
+        }
+    }
+    return total;
+}
+
+// B-Tree deletion
+//
+// Child i of an internal node holds prices in (keys[i-1], keys[i]]. A
+// separator stays valid when the level it was copied from goes away, so
+// removing a level only has to keep every non-root node at >= MIN_KEYS
+// by borrowing from or merging with a sibling.
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::remove_level_if_empty(Side side, PriceLevel* level) {
+    if (!level->empty()) {
+        return;
+    }
+    bool was_best = level == (side == BUY ? best_bid_.level : best_ask_.level);
+
+    if (side == BUY) {
+        erase_level(buy_tree_root_, level);
+        --bid_levels_;
+    } else {
+        erase_level(sell_tree_root_, level);
+        --ask_levels_;
+    }
+
+    // only losing the best level needs a (single) descent to find the next one
+    if (was_best) {
+        refresh_best(side);
+    }
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::erase_level(BTreeNode*& root, PriceLevel* level) {
+    erase_from(root, level->price);
+
+    // shrink the tree when the root is left with a single child
+    if (!root->is_leaf && root->count == 0) {
+        BTreeNode* oldRoot = root;
+        root = root->children[0];
+        node_pool_.destroy(oldRoot);
+    }
+
+    level_pool_.destroy(level);
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::erase_from(BTreeNode* node, Price price) {
+    int i = binary_search_price(node, price);
+
+    if (node->is_leaf) {
+        erase_at(node->keys, node->count, i);
+        erase_at(node->levels, node->count, i);
+        node->resize(node->count - 1);
+        return;
+    }
+
+    BTreeNode* child = node->children[i];
+    erase_from(child, price);
+
+    if (is_underflow(child)) {
+        rebalance_child(node, i);
+    }
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::rebalance_child(BTreeNode* parent, int index) {
+    int last = int(parent->count);
+
+    if (index > 0 && parent->children[index - 1]->count > MIN_KEYS) {
+        borrow_from_left(parent, index);
+    } else if (index < last && parent->children[index + 1]->count > MIN_KEYS) {
+        borrow_from_right(parent, index);
+    } else if (index > 0) {
+        merge_children(parent, index - 1);
+    } else {
+        merge_children(parent, index);
+    }
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::borrow_from_left(BTreeNode* parent, int index) {
+    BTreeNode* child = parent->children[index];
+    BTreeNode* left = parent->children[index - 1];
+
+    if (child->is_leaf) {
+        // move the left sibling's highest level across
+        insert_at(child->keys, child->count, 0, left->keys[left->count - 1]);
+        insert_at(child->levels, child->count, 0, left->levels[left->count - 1]);
+        ++child->count;
+        left->resize(left->count - 1);
+        parent->keys[index - 1] = left->keys[left->count - 1];
+    } else {
+        // rotate through the parent separator
+        insert_at(child->keys, child->count, 0, parent->keys[index - 1]);
+        insert_at(child->children, child->count + 1, 0, left->children[left->count]);
+        insert_at(child->child_quantity, child->count + 1, 0, left->child_quantity[left->count]);
+        ++child->count;
+        parent->keys[index - 1] = left->keys[left->count - 1];
+        left->resize(left->count - 1);
+    }
+    parent->child_quantity[index - 1] = node_quantity(left);
+    parent->child_quantity[index] = node_quantity(child);
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::borrow_from_right(BTreeNode* parent, int index) {
+    BTreeNode* child = parent->children[index];
+    BTreeNode* right = parent->children[index + 1];
+
+    if (child->is_leaf) {
+        // move the right sibling's lowest level across
+        child->keys[child->count] = right->keys[0];
+        child->levels[child->count] = right->levels[0];
+        ++child->count;
+        erase_at(right->keys, right->count, 0);
+        erase_at(right->levels, right->count, 0);
+        right->resize(right->count - 1);
+        parent->keys[index] = child->keys[child->count - 1];
+    } else {
+        // rotate through the parent separator
+        child->keys[child->count] = parent->keys[index];
+        child->children[child->count + 1] = right->children[0];
+        child->child_quantity[child->count + 1] = right->child_quantity[0];
+        ++child->count;
+        parent->keys[index] = right->keys[0];
+        erase_at(right->keys, right->count, 0);
+        erase_at(right->children, right->count + 1, 0);
+        erase_at(right->child_quantity, right->count + 1, 0);
+        right->resize(right->count - 1);
+    }
+    parent->child_quantity[index] = node_quantity(child);
+    parent->child_quantity[index + 1] = node_quantity(right);
+}
+
+// merges children[index + 1] into children[index]
+template <size_t Degree>
+void BTreeOrderBook<Degree>::merge_children(BTreeNode* parent, int index) {
+    BTreeNode* left = parent->children[index];
+    BTreeNode* right = parent->children[index + 1];
+
+    if (left->is_leaf) {
+        std::copy(right->keys, right->keys + right->count, left->keys + left->count);
+        std::copy(right->levels, right->levels + right->count, left->levels + left->count);
+        left->count += right->count;
+
+        // unlink the right leaf from the leaf chain
+        left->next = right->next;
+        if (left->next != nullptr) {
+            left->next->prev = left;
+        }
+    } else {
+        // the separator comes down between the two key runs
+        left->keys[left->count] = parent->keys[index];
+        std::copy(right->keys, right->keys + right->count, left->keys + left->count + 1);
+        std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+        std::copy(right->child_quantity, right->child_quantity + right->count + 1,
+                  left->child_quantity + left->count + 1);
+        left->count += right->count + 1;
+    }
+
+    parent->child_quantity[index] += parent->child_quantity[index + 1];
+    erase_at(parent->keys, parent->count, index);
+    erase_at(parent->children, parent->count + 1, index + 1);
+    erase_at(parent->child_quantity, parent->count + 1, index + 1);
+    parent->resize(parent->count - 1);
+
+    // levels and children now belong to left
+    node_pool_.destroy(right);
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::is_underflow(BTreeNode* node) const {
+    return node->count < MIN_KEYS;
 }
 
 
-double BTreeOrderBook::find_best_price(BTreeNode* root, bool find_max) const {
+template <size_t Degree>
+PriceLevel* BTreeOrderBook<Degree>::find_best_level(BTreeNode* root, bool find_max) const {
     if (root == nullptr) {
-        return 0.0;
+        return nullptr;
     }
 
     BTreeNode* current = root;
 
     // navigate to the appropriate leaf
     while (!current->is_leaf) {
-        if (current->children.empty()) {
-            break;
-        }
-        current = find_max ? current->children.back() : current->children.front();
+        current = find_max ? current->children[current->count] : current->children[0];
     }
 
-    // Find non-empty price level
-    if (find_max) {
-        for (int i = current->keys.size() - 1; i >= 0; --i) {
-            if (!current->keys[i].orders.empty()) {
-                return current->keys[i].price;
-            }
-        }
-    } else {
-        for (size_t i = 0; i < current->keys.size(); ++i) {
-            if (!current->keys[i].orders.empty()) {
-                return current->keys[i].price;
-            }
-        }
+    // empty levels are reclaimed, so the extreme level is the best price
+    if (current->count == 0) {
+        return nullptr;
     }
+    return find_max ? current->levels[current->count - 1] : current->levels[0];
+}
 
-    return 0.0;
+template <size_t Degree>
+void BTreeOrderBook<Degree>::refresh_best(Side side) {
+    BestLevel& best = side == BUY ? best_bid_ : best_ask_;
+    best.level = find_best_level(side == BUY ? buy_tree_root_ : sell_tree_root_, side == BUY);
+    best.price = best.level ? best.level->price : 0;
 }
 
-void BTreeOrderBook::collect_levels(BTreeNode* node, std::vector<Level>& levels, size_t max_levels, bool reverse) const {
+// an order now rests at level - it may be a new best price
+template <size_t Degree>
+void BTreeOrderBook<Degree>::on_level_added(Side side, PriceLevel* level) {
+    BestLevel& best = side == BUY ? best_bid_ : best_ask_;
+    bool improves = best.level == nullptr ||
+                    (side == BUY ? level->price > best.price : level->price < best.price);
+    if (improves) {
+        best.level = level;
+        best.price = level->price;
+    }
+}
+
+template <size_t Degree>
+void BTreeOrderBook<Degree>::collect_levels(BTreeNode* node, std::vector<Level>& levels, size_t max_levels, bool reverse) const {
     size_t count = 0;
     if (node == nullptr) {
         return;
@@ -355,47 +890,168 @@ void BTreeOrderBook::collect_levels(BTreeNode* node, std::vector<Level>& levels,
     BTreeNode* leaf = node;
     while (leaf != nullptr && !leaf->is_leaf) {
         if (reverse) {
-            leaf = leaf->children.back();
+            leaf = leaf->children[leaf->count];
         }
         else {
-            leaf = leaf->children.front();
+            leaf = leaf->children[0];
         }
     }
     // traverse the list if needed
     while (leaf != nullptr && count < max_levels) {
         // if backward then iterate backwards using prev pointers
         if (reverse) {
-            for (int i = int(leaf->keys.size()) - 1; i >= 0 && count < max_levels; --i) {
-                const PriceLevel& priceLvl = leaf->keys[i];
-                if (!priceLvl.orders.empty()) {
-                    double qty = 0.0;
-                    for (const auto &order : priceLvl.orders) {
-                        qty += order->get_remaining_quantity();
-                    }
-                    levels.emplace_back(priceLvl.price, qty, priceLvl.orders.size());
-                    count++;
-                }
+            for (int i = int(leaf->count) - 1; i >= 0 && count < max_levels; --i) {
+                const PriceLevel& priceLvl = *leaf->levels[i];
+                levels.emplace_back(priceLvl.price, priceLvl.total_quantity, priceLvl.order_count);
+                count++;
             }
             leaf = leaf->prev;
         }
         // if forward simply iterate through the list forward using next pointers
         else {
-            for (int i = 0; i < int(leaf->keys.size()) && count < max_levels; ++i) {
-                const PriceLevel &priceLvl = leaf->keys[i];
-                if (!priceLvl.orders.empty()) {
-                    double qty = 0.0;
-                    for (const auto &order : priceLvl.orders) {
-                        qty += order->get_remaining_quantity();
-                    }
-                    levels.emplace_back(priceLvl.price, qty, priceLvl.orders.size());
-                    count++;
-                }
+            for (int i = 0; i < int(leaf->count) && count < max_levels; ++i) {
+                const PriceLevel &priceLvl = *leaf->levels[i];
+                levels.emplace_back(priceLvl.price, priceLvl.total_quantity, priceLvl.order_count);
+                count++;
             }
             leaf = leaf->next;
         }
     }
 }
 
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::get_level_count(Side side) const {
+    return side == BUY ? bid_levels_ : ask_levels_;
+}
+
+template <size_t Degree>
+size_t BTreeOrderBook<Degree>::get_tree_height(Side side) const {
+    size_t height = 1;
+    for (BTreeNode* node = side == BUY ? buy_tree_root_ : sell_tree_root_; !node->is_leaf;
+         node = node->children[0]) {
+        ++height;
+    }
+    return height;
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::check_invariants() const {
+    const Price lowest = std::numeric_limits<Price>::min();
+    const Price highest = std::numeric_limits<Price>::max();
+    return check_node(buy_tree_root_, lowest, highest, true) > 0 &&
+           check_node(sell_tree_root_, lowest, highest, true) > 0 &&
+           check_leaf_chain(buy_tree_root_, bid_levels_) &&
+           check_leaf_chain(sell_tree_root_, ask_levels_) &&
+           check_best(best_bid_, find_best_level(buy_tree_root_, true)) &&
+           check_best(best_ask_, find_best_level(sell_tree_root_, false));
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::check_best(const BestLevel& best, const PriceLevel* expected) const {
+    return best.level == expected && best.price == (expected ? expected->price : 0);
+}
+
+// returns the height of the subtree, or -1 if any invariant is broken.
+// Every price in the subtree must lie in (lower, upper]
+template <size_t Degree>
+int BTreeOrderBook<Degree>::check_node(BTreeNode* node, Price lower, Price upper, bool is_root) const {
+    if (node->count > MAX_KEYS || (!is_root && node->count < MIN_KEYS)) {
+        return -1;
+    }
+    // unused slots keep the padding the search relies on
+    for (size_t i = node->count; i < KEY_SLOTS; ++i) {
+        if (node->keys[i] != NO_KEY) {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < node->count; ++i) {
+        if (node->keys[i] <= lower || node->keys[i] > upper) {
+            return -1;
+        }
+        if (i > 0 && node->keys[i - 1] >= node->keys[i]) {
+            return -1;
+        }
+    }
+
+    if (node->is_leaf) {
+        for (size_t i = 0; i < node->count; ++i) {
+            const PriceLevel* level = node->levels[i];
+            if (level->price != node->keys[i]) {
+                return -1;
+            }
+            if (level->empty() || !check_level(level)) {
+                return -1;
+            }
+        }
+        return 1;
+    }
+
+    int height = -1;
+    for (size_t i = 0; i <= node->count; ++i) {
+        Price lo = i == 0 ? lower : node->keys[i - 1];
+        Price hi = i == node->count ? upper : node->keys[i];
+        int h = node->children[i] ? check_node(node->children[i], lo, hi, false) : -1;
+        if (h < 0 || (height >= 0 && h != height)) {
+            return -1;
+        }
+        // children are checked first, so their own totals can be trusted
+        if (node->child_quantity[i] != node_quantity(node->children[i])) {
+            return -1;
+        }
+        height = h;
+    }
+    return height + 1;
+}
+
+// running totals must match the queue they summarise
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::check_level(const PriceLevel* level) const {
+    Quantity qty = 0;
+    size_t count = 0;
+    for (const Order* order = level->front(); order; order = order->get_next_in_level()) {
+        if (order->get_level() != level) {
+            return false;
+        }
+        qty += order->get_remaining_quantity();
+        ++count;
+    }
+    return qty == level->total_quantity && count == level->order_count;
+}
+
+template <size_t Degree>
+bool BTreeOrderBook<Degree>::check_leaf_chain(BTreeNode* root, size_t level_count) const {
+    BTreeNode* leaf = root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+    }
+    if (leaf->prev != nullptr) {
+        return false;
+    }
+
+    size_t count = 0;
+    const PriceLevel* last = nullptr;
+    for (; leaf != nullptr; leaf = leaf->next) {
+        if (leaf->next != nullptr && leaf->next->prev != leaf) {
+            return false;
+        }
+        for (size_t i = 0; i < leaf->count; ++i) {
+            const PriceLevel* level = leaf->levels[i];
+            if (last && last->price >= level->price) {
+                return false;
+            }
+            last = level;
+            ++count;
+        }
+    }
+    return count == level_count;
+}
 
+template class BTreeOrderBook<2>;
+template class BTreeOrderBook<3>;
+template class BTreeOrderBook<4>;
+template class BTreeOrderBook<8>;
+template class BTreeOrderBook<16>;
+template class BTreeOrderBook<32>;
+template class BTreeOrderBook<64>;
 
-} // namespace order_matching
\ No newline at end of file
+} // namespace order_matching
@@ -1,27 +1,70 @@
 #pragma once
 
 #include "../core/OrderBook.h"
-#include <map>
-#include <deque>
+#include "../core/PriceLevel.h"
+#include "../utils/FlatIdMap.h"
+#include "../utils/ObjectPool.h"
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 namespace order_matching {
 
+// B+Tree order book with the degree fixed at compile time, so every node is
+// a single allocation with inline arrays sized from Degree. Definitions live
+// in BTreeOrderBook.cpp, which instantiates the degrees listed at the bottom
+// of this file.
+template <size_t Degree = 32>
 class BTreeOrderBook : public OrderBook {
+    static_assert(Degree >= 2, "a B-tree needs degree 2 or more");
+
 public:
-    BTreeOrderBook(const std::string& symbol, size_t degree = 32);
-    ~BTreeOrderBook() {
-        if (buy_tree_root_) delete buy_tree_root_;
-        if (sell_tree_root_) delete sell_tree_root_;
-    }
+    static constexpr size_t DEGREE = Degree;
+
+    BTreeOrderBook(const Instrument& instrument);
+    BTreeOrderBook(const std::string& symbol)
+        : BTreeOrderBook(Instrument(symbol)) {}
+    ~BTreeOrderBook();
 
     // OrderBook interface
-    bool add_order(std::shared_ptr<Order> order) override;
+    using OrderBook::add_order;
+    using OrderBook::match_orders;
+    bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity) override;
+    bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                   ExecutionRing& executions) override;
     bool cancel_order(Order::OrderId order_id) override;
-    std::vector<Trade> match_orders() override;
+    using OrderBook::modify_order;
+    const Order* modify_order(Order::OrderId order_id, Price price, Quantity quantity) override;
+    bool modify_order(Order::OrderId order_id, Price price, Quantity quantity, ExecutionRing& executions) override;
+    size_t add_orders(const OrderMessage* orders, size_t count) override;
+    void match_orders(ExecutionRing& executions) override;
 
-    double get_best_bid() const override;
-    double get_best_ask() const override;
+    // The same operations with each fill handed straight to
+    // sink(const Execution&). Defined below so that a caller holding the
+    // concrete book type gets the sink inlined into the matching loop
+    template <typename Sink>
+    bool add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                        Sink&& sink);
+    template <typename Sink>
+    bool add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity, Sink&& sink) {
+        return add_order_with(id, side, price, quantity, LIMIT, sink);
+    }
+    template <typename Sink>
+    bool modify_order_with(Order::OrderId order_id, Price price, Quantity quantity, Sink&& sink);
+    template <typename Sink>
+    void match_orders_with(Sink&& sink);
+    const Order* find_order(Order::OrderId order_id) const override;
+    void reserve(size_t orders) override;
+
+    // load_orders builds each tree bottom-up: full leaves straight from the
+    // sorted levels, then full internal levels over them, with no splits
+    void export_orders(std::vector<SnapshotOrder>& orders) const override;
+    bool load_orders(const SnapshotOrder* orders, size_t count) override;
+
+    Price get_best_bid() const override;
+    Price get_best_ask() const override;
+    Quantity get_best_bid_size() const override;
+    Quantity get_best_ask_size() const override;
     size_t get_bid_count() const override;
     size_t get_ask_count() const override;
     size_t get_total_orders() const override;
@@ -29,67 +72,315 @@ public:
     std::vector<Level> get_bid_levels(size_t max_levels = 10) const override;
     std::vector<Level> get_ask_levels(size_t max_levels = 10) const override;
 
-private:
-    // B-Tree node
-    struct PriceLevel {
-        double price;
-        std::deque<std::shared_ptr<Order>> orders;
+    // O(log n): sums whole subtrees off the descent to limit
+    Quantity get_available_quantity(Side side, Price limit) const override;
 
-        PriceLevel() : price(0.0) {}
-        PriceLevel(double p) : price(p) {}
-    };
+    // Tree shape - live price levels and height of one side
+    size_t get_level_count(Side side) const;
+    size_t get_tree_height(Side side) const;
+
+    // Verifies ordering, fill factor, separator and leaf chain invariants
+    bool check_invariants() const;
+
+private:
+    static constexpr size_t MIN_KEYS = Degree - 1;        // Minimum keys (degree-1)
+    static constexpr size_t MAX_KEYS = 2 * Degree - 1;    // Maximum keys (2*degree-1)
+    static constexpr size_t KEY_SLOTS = (MAX_KEYS + 3) / 4 * 4;  // whole SIMD blocks
+    static constexpr Price NO_KEY = std::numeric_limits<Price>::max();
 
+    // B+Tree node. Keys are stored structure-of-arrays: a contiguous price
+    // array that the SIMD search scans, kept apart from the payload. Internal
+    // nodes route on it and never hold orders; in a leaf keys[i] is the price
+    // of levels[i], the heap-allocated level (stable address for the orders
+    // that point back at it). Slots past count hold NO_KEY so the search
+    // always covers all KEY_SLOTS. Internal nodes also carry the total
+    // resting quantity of each child's subtree, so the quantity available
+    // up to a price is one root-to-leaf descent. Nodes and levels come from
+    // the book's pools and are trivially destructible.
     struct BTreeNode {
-        std::vector<PriceLevel> keys;        // Price levels in this node
-        std::vector<BTreeNode*> children;    // Child pointers
+        size_t count = 0;                            // keys in use
         bool is_leaf;
 
         // links for leaf chaining
         BTreeNode* next = nullptr;
         BTreeNode* prev = nullptr;
 
-        BTreeNode() : is_leaf(true) {
-            // Pre-allocate capacity for better performance
-            keys.reserve(128);      // max_keys for degree 64
-            children.reserve(129);  // max_keys + 1
+        alignas(32) Price keys[KEY_SLOTS];           // Internal: routing keys, Leaf: level prices
+        union {
+            PriceLevel* levels[MAX_KEYS];            // Leaf: price levels in price order
+            BTreeNode* children[MAX_KEYS + 1];       // Internal: child pointers
+        };
+        Quantity child_quantity[MAX_KEYS + 1];       // Internal: resting quantity under each child
+
+        explicit BTreeNode(bool leaf) : is_leaf(leaf) {
+            std::fill(keys, keys + KEY_SLOTS, NO_KEY);
+        }
+
+        size_t size() const {
+            return count;
         }
 
-        ~BTreeNode() {
-            for (auto child : children) {
-                delete child;
+        // shrink to n keys, padding the freed slots
+        void resize(size_t n) {
+            for (size_t i = n; i < count; ++i) {
+                keys[i] = NO_KEY;
             }
+            count = n;
         }
     };
 
-    // Member variables
-    const size_t degree_;           // B-Tree degree
-    const size_t min_keys_;         // Minimum keys (degree-1)
-    const size_t max_keys_;         // Maximum keys (2*degree-1)
-
     BTreeNode* buy_tree_root_;      // Buy orders tree
     BTreeNode* sell_tree_root_;     // Sell orders tree
 
-    // For fast order lookup/cancellation
-    std::map<Order::OrderId, std::pair<Side, double>> order_location_;
+    // Cached top of book. Kept current by add, cancel and fill so BBO
+    // queries and the matching loop never have to descend the tree; the
+    // size is the level's own running total
+    struct BestLevel {
+        PriceLevel* level = nullptr;
+        Price price = 0;
+    };
+    BestLevel best_bid_;
+    BestLevel best_ask_;
+
+    // Per-book arena: orders, levels and tree nodes live in slab pools, so
+    // steady-state add/cancel/match recycle slots instead of allocating
+    utils::ObjectPool<Order> order_pool_;
+    utils::ObjectPool<PriceLevel> level_pool_;
+    utils::ObjectPool<BTreeNode> node_pool_;
+
+    // Resting orders by id. Cancel goes straight from here to the level via
+    // the order's own hooks
+    utils::FlatIdMap<Order> orders_;
 
     // Metrics
     size_t bid_count_;
     size_t ask_count_;
+    size_t bid_levels_;                  // Live (non-empty) price levels
+    size_t ask_levels_;
     size_t total_orders_;                // Current active orders
     size_t total_orders_processed_;      // Cumulative total
     size_t total_trades_;
 
     // B-Tree operations
-    void insert(BTreeNode*& root, double price, std::shared_ptr<Order> order);
-    int binary_search_price(const std::vector<PriceLevel>& keys, double price) const;
-    BTreeNode* search(BTreeNode* root, double price) const;
+    bool insert(BTreeNode*& root, Price price, Order* order);
+    PriceLevel* locate_level(BTreeNode*& root, Price price, Quantity quantity, bool& created);
+    int binary_search_price(const BTreeNode* node, Price price) const;
+    BTreeNode* search(BTreeNode* root, Price price) const;
     void split_child(BTreeNode* parent, int index);
-    PriceLevel* find_price_level(BTreeNode* root, double price) const;
+    void load_side(Side side, const SnapshotOrder* orders, size_t count);
+    BTreeNode* build_tree(const std::vector<PriceLevel*>& levels);
+    PriceLevel* find_price_level(BTreeNode* root, Price price) const;
+
+    // Subtree quantities: adjust the path to price by delta, or total one
+    // node's own entries (levels for a leaf, children for an internal node)
+    void adjust_quantity(BTreeNode* root, Price price, Quantity delta);
+    Quantity node_quantity(const BTreeNode* node) const;
+
+    // B-Tree deletion: drops an emptied level and rebalances on the way up
+    void erase_level(BTreeNode*& root, PriceLevel* level);
+    void erase_from(BTreeNode* node, Price price);
+    void rebalance_child(BTreeNode* parent, int index);
+    void borrow_from_left(BTreeNode* parent, int index);
+    void borrow_from_right(BTreeNode* parent, int index);
+    void merge_children(BTreeNode* parent, int index);
+    bool is_underflow(BTreeNode* node) const;
+    void remove_level_if_empty(Side side, PriceLevel* level);
+    void release_order(Order* order);
+    void rest_order(Order::OrderId id, Side side, Price price, Quantity quantity);
+    void fill_resting(Side side, PriceLevel* level, Order* order, Quantity quantity);
+    void publish_top() { publish_top_of_book(best_bid_.level, best_ask_.level); }
+    template <typename Sink>
+    Quantity match_incoming(Order::OrderId id, Side side, Price price, Quantity quantity, Sink& sink);
 
     // Helper functions
-    double find_best_price(BTreeNode* root, bool find_max) const;
+    PriceLevel* find_best_level(BTreeNode* root, bool find_max) const;
+    void refresh_best(Side side);
+    void on_level_added(Side side, PriceLevel* level);
     void collect_levels(BTreeNode* node, std::vector<Level>& levels, size_t max_levels, bool reverse) const;
-    // bool is_underflow(BTreeNode* node, bool is_buy_tree) const;
+    int check_node(BTreeNode* node, Price lower, Price upper, bool is_root) const;
+    bool check_level(const PriceLevel* level) const;
+    bool check_leaf_chain(BTreeNode* root, size_t level_count) const;
+    bool check_best(const BestLevel& best, const PriceLevel* expected) const;
 };
 
+// Continuous matching: the incoming order trades against the opposite side
+// first and only what is left rests, so a marketable order is never inserted
+// into the tree just to be matched back out. Market and IOC remainders are
+// dropped instead of resting; a FOK that the opposite side cannot fill
+// within its limit is refused before the book is touched
+template <size_t Degree>
+template <typename Sink>
+bool BTreeOrderBook<Degree>::add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                            OrderType type, Sink&& sink) {
+    if (quantity <= 0 || orders_.find(id) != nullptr) {
+        return false;
+    }
+    if (type == MARKET) {
+        price = marketable_limit(side);
+    }
+    if (type == FOK && get_available_quantity(side == BUY ? SELL : BUY, price) < quantity) {
+        return false;
+    }
+    Quantity remaining = match_incoming(id, side, price, quantity, sink);
+    if (remaining > 0) {
+        if (type == LIMIT) {
+            rest_order(id, side, price, remaining);
+        } else if (remaining == quantity) {
+            return false;   // nothing traded and nothing rests
+        }
+    }
+    ++total_orders_processed_;
+    publish_top();
+    return true;
+}
+
+// walks the opposite side from its cached best level while it crosses the
+// limit price, filling against each queue in time priority. Trades print at
+// the resting order's price. Returns the unfilled quantity
+template <size_t Degree>
+template <typename Sink>
+Quantity BTreeOrderBook<Degree>::match_incoming(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                                Sink& sink) {
+    Side contra = side == BUY ? SELL : BUY;
+    const BestLevel& best = side == BUY ? best_ask_ : best_bid_;
+
+    while (quantity > 0 && best.level != nullptr) {
+        PriceLevel* level = best.level;
+        if (side == BUY ? level->price > price : level->price < price) {
+            break;
+        }
+
+        Order* resting = level->front();
+        Quantity trade_qty = std::min(quantity, resting->get_remaining_quantity());
+        Execution::TradeId trade_id = generate_trade_id();
+        sink(Execution{
+            trade_id,
+            side == BUY ? id : resting->get_order_id(),
+            side == BUY ? resting->get_order_id() : id,
+            level->price,
+            trade_qty,
+            symbol_id_
+        });
+
+        quantity -= trade_qty;
+        record_trade(level->price, trade_qty);
+        order_event(OrderEventType::EXECUTE, resting, level->price, trade_qty, trade_id);
+        fill_resting(contra, level, resting, trade_qty);
+        ++total_trades_;
+    }
+    return quantity;
+}
+
+// A crossing amend takes the order out of its level and matches it at its
+// new price and quantity like an incoming order, with its own fills reported
+// as EXECUTEs after the AMEND that moved it; the remainder rests at the back
+// of the new level. Amends that keep priority or do not reach the opposite
+// side are plain modify_order
+template <size_t Degree>
+template <typename Sink>
+bool BTreeOrderBook<Degree>::modify_order_with(Order::OrderId order_id, Price price, Quantity quantity,
+                                               Sink&& sink) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr || quantity <= 0) {
+        return false;
+    }
+    Side side = order->get_side();
+    const PriceLevel* contra = side == BUY ? best_ask_.level : best_bid_.level;
+    bool keeps_priority = price == order->get_price() && quantity <= order->get_remaining_quantity();
+    if (keeps_priority || contra == nullptr || (side == BUY ? contra->price > price : contra->price < price)) {
+        return modify_order(order_id, price, quantity) != nullptr;
+    }
+
+    BTreeNode*& root = side == BUY ? buy_tree_root_ : sell_tree_root_;
+    PriceLevel* level = order->get_level();
+    level->erase(order);
+    adjust_quantity(root, level->price, -order->get_remaining_quantity());
+    level_changed(side, level);
+    remove_level_if_empty(side, level);
+    order->amend(price, quantity);
+    order_event(OrderEventType::AMEND, order, price, quantity);
+
+    auto fill_amended = [this, order, &sink](const Execution& execution) {
+        sink(execution);
+        order->set_remaining_quantity(order->get_remaining_quantity() - execution.quantity);
+        order_event(OrderEventType::EXECUTE, order, execution.price, execution.quantity, execution.trade_id);
+    };
+    if (match_incoming(order_id, side, price, quantity, fill_amended) > 0) {
+        if (side == BUY) {
+            bid_levels_ += insert(root, price, order);
+        } else {
+            ask_levels_ += insert(root, price, order);
+        }
+        on_level_added(side, order->get_level());
+        level_changed(side, order->get_level());
+    } else {
+        if (side == BUY) {
+            --bid_count_;
+        } else {
+            --ask_count_;
+        }
+        --total_orders_;
+        release_order(order);
+    }
+    publish_top();
+    return true;
+}
+
+template <size_t Degree>
+template <typename Sink>
+void BTreeOrderBook<Degree>::match_orders_with(Sink&& sink) {
+    size_t trades_before = total_trades_;
+    while (true) {
+        // top of book comes straight from the cache
+        PriceLevel* bid_level = best_bid_.level;
+        PriceLevel* ask_level = best_ask_.level;
+
+        // check if prices cross
+        if (!bid_level || !ask_level || bid_level->price < ask_level->price) {
+            break;
+        }
+
+        // match orders at these levels
+        Order* buy_order = bid_level->front();
+        Order* sell_order = ask_level->front();
+
+        // determine trade quantity
+        Quantity trade_qty = std::min(buy_order->get_remaining_quantity(), sell_order->get_remaining_quantity());
+
+        // report the fill - using ask price
+        Execution::TradeId trade_id = generate_trade_id();
+        sink(Execution{
+            trade_id,
+            buy_order->get_order_id(),
+            sell_order->get_order_id(),
+            ask_level->price,
+            trade_qty,
+            symbol_id_
+        });
+
+        // update quantities, filled orders leave
+        record_trade(ask_level->price, trade_qty);
+        order_event(OrderEventType::EXECUTE, buy_order, ask_level->price, trade_qty, trade_id);
+        order_event(OrderEventType::EXECUTE, sell_order, ask_level->price, trade_qty, trade_id);
+        fill_resting(BUY, bid_level, buy_order, trade_qty);
+        fill_resting(SELL, ask_level, sell_order, trade_qty);
+
+        // increment total trades
+        ++total_trades_;
+    }
+    if (total_trades_ != trades_before) {
+        publish_top();
+    }
+}
+
+// Degrees built into the library: the common node sizes compared by the
+// benchmark, plus the small ones the tests use to force splits and merges
+extern template class BTreeOrderBook<2>;
+extern template class BTreeOrderBook<3>;
+extern template class BTreeOrderBook<4>;
+extern template class BTreeOrderBook<8>;
+extern template class BTreeOrderBook<16>;
+extern template class BTreeOrderBook<32>;
+extern template class BTreeOrderBook<64>;
+
 } // namespace order_matching
\ No newline at end of file
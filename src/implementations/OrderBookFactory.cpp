@@ -0,0 +1,17 @@
+#include "../core/OrderBook.h"
+#include "BTreeOrderBook.h"
+#include "PriceLadderOrderBook.h"
+
+namespace order_matching {
+
+std::unique_ptr<OrderBook> make_order_book(OrderBookType type, const Instrument& instrument) {
+    switch (type) {
+        case OrderBookType::PRICE_LADDER:
+            return std::make_unique<PriceLadderOrderBook>(instrument);
+        case OrderBookType::BTREE:
+        default:
+            return std::make_unique<BTreeOrderBook<>>(instrument);
+    }
+}
+
+} // namespace order_matching
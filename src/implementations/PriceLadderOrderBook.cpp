@@ -0,0 +1,581 @@
+#include "PriceLadderOrderBook.h"
+
+#include <algorithm>
+#include <limits>
+using namespace std;
+namespace order_matching {
+
+using utils::OccupancyBitmap;
+
+PriceLadderOrderBook::PriceLadderOrderBook(const Instrument& instrument, size_t window_ticks,
+                                           size_t max_window_ticks)
+    : OrderBook(instrument),
+      window_ticks_(std::max<size_t>(window_ticks, 64)),
+      max_window_ticks_(std::max(max_window_ticks, window_ticks_)),
+      bid_count_(0),
+      ask_count_(0),
+      total_orders_(0),
+      total_orders_processed_(0),
+      total_trades_(0) {
+}
+
+PriceLadderOrderBook::~PriceLadderOrderBook() {
+    orders_.for_each([this](Order* order) { order_pool_.destroy(order); });
+}
+
+
+bool PriceLadderOrderBook::add_order(Order::OrderId id, Side side, Price price, Quantity quantity) {
+    // an id can only rest once
+    if (quantity <= 0 || orders_.find(id) != nullptr) {
+        return false;
+    }
+    if (!rest_order(id, side, price, quantity)) {
+        return false;   // too far from the resting book to fit a window
+    }
+    ++total_orders_processed_;
+    publish_top();
+    return true;
+}
+
+bool PriceLadderOrderBook::add_order(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                     OrderType type, ExecutionRing& executions) {
+    return add_order_with(id, side, price, quantity, type,
+                          [&executions](const Execution& execution) { executions.push(execution); });
+}
+
+bool PriceLadderOrderBook::rest_order(Order::OrderId id, Side side, Price price, Quantity quantity) {
+    Ladder& ladder = side == BUY ? bids_ : asks_;
+    PriceLevel* level = level_for_insert(ladder, price);
+    if (!level) {
+        return false;
+    }
+    Order* order = order_pool_.create(id, side, price, quantity, symbol_id_);
+    level->push_back(order);
+    level_changed(side, level);
+    order_event(OrderEventType::ADD, order, price, quantity);
+
+    if (side == BUY) {
+        ++bid_count_;
+    } else {
+        ++ask_count_;
+    }
+
+    orders_.insert(id, order);
+
+    ++total_orders_;
+    return true;
+}
+
+bool PriceLadderOrderBook::cancel_order(Order::OrderId order_id) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr) {
+        return false;
+    }
+
+    PriceLevel* priceLvl = order->get_level();
+
+    priceLvl->erase(order);
+    order->cancel();
+
+    if (order->get_side() == BUY) {
+        --bid_count_;
+    } else {
+        --ask_count_;
+    }
+    --total_orders_;
+    level_changed(order->get_side(), priceLvl);
+    order_event(OrderEventType::CANCEL, order, priceLvl->price, order->get_remaining_quantity());
+
+    remove_level_if_empty(order->get_side() == BUY ? bids_ : asks_, priceLvl);
+
+    release_order(order);
+    publish_top();
+    return true;
+}
+
+const Order* PriceLadderOrderBook::modify_order(Order::OrderId order_id, Price price, Quantity quantity) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr || quantity <= 0) {
+        return nullptr;
+    }
+
+    PriceLevel* level = order->get_level();
+    Quantity old_quantity = order->get_remaining_quantity();
+
+    // quantity down at the same price keeps its place in the queue
+    if (price == level->price && quantity <= old_quantity) {
+        level->reduce_quantity(old_quantity - quantity);
+        order->amend(price, quantity);
+        level_changed(order->get_side(), level);
+        order_event(OrderEventType::AMEND, order, price, quantity, 0, true);
+        publish_top();
+        return order;
+    }
+
+    // move the window first, while the order still rests: a price it cannot
+    // reach leaves the order untouched, and a relocation moves its level
+    Ladder& ladder = order->get_side() == BUY ? bids_ : asks_;
+    if (!ensure_window(ladder, price)) {
+        return nullptr;
+    }
+    level = order->get_level();
+
+    level->erase(order);
+    if (price != level->price) {
+        level_changed(order->get_side(), level);
+    }
+    remove_level_if_empty(ladder, level);
+    order->amend(price, quantity);
+    level = level_for_insert(ladder, price);
+    level->push_back(order);
+    level_changed(order->get_side(), level);
+    order_event(OrderEventType::AMEND, order, price, quantity);
+    publish_top();
+    return order;
+}
+
+bool PriceLadderOrderBook::modify_order(Order::OrderId order_id, Price price, Quantity quantity,
+                                        ExecutionRing& executions) {
+    return modify_order_with(order_id, price, quantity,
+                             [&executions](const Execution& execution) { executions.push(execution); });
+}
+
+// see BTreeOrderBook. A level the window cannot reach refuses its run
+size_t PriceLadderOrderBook::add_orders(const OrderMessage* orders, size_t count) {
+    batch_orders_.assign(count, nullptr);
+    for (size_t i = 0; i < count; ++i) {
+        const OrderMessage& message = orders[i];
+        if (message.quantity <= 0 || orders_.find(message.order_id) != nullptr) {
+            continue;
+        }
+        Order* order = order_pool_.create(message.order_id, message.side, message.price,
+                                          message.quantity, symbol_id_);
+        orders_.insert(message.order_id, order);
+        batch_orders_[i] = order;
+    }
+    group_by_level(orders);
+
+    size_t accepted = 0;
+    for (size_t run = 0; run < batch_index_.size();) {
+        const OrderMessage& first = orders[batch_index_[run]];
+        size_t end = run;
+        while (end < batch_index_.size() && orders[batch_index_[end]].side == first.side &&
+               orders[batch_index_[end]].price == first.price) {
+            ++end;
+        }
+
+        PriceLevel* level = level_for_insert(first.side == BUY ? bids_ : asks_, first.price);
+        for (size_t i = run; i < end; ++i) {
+            Order* order = batch_orders_[batch_index_[i]];
+            if (level) {
+                level->push_back(order);
+                order_event(OrderEventType::ADD, order, order->get_price(), order->get_remaining_quantity());
+            } else {
+                release_order(order);
+                batch_orders_[batch_index_[i]] = nullptr;
+            }
+        }
+        if (level) {
+            level_changed(first.side, level);
+            if (first.side == BUY) {
+                bid_count_ += end - run;
+            } else {
+                ask_count_ += end - run;
+            }
+            accepted += end - run;
+        }
+        run = end;
+    }
+
+    total_orders_ += accepted;
+    total_orders_processed_ += accepted;
+    publish_top();
+    return accepted;
+}
+
+void PriceLadderOrderBook::release_order(Order* order) {
+    orders_.erase(order->get_order_id());
+    order_pool_.destroy(order);
+}
+
+void PriceLadderOrderBook::match_orders(ExecutionRing& executions) {
+    match_orders_with([&executions](const Execution& execution) { executions.push(execution); });
+}
+
+// takes quantity off a resting order at the front of its level; a filled
+// order leaves the book
+void PriceLadderOrderBook::fill_resting(Ladder& ladder, PriceLevel* level, Order* order, Quantity quantity) {
+    order->set_remaining_quantity(order->get_remaining_quantity() - quantity);
+    level->reduce_quantity(quantity);
+    if (!order->is_filled()) {
+        level_changed(&ladder == &bids_ ? BUY : SELL, level);
+        return;
+    }
+    level->pop_front();
+    level_changed(&ladder == &bids_ ? BUY : SELL, level);
+    if (&ladder == &bids_) {
+        --bid_count_;
+    } else {
+        --ask_count_;
+    }
+    --total_orders_;
+    remove_level_if_empty(ladder, level);
+    release_order(order);
+}
+
+const Order* PriceLadderOrderBook::find_order(Order::OrderId order_id) const {
+    return orders_.find(order_id);
+}
+
+void PriceLadderOrderBook::reserve(size_t orders) {
+    order_pool_.reserve(orders);
+    orders_.reserve(orders);
+}
+
+Price PriceLadderOrderBook::get_best_bid() const {
+    PriceLevel* level = best_level(bids_, true);
+    return level ? level->price : 0;
+}
+
+Price PriceLadderOrderBook::get_best_ask() const {
+    PriceLevel* level = best_level(asks_, false);
+    return level ? level->price : 0;
+}
+
+Quantity PriceLadderOrderBook::get_best_bid_size() const {
+    PriceLevel* level = best_level(bids_, true);
+    return level ? level->total_quantity : 0;
+}
+
+Quantity PriceLadderOrderBook::get_best_ask_size() const {
+    PriceLevel* level = best_level(asks_, false);
+    return level ? level->total_quantity : 0;
+}
+
+size_t PriceLadderOrderBook::get_bid_count() const {
+    return bid_count_;
+}
+
+size_t PriceLadderOrderBook::get_ask_count() const {
+    return ask_count_;
+}
+
+size_t PriceLadderOrderBook::get_total_orders() const {
+    return total_orders_processed_;
+}
+
+Quantity PriceLadderOrderBook::get_available_quantity(Side side, Price limit) const {
+    // from the best price outwards: asks up to limit, bids down to it
+    const Ladder& ladder = side == BUY ? bids_ : asks_;
+    bool highest_first = side == BUY;
+    size_t slot = highest_first ? ladder.occupied.find_last() : ladder.occupied.find_first();
+    Quantity total = 0;
+
+    while (slot != OccupancyBitmap::npos) {
+        const PriceLevel& priceLvl = ladder.levels[slot];
+        if (highest_first ? priceLvl.price < limit : priceLvl.price > limit) {
+            break;
+        }
+        total += priceLvl.total_quantity;
+
+        if (highest_first) {
+            slot = slot == 0 ? OccupancyBitmap::npos : ladder.occupied.find_prev(slot - 1);
+        } else {
+            slot = ladder.occupied.find_next(slot + 1);
+        }
+    }
+    return total;
+}
+
+void PriceLadderOrderBook::export_orders(std::vector<SnapshotOrder>& orders) const {
+    orders.reserve(orders.size() + total_orders_);
+    for (Side side : {BUY, SELL}) {
+        const Ladder& ladder = side == BUY ? bids_ : asks_;
+        size_t slot = side == BUY ? ladder.occupied.find_last() : ladder.occupied.find_first();
+        while (slot != OccupancyBitmap::npos) {
+            const PriceLevel& level = ladder.levels[slot];
+            for (const Order* order = level.front(); order; order = order->get_next_in_level()) {
+                orders.push_back(SnapshotOrder{order->get_order_id(), level.price, order->get_quantity(),
+                                               order->get_remaining_quantity(), uint8_t(side), {}});
+            }
+            if (side == BUY) {
+                slot = slot == 0 ? OccupancyBitmap::npos : ladder.occupied.find_prev(slot - 1);
+            } else {
+                slot = ladder.occupied.find_next(slot + 1);
+            }
+        }
+    }
+}
+
+bool PriceLadderOrderBook::load_orders(const SnapshotOrder* orders, size_t count) {
+    if (!is_loadable(orders, count)) {
+        return false;
+    }
+    size_t bids = snapshot_bid_count(orders, count);
+    reserve(count);
+    load_side(bids_, BUY, orders, bids);
+    load_side(asks_, SELL, orders + bids, count - bids);
+    publish_top();
+    return true;
+}
+
+bool PriceLadderOrderBook::is_loadable(const SnapshotOrder* orders, size_t count) const {
+    if (!OrderBook::is_loadable(orders, count)) {
+        return false;
+    }
+    size_t bids = snapshot_bid_count(orders, count);
+    return side_fits(orders, bids) && side_fits(orders + bids, count - bids);
+}
+
+// whether one side of a snapshot fits a single window, the same limits
+// ensure_window puts on an add
+bool PriceLadderOrderBook::side_fits(const SnapshotOrder* orders, size_t count) const {
+    if (count == 0) {
+        return true;
+    }
+    Price low = std::min(orders[0].price, orders[count - 1].price);
+    Price high = std::max(orders[0].price, orders[count - 1].price);
+    return window_can_hold(low) && window_can_hold(high) &&
+           window_size_for(window_ticks_, uint64_t(high) - uint64_t(low)) != 0;
+}
+
+void PriceLadderOrderBook::load_side(Ladder& ladder, Side side, const SnapshotOrder* orders, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    // the sequence is sorted, so its ends are the side's price range, and
+    // side_fits has checked a window can cover it
+    Price low = std::min(orders[0].price, orders[count - 1].price);
+    Price high = std::max(orders[0].price, orders[count - 1].price);
+    uint64_t distance = uint64_t(high) - uint64_t(low);
+    size_t size = window_size_for(std::max(ladder.levels.size(), window_ticks_), distance);
+    if (ladder.levels.size() != size) {
+        std::vector<PriceLevel>(size).swap(ladder.levels);
+        ladder.occupied.reset(size);
+    }
+    ladder.base = low - Price((size - size_t(distance) - 1) / 2);
+
+    // one update per level, once its queue is complete
+    size_t loaded = 0;
+    PriceLevel* filling = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        const SnapshotOrder& o = orders[i];
+        if (orders_.find(o.order_id) != nullptr) {
+            continue;
+        }
+        PriceLevel* level = level_for_insert(ladder, o.price);
+        if (!level) {
+            continue;
+        }
+        if (filling && filling != level) {
+            level_changed(side, filling);
+        }
+        filling = level;
+        Order* order = order_pool_.create(o.order_id, side, o.price, o.quantity, symbol_id_);
+        order->set_remaining_quantity(o.remaining_quantity);
+        level->push_back(order);
+        orders_.insert(o.order_id, order);
+        order_event(OrderEventType::ADD, order, o.price, o.remaining_quantity);
+        ++loaded;
+    }
+    if (filling) {
+        level_changed(side, filling);
+    }
+    if (side == BUY) {
+        bid_count_ += loaded;
+    } else {
+        ask_count_ += loaded;
+    }
+    total_orders_ += loaded;
+    total_orders_processed_ += loaded;
+}
+
+std::vector<OrderBook::Level> PriceLadderOrderBook::get_bid_levels(size_t max_levels) const {
+    std::vector<Level> levels;
+    levels.reserve(max_levels);
+    collect_levels(bids_, levels, max_levels, true);
+    return levels;
+}
+
+std::vector<OrderBook::Level> PriceLadderOrderBook::get_ask_levels(size_t max_levels) const {
+    std::vector<Level> levels;
+    levels.reserve(max_levels);
+    collect_levels(asks_, levels, max_levels, false);
+    return levels;
+}
+
+size_t PriceLadderOrderBook::get_level_count(Side side) const {
+    return side == BUY ? bids_.level_count : asks_.level_count;
+}
+
+size_t PriceLadderOrderBook::get_window_size(Side side) const {
+    return side == BUY ? bids_.levels.size() : asks_.levels.size();
+}
+
+Price PriceLadderOrderBook::get_window_base(Side side) const {
+    return side == BUY ? bids_.base : asks_.base;
+}
+
+// Ladder helper methods
+PriceLevel* PriceLadderOrderBook::level_for_insert(Ladder& ladder, Price price) {
+    if (!ensure_window(ladder, price)) {
+        return nullptr;
+    }
+
+    size_t slot = size_t(price - ladder.base);
+    PriceLevel* level = &ladder.levels[slot];
+    if (level->empty()) {
+        level->price = price;
+        ladder.occupied.set(slot);
+        ++ladder.level_count;
+    }
+    return level;
+}
+
+void PriceLadderOrderBook::remove_level_if_empty(Ladder& ladder, PriceLevel* level) {
+    if (!level->empty()) {
+        return;
+    }
+    ladder.occupied.clear(size_t(level->price - ladder.base));
+    --ladder.level_count;
+}
+
+// makes sure price maps to a slot, moving the window if needed
+bool PriceLadderOrderBook::ensure_window(Ladder& ladder, Price price) {
+    if (ladder.contains(price)) {
+        return true;
+    }
+    if (!window_can_hold(price)) {
+        return false;
+    }
+
+    // nothing resting - just center a fresh window on the new price
+    if (ladder.level_count == 0) {
+        size_t size = std::max(ladder.levels.size(), window_ticks_);
+        if (ladder.levels.size() != size) {
+            std::vector<PriceLevel>(size).swap(ladder.levels);
+            ladder.occupied.reset(size);
+        }
+        ladder.base = price - Price(size / 2);
+        return true;
+    }
+
+    // cover the resting range plus the new price. The distance is taken
+    // unsigned, since high - low can overflow Price
+    Price low = std::min(price, ladder.base + Price(ladder.occupied.find_first()));
+    Price high = std::max(price, ladder.base + Price(ladder.occupied.find_last()));
+    uint64_t distance = uint64_t(high) - uint64_t(low);
+    size_t size = window_size_for(ladder.levels.size(), distance);
+    if (size == 0) {
+        return false;
+    }
+    size_t span = size_t(distance) + 1;
+    relocate(ladder, low - Price((size - span) / 2), size);
+    return true;
+}
+
+// a window has to fit inside Price on both sides of the price, so the
+// last max_window_ticks_ at either end of the range are refused
+bool PriceLadderOrderBook::window_can_hold(Price price) const {
+    return price >= std::numeric_limits<Price>::min() + Price(max_window_ticks_) &&
+           price <= std::numeric_limits<Price>::max() - Price(max_window_ticks_);
+}
+
+// window size for a range distance ticks wide with at least as much slack
+// again, doubling from size until it fits; 0 past the cap. The distance
+// is checked before the doubling, which would otherwise wrap around and
+// never end
+size_t PriceLadderOrderBook::window_size_for(size_t size, uint64_t distance) const {
+    if (distance >= max_window_ticks_ / 2) {
+        return 0;
+    }
+    size_t span = size_t(distance) + 1;
+    while (size < 2 * span) {
+        size *= 2;
+    }
+    return size <= max_window_ticks_ ? size : 0;
+}
+
+void PriceLadderOrderBook::relocate(Ladder& ladder, Price new_base, size_t new_size) {
+    std::vector<PriceLevel> levels(new_size);
+    OccupancyBitmap occupied(new_size);
+
+    // move each live queue to its new slot (re-pointing its orders)
+    for (size_t slot = ladder.occupied.find_first(); slot != OccupancyBitmap::npos;
+         slot = ladder.occupied.find_next(slot + 1)) {
+        PriceLevel& from = ladder.levels[slot];
+        size_t new_slot = size_t(from.price - new_base);
+        levels[new_slot].take_from(from);
+        occupied.set(new_slot);
+    }
+
+    ladder.levels.swap(levels);
+    ladder.occupied = std::move(occupied);
+    ladder.base = new_base;
+}
+
+PriceLevel* PriceLadderOrderBook::best_level(const Ladder& ladder, bool highest) const {
+    size_t slot = highest ? ladder.occupied.find_last() : ladder.occupied.find_first();
+    if (slot == OccupancyBitmap::npos) {
+        return nullptr;
+    }
+    return const_cast<PriceLevel*>(&ladder.levels[slot]);
+}
+
+void PriceLadderOrderBook::collect_levels(const Ladder& ladder, std::vector<Level>& levels,
+                                          size_t max_levels, bool highest_first) const {
+    size_t slot = highest_first ? ladder.occupied.find_last() : ladder.occupied.find_first();
+    size_t count = 0;
+
+    while (slot != OccupancyBitmap::npos && count < max_levels) {
+        const PriceLevel& priceLvl = ladder.levels[slot];
+        levels.emplace_back(priceLvl.price, priceLvl.total_quantity, priceLvl.order_count);
+        count++;
+
+        // step to the next occupied tick
+        if (highest_first) {
+            slot = slot == 0 ? OccupancyBitmap::npos : ladder.occupied.find_prev(slot - 1);
+        } else {
+            slot = ladder.occupied.find_next(slot + 1);
+        }
+    }
+}
+
+bool PriceLadderOrderBook::check_invariants() const {
+    size_t resting = 0;
+    for (const Ladder* ladder : {&bids_, &asks_}) {
+        size_t live = 0;
+        for (size_t slot = 0; slot < ladder->levels.size(); ++slot) {
+            const PriceLevel& level = ladder->levels[slot];
+            if (ladder->occupied.test(slot) == level.empty()) {
+                return false;
+            }
+            if (level.empty()) {
+                continue;
+            }
+            if (level.price != ladder->base + Price(slot)) {
+                return false;
+            }
+            Quantity qty = 0;
+            size_t count = 0;
+            for (const Order* order = level.front(); order; order = order->get_next_in_level()) {
+                if (order->get_level() != &level || order->get_price() != level.price) {
+                    return false;
+                }
+                qty += order->get_remaining_quantity();
+                ++count;
+            }
+            if (qty != level.total_quantity || count != level.order_count) {
+                return false;
+            }
+            resting += count;
+            ++live;
+        }
+        if (live != ladder->level_count) {
+            return false;
+        }
+    }
+    return resting == bid_count_ + ask_count_ && resting == orders_.size();
+}
+
+} // namespace order_matching
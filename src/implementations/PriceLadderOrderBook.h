@@ -0,0 +1,301 @@
+#pragma once
+
+#include "../core/OrderBook.h"
+#include "../core/PriceLevel.h"
+#include "../utils/FlatIdMap.h"
+#include "../utils/ObjectPool.h"
+#include "../utils/OccupancyBitmap.h"
+#include <algorithm>
+#include <memory>
+
+namespace order_matching {
+
+// Order book for instruments that trade inside a bounded band of ticks.
+// Each side is a dense array of price levels indexed by tick offset from a
+// window base, with an occupancy bitmap so the best price and the next
+// non-empty level are found with find-first-set instead of a search.
+// The window recenters (or doubles) when a price falls outside it, up to
+// max_window_ticks per side; prices further out are refused.
+class PriceLadderOrderBook : public OrderBook {
+public:
+    // Default cap on a side's window: 64K levels, a few MB per side
+    static constexpr size_t DEFAULT_MAX_WINDOW_TICKS = size_t(1) << 16;
+
+    PriceLadderOrderBook(const Instrument& instrument, size_t window_ticks = 4096,
+                         size_t max_window_ticks = DEFAULT_MAX_WINDOW_TICKS);
+    PriceLadderOrderBook(const std::string& symbol, size_t window_ticks = 4096,
+                         size_t max_window_ticks = DEFAULT_MAX_WINDOW_TICKS)
+        : PriceLadderOrderBook(Instrument(symbol), window_ticks, max_window_ticks) {}
+    ~PriceLadderOrderBook();
+
+    // OrderBook interface
+    using OrderBook::add_order;
+    using OrderBook::match_orders;
+    bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity) override;
+    bool add_order(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                   ExecutionRing& executions) override;
+    bool cancel_order(Order::OrderId order_id) override;
+    using OrderBook::modify_order;
+    const Order* modify_order(Order::OrderId order_id, Price price, Quantity quantity) override;
+    bool modify_order(Order::OrderId order_id, Price price, Quantity quantity, ExecutionRing& executions) override;
+    size_t add_orders(const OrderMessage* orders, size_t count) override;
+    void match_orders(ExecutionRing& executions) override;
+
+    // Inlinable sink variants, see BTreeOrderBook
+    template <typename Sink>
+    bool add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity, OrderType type,
+                        Sink&& sink);
+    template <typename Sink>
+    bool add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity, Sink&& sink) {
+        return add_order_with(id, side, price, quantity, LIMIT, sink);
+    }
+    template <typename Sink>
+    bool modify_order_with(Order::OrderId order_id, Price price, Quantity quantity, Sink&& sink);
+    template <typename Sink>
+    void match_orders_with(Sink&& sink);
+    const Order* find_order(Order::OrderId order_id) const override;
+    void reserve(size_t orders) override;
+
+    // load_orders sizes each window for the side's whole price range up
+    // front, then queues the orders straight into their slots. A side
+    // whose range the window cap cannot cover is refused, as on add, and
+    // then nothing is loaded
+    void export_orders(std::vector<SnapshotOrder>& orders) const override;
+    bool load_orders(const SnapshotOrder* orders, size_t count) override;
+    bool is_loadable(const SnapshotOrder* orders, size_t count) const override;
+
+    Price get_best_bid() const override;
+    Price get_best_ask() const override;
+    Quantity get_best_bid_size() const override;
+    Quantity get_best_ask_size() const override;
+    size_t get_bid_count() const override;
+    size_t get_ask_count() const override;
+    size_t get_total_orders() const override;
+
+    std::vector<Level> get_bid_levels(size_t max_levels = 10) const override;
+    std::vector<Level> get_ask_levels(size_t max_levels = 10) const override;
+
+    // Walks the occupied levels from the best price, so the cost is the
+    // number of live levels inside limit
+    Quantity get_available_quantity(Side side, Price limit) const override;
+
+    // Ladder shape - live price levels and current window of one side
+    size_t get_level_count(Side side) const;
+    size_t get_window_size(Side side) const;
+    Price get_window_base(Side side) const;
+    // Widest window a side may grow to; orders further out are refused
+    size_t get_max_window_ticks() const { return max_window_ticks_; }
+
+    // Verifies bitmap, level and order bookkeeping agree
+    bool check_invariants() const;
+
+private:
+    struct Ladder {
+        Price base = 0;                   // Price of slot 0
+        std::vector<PriceLevel> levels;   // One level per tick in the window
+        utils::OccupancyBitmap occupied;  // Slots with resting orders
+        size_t level_count = 0;
+
+        bool contains(Price price) const {
+            return price >= base && price - base < Price(levels.size());
+        }
+    };
+
+    // Member variables
+    const size_t window_ticks_;     // Initial window width per side
+    const size_t max_window_ticks_; // Cap on a side's window width
+
+    Ladder bids_;
+    Ladder asks_;
+
+    // Order slab and id index, see BTreeOrderBook. Levels already live in
+    // the ladder arrays
+    utils::ObjectPool<Order> order_pool_;
+    utils::FlatIdMap<Order> orders_;
+
+    // Metrics
+    size_t bid_count_;
+    size_t ask_count_;
+    size_t total_orders_;                // Current active orders
+    size_t total_orders_processed_;      // Cumulative total
+    size_t total_trades_;
+
+    // Ladder operations
+    PriceLevel* level_for_insert(Ladder& ladder, Price price);
+    void remove_level_if_empty(Ladder& ladder, PriceLevel* level);
+    void release_order(Order* order);
+    bool rest_order(Order::OrderId id, Side side, Price price, Quantity quantity);
+    void fill_resting(Ladder& ladder, PriceLevel* level, Order* order, Quantity quantity);
+    void publish_top() { publish_top_of_book(best_level(bids_, true), best_level(asks_, false)); }
+    template <typename Sink>
+    Quantity match_incoming(Order::OrderId id, Side side, Price price, Quantity quantity, Sink& sink);
+    bool ensure_window(Ladder& ladder, Price price);
+    bool window_can_hold(Price price) const;
+    size_t window_size_for(size_t size, uint64_t distance) const;
+    bool side_fits(const SnapshotOrder* orders, size_t count) const;
+    void relocate(Ladder& ladder, Price new_base, size_t new_size);
+    void load_side(Ladder& ladder, Side side, const SnapshotOrder* orders, size_t count);
+
+    // Helper functions
+    PriceLevel* best_level(const Ladder& ladder, bool highest) const;
+    void collect_levels(const Ladder& ladder, std::vector<Level>& levels, size_t max_levels, bool highest_first) const;
+};
+
+// Continuous matching and order types, see BTreeOrderBook. A limit order
+// is refused before it trades if its price cannot fit its side's window,
+// so a remainder always has a slot to rest in
+template <typename Sink>
+bool PriceLadderOrderBook::add_order_with(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                          OrderType type, Sink&& sink) {
+    if (quantity <= 0 || orders_.find(id) != nullptr) {
+        return false;
+    }
+    if (type == MARKET) {
+        price = marketable_limit(side);
+    }
+    if (type == FOK && get_available_quantity(side == BUY ? SELL : BUY, price) < quantity) {
+        return false;
+    }
+    if (type == LIMIT && !ensure_window(side == BUY ? bids_ : asks_, price)) {
+        return false;
+    }
+    Quantity remaining = match_incoming(id, side, price, quantity, sink);
+    if (remaining > 0 && (type != LIMIT || !rest_order(id, side, price, remaining)) && remaining == quantity) {
+        return false;
+    }
+    ++total_orders_processed_;
+    publish_top();
+    return true;
+}
+
+// walks the opposite ladder from its best level while it crosses the limit
+// price; trades print at the resting price. Returns the unfilled quantity
+template <typename Sink>
+Quantity PriceLadderOrderBook::match_incoming(Order::OrderId id, Side side, Price price, Quantity quantity,
+                                              Sink& sink) {
+    Ladder& contra = side == BUY ? asks_ : bids_;
+
+    while (quantity > 0) {
+        PriceLevel* level = best_level(contra, side == SELL);
+        if (!level || (side == BUY ? level->price > price : level->price < price)) {
+            break;
+        }
+
+        Order* resting = level->front();
+        Quantity trade_qty = std::min(quantity, resting->get_remaining_quantity());
+        Execution::TradeId trade_id = generate_trade_id();
+        sink(Execution{
+            trade_id,
+            side == BUY ? id : resting->get_order_id(),
+            side == BUY ? resting->get_order_id() : id,
+            level->price,
+            trade_qty,
+            symbol_id_
+        });
+
+        quantity -= trade_qty;
+        record_trade(level->price, trade_qty);
+        order_event(OrderEventType::EXECUTE, resting, level->price, trade_qty, trade_id);
+        fill_resting(contra, level, resting, trade_qty);
+        ++total_trades_;
+    }
+    return quantity;
+}
+
+// Crossing amends, see BTreeOrderBook. The window is moved first, as in
+// modify_order, so a price the remainder could not rest at refuses the
+// amend with the order untouched
+template <typename Sink>
+bool PriceLadderOrderBook::modify_order_with(Order::OrderId order_id, Price price, Quantity quantity,
+                                             Sink&& sink) {
+    Order* order = orders_.find(order_id);
+    if (order == nullptr || quantity <= 0) {
+        return false;
+    }
+    Side side = order->get_side();
+    const PriceLevel* contra = best_level(side == BUY ? asks_ : bids_, side == SELL);
+    bool keeps_priority = price == order->get_price() && quantity <= order->get_remaining_quantity();
+    if (keeps_priority || contra == nullptr || (side == BUY ? contra->price > price : contra->price < price)) {
+        return modify_order(order_id, price, quantity) != nullptr;
+    }
+
+    Ladder& ladder = side == BUY ? bids_ : asks_;
+    if (!ensure_window(ladder, price)) {
+        return false;
+    }
+    PriceLevel* level = order->get_level();
+    level->erase(order);
+    level_changed(side, level);
+    remove_level_if_empty(ladder, level);
+    order->amend(price, quantity);
+    order_event(OrderEventType::AMEND, order, price, quantity);
+
+    auto fill_amended = [this, order, &sink](const Execution& execution) {
+        sink(execution);
+        order->set_remaining_quantity(order->get_remaining_quantity() - execution.quantity);
+        order_event(OrderEventType::EXECUTE, order, execution.price, execution.quantity, execution.trade_id);
+    };
+    if (match_incoming(order_id, side, price, quantity, fill_amended) > 0) {
+        level = level_for_insert(ladder, price);
+        level->push_back(order);
+        level_changed(side, level);
+    } else {
+        if (side == BUY) {
+            --bid_count_;
+        } else {
+            --ask_count_;
+        }
+        --total_orders_;
+        release_order(order);
+    }
+    publish_top();
+    return true;
+}
+
+template <typename Sink>
+void PriceLadderOrderBook::match_orders_with(Sink&& sink) {
+    size_t trades_before = total_trades_;
+    while (true) {
+        // best levels are one bit scan away
+        PriceLevel* bid_level = best_level(bids_, true);
+        PriceLevel* ask_level = best_level(asks_, false);
+
+        // check if prices cross
+        if (!bid_level || !ask_level || bid_level->price < ask_level->price) {
+            break;
+        }
+
+        // match orders at these levels
+        Order* buy_order = bid_level->front();
+        Order* sell_order = ask_level->front();
+
+        // determine trade quantity
+        Quantity trade_qty = std::min(buy_order->get_remaining_quantity(), sell_order->get_remaining_quantity());
+
+        // report the fill - using ask price
+        Execution::TradeId trade_id = generate_trade_id();
+        sink(Execution{
+            trade_id,
+            buy_order->get_order_id(),
+            sell_order->get_order_id(),
+            ask_level->price,
+            trade_qty,
+            symbol_id_
+        });
+
+        // update quantities, filled orders leave
+        record_trade(ask_level->price, trade_qty);
+        order_event(OrderEventType::EXECUTE, buy_order, ask_level->price, trade_qty, trade_id);
+        order_event(OrderEventType::EXECUTE, sell_order, ask_level->price, trade_qty, trade_id);
+        fill_resting(bids_, bid_level, buy_order, trade_qty);
+        fill_resting(asks_, ask_level, sell_order, trade_qty);
+
+        // increment total trades
+        ++total_trades_;
+    }
+    if (total_trades_ != trades_before) {
+        publish_top();
+    }
+}
+
+} // namespace order_matching
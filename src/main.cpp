@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <thread>
 #include <chrono>
 #include <random>
@@ -7,86 +6,74 @@
 #include <iomanip>
 #include <sstream>
 
+#include "core/DepthPublisher.h"
 #include "core/MatchingEngine.h"
+#include "core/PushServer.h"
 #include "implementations/BTreeOrderBook.h"
 
 namespace fs = std::filesystem;
 using namespace order_matching;
 
-// write order book data to JSON
-void writeOrderBookToJson(MatchingEngine& engine, const std::string& symbol) {
+// push the book to the visualizer as JSON; the levels come from the depth
+// feed's copy of the book rather than a walk of the book itself
+void publishOrderBook(MatchingEngine& engine, const std::string& symbol, const DepthBook& depth, PushServer& server) {
     // Get the order book
-    auto* book = dynamic_cast<BTreeOrderBook*>(engine.get_order_book(symbol));
+    auto* book = dynamic_cast<BTreeOrderBook<>*>(engine.get_order_book(symbol));
     if (!book) return;
+    const Instrument& instrument = book->get_instrument();
 
     // Build JSON string
     std::stringstream json;
     json << std::fixed << std::setprecision(2);
-    json << "{\n";
+    json << "{";
 
     // Basic info
-    json << "  \"symbol\": \"" << symbol << "\",\n";
-    json << "  \"bestBid\": " << engine.get_best_bid(symbol) << ",\n";
-    json << "  \"bestAsk\": " << engine.get_best_ask(symbol) << ",\n";
+    json << "\"symbol\": \"" << symbol << "\", ";
+    json << "\"bestBid\": " << instrument.to_price(engine.get_best_bid(symbol)) << ", ";
+    json << "\"bestAsk\": " << instrument.to_price(engine.get_best_ask(symbol)) << ", ";
 
     // Get bid levels (top 10)
-    json << "  \"bids\": [\n";
-    auto bids = book->get_bid_levels(10);
+    json << "\"bids\": [";
+    auto bids = depth.get_bid_levels(10);
     for (size_t i = 0; i < bids.size(); i++) {
-        json << "    {\"price\": " << bids[i].price
-             << ", \"quantity\": " << bids[i].quantity << "}";
-        if (i < bids.size() - 1) json << ",";
-        json << "\n";
+        json << "{\"price\": " << instrument.to_price(bids[i].price)
+             << ", \"quantity\": " << instrument.to_quantity(bids[i].quantity) << "}";
+        if (i < bids.size() - 1) json << ", ";
     }
-    json << "  ],\n";
+    json << "], ";
 
     // Get ask levels (top 10)
-    json << "  \"asks\": [\n";
-    auto asks = book->get_ask_levels(10);
+    json << "\"asks\": [";
+    auto asks = depth.get_ask_levels(10);
     for (size_t i = 0; i < asks.size(); i++) {
-        json << "    {\"price\": " << asks[i].price
-             << ", \"quantity\": " << asks[i].quantity << "}";
-        if (i < asks.size() - 1) json << ",";
-        json << "\n";
+        json << "{\"price\": " << instrument.to_price(asks[i].price)
+             << ", \"quantity\": " << instrument.to_quantity(asks[i].quantity) << "}";
+        if (i < asks.size() - 1) json << ", ";
     }
-    json << "  ],\n";
+    json << "], ";
 
     // Add stats for visualization
-    json << "  \"stats\": {\n";
-    json << "    \"totalOrders\": " << book->get_total_orders() << ",\n";
-    json << "    \"bidCount\": " << book->get_bid_count() << ",\n";
-    json << "    \"askCount\": " << book->get_ask_count() << ",\n";
-    json << "    \"activeOrders\": " << (book->get_bid_count() + book->get_ask_count()) << "\n";
-    json << "  }\n";
+    json << "\"stats\": {";
+    json << "\"totalOrders\": " << book->get_total_orders() << ", ";
+    json << "\"bidCount\": " << book->get_bid_count() << ", ";
+    json << "\"askCount\": " << book->get_ask_count() << ", ";
+    json << "\"activeOrders\": " << (book->get_bid_count() + book->get_ask_count());
+    json << "}";
 
-    json << "}\n";
-
-    // Write to file
-
-    fs::path dataPath;
+    json << "}";
 
+    // one event to every connected browser
+    server.publish(json.str());
+}
 
+// the page ships in visualization/, next to the build directory when run
+// from an IDE build folder
+fs::path visualizationPath() {
     fs::path currentPath = fs::current_path();
     if (currentPath.filename().string().find("cmake-build") == 0) {
-
-        dataPath = currentPath.parent_path() / "visualization" / "data";
-    } else {
-
-        dataPath = currentPath / "visualization" / "data";
-    }
-
-    // Create directory if needed
-    fs::create_directories(dataPath);
-
-    // Write the file
-    fs::path jsonFile = dataPath / "orderbook.json";
-    std::ofstream file(jsonFile);
-    if (file.is_open()) {
-        file << json.str();
-        file.close();
-    } else {
-        std::cerr << "ERROR: Could not write to " << jsonFile << std::endl;
+        return currentPath.parent_path() / "visualization";
     }
+    return currentPath / "visualization";
 }
 
 int main() {
@@ -98,7 +85,22 @@ int main() {
 
     // Create the matching engine
     MatchingEngine engine;
-    engine.create_order_book("AAPL", std::make_unique<BTreeOrderBook>("AAPL"));
+    Instrument aapl("AAPL", 0.01, 1.0);  // cent ticks, single-share lots
+    SymbolId aaplId = engine.create_order_book("AAPL", std::make_unique<BTreeOrderBook<>>(aapl));
+
+    // incremental depth feed of the book, applied to the copy the JSON is
+    // written from
+    DepthPublisher publisher;
+    DepthBook depth;
+    publisher.set_update_handler([&depth](const DepthUpdate& update) { depth.apply(update); });
+    publisher.set_snapshot_handler([&depth](const DepthSnapshot& snapshot) { depth.apply(snapshot); });
+    publisher.add_book(engine.get_order_book(aaplId));
+
+    // serves the page and pushes each change to it on localhost:8080
+    PushServer server(8080, (visualizationPath() / "index.html").string());
+    if (!server.start()) {
+        std::cerr << "ERROR: Could not listen on localhost:8080\n";
+    }
 
     // Random number generator
     std::random_device rd;
@@ -117,29 +119,24 @@ int main() {
     // Add buy orders (bids) - these should be BELOW mid price
     for (int i = 0; i < 10; i++) {
         double price = midPrice - spreadSize - (i * 0.05);  // Start at 149.90, decrease by 5 cents
-        auto buyOrder = std::make_shared<Order>(
-            orderId++, BUY, price, qty_dist(gen), "AAPL"
-        );
-        engine.submit_order(buyOrder);
+        engine.submit_order(aaplId, orderId++, BUY, aapl.to_ticks(price), qty_dist(gen));
     }
 
     // Add sell orders (asks) - these should be ABOVE mid price
     for (int i = 0; i < 10; i++) {
         double price = midPrice + spreadSize + (i * 0.05);  // Start at 150.10, increase by 5 cents
-        auto sellOrder = std::make_shared<Order>(
-            orderId++, SELL, price, qty_dist(gen), "AAPL"
-        );
-        engine.submit_order(sellOrder);
+        engine.submit_order(aaplId, orderId++, SELL, aapl.to_ticks(price), qty_dist(gen));
     }
 
     std::cout << "Initial orders added.\n";
-    std::cout << "Best Bid: $" << engine.get_best_bid("AAPL") << "\n";
-    std::cout << "Best Ask: $" << engine.get_best_ask("AAPL") << "\n";
+    std::cout << "Best Bid: $" << aapl.to_price(engine.get_best_bid("AAPL")) << "\n";
+    std::cout << "Best Ask: $" << aapl.to_price(engine.get_best_ask("AAPL")) << "\n";
     std::cout << "Starting continuous updates...\n";
-    std::cout << "Open http://localhost:8080 in your browser\n\n";
+    std::cout << "Open http://localhost:" << server.get_port() << " in your browser\n\n";
 
-    // Write initial state
-    writeOrderBookToJson(engine, "AAPL");
+    // Push initial state
+    publisher.publish();
+    publishOrderBook(engine, "AAPL", depth, server);
 
     // Main loop - run for 60 seconds
     auto startTime = std::chrono::steady_clock::now();
@@ -163,11 +160,10 @@ int main() {
                 price = basePrice + variation;
             }
 
-            price = std::round(price * 100) / 100;  // Round to cents
-            int quantity = qty_dist(gen);
+            // snap to the tick grid once, at order entry
+            Quantity quantity = qty_dist(gen);
 
-            auto order = std::make_shared<Order>(orderId++, side, price, quantity, "AAPL");
-            engine.submit_order(order);
+            engine.submit_order(aaplId, orderId++, side, aapl.to_ticks(price), quantity);
         }
 
         // Occasionally add an aggressive order that might match
@@ -183,17 +179,15 @@ int main() {
                 price = midPrice - std::uniform_real_distribution<>(-0.05, 0.15)(gen);
             }
 
-            price = std::round(price * 100) / 100;
-            auto order = std::make_shared<Order>(orderId++, side, price, qty_dist(gen), "AAPL");
-            engine.submit_order(order);
+            engine.submit_order(aaplId, orderId++, side, aapl.to_ticks(price), qty_dist(gen));
         }
 
         // Try to match orders
-        auto trades = engine.match_orders("AAPL");
+        auto trades = engine.match_orders(aaplId);
         if (!trades.empty()) {
             std::cout << "Matched " << trades.size() << " trades at ";
             for (const auto& trade : trades) {
-                std::cout << "$" << trade.get_price() << " ";
+                std::cout << "$" << aapl.to_price(trade.get_price()) << " ";
             }
             std::cout << "\n";
         }
@@ -202,8 +196,10 @@ int main() {
         midPrice += std::uniform_real_distribution<>(-0.02, 0.02)(gen);
         midPrice = std::max(145.0, std::min(155.0, midPrice)); // Keep in reasonable range
 
-        // Write current state to JSON
-        writeOrderBookToJson(engine, "AAPL");
+        // Push current state, only if a level changed
+        if (publisher.publish() > 0) {
+            publishOrderBook(engine, "AAPL", depth, server);
+        }
 
         // Show progress
         updateCount++;
@@ -213,9 +209,9 @@ int main() {
         if (updateCount % 5 == 0) {  // Print stats every 5 updates
             std::cout << "\r[" << elapsed << "s] Orders: " << orderId - 1
                       << " | Best Bid: $" << std::fixed << std::setprecision(2)
-                      << engine.get_best_bid("AAPL")
-                      << " | Best Ask: $" << engine.get_best_ask("AAPL")
-                      << " | Spread: $" << (engine.get_best_ask("AAPL") - engine.get_best_bid("AAPL"))
+                      << aapl.to_price(engine.get_best_bid("AAPL"))
+                      << " | Best Ask: $" << aapl.to_price(engine.get_best_ask("AAPL"))
+                      << " | Spread: $" << aapl.to_price(engine.get_best_ask("AAPL") - engine.get_best_bid("AAPL"))
                       << "   " << std::flush;
         }
 
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/MatchingEngine.h"
+#include "core/OrderFile.h"
+
+using namespace order_matching;
+
+//
+// Replays a recorded order flow through MatchingEngine. A CSV from
+// data/synthetic_generator.py or data/binance_downloader.py is converted to
+// the fixed-width order file format once (next to it, .bin), then the
+// binary file is mapped and every order is submitted in continuous mode -
+// back to back, or at the recorded timestamps with --paced.
+//
+// Latency is the time spent in submit_order for one order, fills included.
+// A symbol's orders/s and trades/s are over the time spent in its own
+// submit_order calls, so each row is that book's rate on its own; the
+// elapsed line gives the rate of the run as a whole.
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct SymbolStats {
+    size_t orders = 0;
+    size_t rejected = 0;
+    size_t trades = 0;
+    uint64_t busy_ns = 0;               // sum of latencies
+    std::vector<uint64_t> latencies;    // ns, one per order
+};
+
+static void usage() {
+    std::cerr << "usage: replay <orders.csv | orders.bin> [options]\n"
+              << "  --paced          submit at the recorded timestamps instead of back to back\n"
+              << "  --speed X        with --paced, play X times faster than recorded (default 1)\n"
+              << "  --tick T         tick size when converting a CSV (default 0.01)\n"
+              << "  --lot L          lot size when converting a CSV (default 1)\n"
+              << "  --out PATH       where to write the converted file (default: input with .bin)\n"
+              << "  --ladder         use PriceLadderOrderBook instead of BTreeOrderBook\n";
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// waits until the monotonic clock reaches deadline: sleeps while it is far
+// off, spins for the last stretch so pacing stays within a microsecond
+static void wait_until(uint64_t deadline) {
+    const uint64_t spin_ns = 200000;
+    uint64_t now = now_ns();
+    if (deadline > now + spin_ns) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now - spin_ns));
+    }
+    while (now_ns() < deadline) {
+    }
+}
+
+static void print_row(const std::string& name, const SymbolStats& stats) {
+    double seconds = std::max(1e-9, stats.busy_ns / 1e9);
+    std::vector<uint64_t> l = stats.latencies;
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0 : l[std::min(l.size() - 1, size_t(p * l.size()))]; };
+    std::cout << "  " << std::left << std::setw(12) << name << std::right
+              << std::setw(10) << stats.orders << std::setw(10) << stats.trades
+              << std::fixed << std::setprecision(0)
+              << std::setw(12) << stats.orders / seconds << std::setw(12) << stats.trades / seconds
+              << std::setw(8) << pct(0.50) << std::setw(8) << pct(0.90) << std::setw(8) << pct(0.99)
+              << std::setw(8) << pct(0.999) << std::setw(10) << (l.empty() ? 0 : l.back()) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    std::string out;
+    bool paced = false;
+    double speed = 1.0;
+    double tick_size = 0.01;
+    double lot_size = 1.0;
+    OrderBookType book_type = OrderBookType::BTREE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--paced") {
+            paced = true;
+        } else if (arg == "--speed" && has_value) {
+            speed = std::atof(argv[++i]);
+        } else if (arg == "--tick" && has_value) {
+            tick_size = std::atof(argv[++i]);
+        } else if (arg == "--lot" && has_value) {
+            lot_size = std::atof(argv[++i]);
+        } else if (arg == "--out" && has_value) {
+            out = argv[++i];
+        } else if (arg == "--ladder") {
+            book_type = OrderBookType::PRICE_LADDER;
+        } else if (input.empty() && arg.compare(0, 2, "--") != 0) {
+            input = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (input.empty() || speed <= 0 || tick_size <= 0 || lot_size <= 0) {
+        usage();
+        return 1;
+    }
+
+    // CSV in: convert once, replay the binary file
+    std::string path = input;
+    if (ends_with(input, ".csv")) {
+        path = out.empty() ? input.substr(0, input.size() - 4) + ".bin" : out;
+        size_t skipped = 0;
+        auto begin = now_ns();
+        if (!convert_order_csv(input, path, tick_size, lot_size, &skipped)) {
+            std::cerr << "ERROR: could not convert " << input << std::endl;
+            return 1;
+        }
+        std::cout << "Converted " << input << " -> " << path << " in " << (now_ns() - begin) / 1000000 << " ms";
+        if (skipped > 0) {
+            std::cout << " (" << skipped << " rows skipped)";
+        }
+        std::cout << std::endl;
+    }
+
+    OrderFile file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: " << path << " is not a readable order file" << std::endl;
+        return 1;
+    }
+
+    // one book per symbol in the file, sized for all of its orders
+    MatchingEngine engine;
+    std::vector<SymbolId> ids;
+    std::vector<SymbolStats> stats(file.symbols().size());
+    for (const std::string& name : file.symbols()) {
+        ids.push_back(engine.create_order_book(Instrument(name, file.tick_size(), file.lot_size()), book_type));
+    }
+    const OrderFileRecord* records = file.records();
+    size_t count = file.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (records[i].symbol < stats.size()) {
+            ++stats[records[i].symbol].orders;
+        }
+    }
+    for (size_t s = 0; s < stats.size(); ++s) {
+        engine.get_order_book(ids[s])->reserve(stats[s].orders);
+        stats[s].latencies.reserve(stats[s].orders);
+        stats[s].orders = 0;
+    }
+
+    std::cout << "Replaying " << count << " orders over " << stats.size() << " symbol"
+              << (stats.size() == 1 ? "" : "s") << (paced ? ", paced" : ", unpaced");
+    if (paced && speed != 1.0) {
+        std::cout << " at " << speed << "x";
+    }
+    std::cout << std::endl;
+
+    ExecutionRing executions(4096);
+    uint64_t first_timestamp = count > 0 ? records[0].timestamp_us : 0;
+    uint64_t begin = now_ns();
+    for (size_t i = 0; i < count; ++i) {
+        const OrderFileRecord& r = records[i];
+        if (r.symbol >= stats.size()) {
+            continue;
+        }
+        if (paced && r.timestamp_us > first_timestamp) {
+            wait_until(begin + uint64_t((r.timestamp_us - first_timestamp) * 1000.0 / speed));
+        }
+        SymbolStats& s = stats[r.symbol];
+        uint64_t start = now_ns();
+        bool accepted = engine.submit_order(ids[r.symbol], r.order_id, Side(r.side), r.price, r.quantity,
+                                            LIMIT, executions);
+        uint64_t latency = now_ns() - start;
+        s.latencies.push_back(latency);
+        s.busy_ns += latency;
+        ++s.orders;
+        s.rejected += !accepted;
+        s.trades += executions.size();
+        executions.clear();
+    }
+    double seconds = std::max(1e-9, (now_ns() - begin) / 1e9);
+
+    SymbolStats total;
+    for (const SymbolStats& s : stats) {
+        total.orders += s.orders;
+        total.rejected += s.rejected;
+        total.trades += s.trades;
+        total.busy_ns += s.busy_ns;
+        total.latencies.insert(total.latencies.end(), s.latencies.begin(), s.latencies.end());
+    }
+
+    std::cout << "\n  " << std::left << std::setw(12) << "symbol" << std::right
+              << std::setw(10) << "orders" << std::setw(10) << "trades"
+              << std::setw(12) << "orders/s" << std::setw(12) << "trades/s"
+              << std::setw(8) << "p50" << std::setw(8) << "p90" << std::setw(8) << "p99"
+              << std::setw(8) << "p99.9" << std::setw(10) << "max ns" << std::endl;
+    for (size_t s = 0; s < stats.size(); ++s) {
+        print_row(file.symbols()[s], stats[s]);
+    }
+    print_row("total", total);
+
+    std::cout << "\nElapsed " << std::fixed << std::setprecision(3) << seconds << " s, "
+              << std::setprecision(0) << total.orders / seconds << " orders/s";
+    if (total.rejected > 0) {
+        std::cout << ", " << total.rejected << " orders rejected";
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace order_matching {
+    namespace utils {
+
+        // Open-addressing hash map from 64-bit ids to object pointers (the
+        // order index). One flat table, linear probing and backward-shift
+        // deletion instead of tombstones, so lookups stay short under
+        // add/cancel churn and a table grown to the working set never
+        // allocates again. Values must be non-null - null marks an empty slot.
+        template <typename T>
+        class FlatIdMap {
+        private:
+            struct Entry {
+                uint64_t key;
+                T* value;
+            };
+
+            std::vector<Entry> table;
+            size_t count = 0;
+            size_t mask = 0;
+            int shift = 64;
+
+            // Fibonacci hashing - sequential ids spread across the table
+            size_t home(uint64_t key) const {
+                return size_t((key * 0x9E3779B97F4A7C15ull) >> shift);
+            }
+
+            void rehash(size_t capacity) {
+                std::vector<Entry> old;
+                old.swap(table);
+                table.assign(capacity, Entry{0, nullptr});
+                mask = capacity - 1;
+                shift = 64;
+                for (size_t c = capacity; c > 1; c >>= 1) {
+                    --shift;
+                }
+                count = 0;
+                for (const Entry& entry : old) {
+                    if (entry.value) {
+                        insert(entry.key, entry.value);
+                    }
+                }
+            }
+
+        public:
+            FlatIdMap() { rehash(16); }
+
+            // table sized for count entries at <= 50% load
+            void reserve(size_t entries) {
+                size_t capacity = table.size();
+                while (capacity < entries * 2) {
+                    capacity *= 2;
+                }
+                if (capacity != table.size()) {
+                    rehash(capacity);
+                }
+            }
+
+            T* find(uint64_t key) const {
+                for (size_t i = home(key);; i = (i + 1) & mask) {
+                    const Entry& entry = table[i];
+                    if (entry.value == nullptr || entry.key == key) {
+                        return entry.value;
+                    }
+                }
+            }
+
+            // false if the key is already present
+            bool insert(uint64_t key, T* value) {
+                if ((count + 1) * 2 > table.size()) {
+                    rehash(table.size() * 2);
+                }
+                size_t i = home(key);
+                for (; table[i].value != nullptr; i = (i + 1) & mask) {
+                    if (table[i].key == key) {
+                        return false;
+                    }
+                }
+                table[i] = Entry{key, value};
+                ++count;
+                return true;
+            }
+
+            // returns the removed value, nullptr if the key was not present
+            T* erase(uint64_t key) {
+                size_t hole = home(key);
+                for (; table[hole].key != key; hole = (hole + 1) & mask) {
+                    if (table[hole].value == nullptr) {
+                        return nullptr;
+                    }
+                }
+                T* removed = table[hole].value;
+                if (removed == nullptr) {
+                    return nullptr;
+                }
+
+                // pull later entries of the probe run back over the hole,
+                // unless that would move one before its home slot
+                for (size_t j = (hole + 1) & mask; table[j].value != nullptr; j = (j + 1) & mask) {
+                    size_t from_home = (j - home(table[j].key)) & mask;
+                    if (from_home >= ((j - hole) & mask)) {
+                        table[hole] = table[j];
+                        hole = j;
+                    }
+                }
+                table[hole].value = nullptr;
+                --count;
+                return removed;
+            }
+
+            template <typename F>
+            void for_each(F f) const {
+                for (const Entry& entry : table) {
+                    if (entry.value) {
+                        f(entry.value);
+                    }
+                }
+            }
+
+            size_t size() const { return count; }
+            size_t capacity() const { return table.size(); }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ORDER_MATCHING_KEY_SEARCH_AVX2 1
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define ORDER_MATCHING_KEY_SEARCH_SSE42 1
+#endif
+
+namespace order_matching {
+    namespace utils {
+
+        // Lower bound over the sorted int64 keys of one B-tree node. A node
+        // is at most a few cache lines, so instead of a branchy binary
+        // search every key is compared against the target with SIMD and the
+        // "less than" lanes are counted - for sorted keys that count is the
+        // lower bound. The instruction set is picked at build time
+        // (-mavx2 / -msse4.2 or -march=native), otherwise a scalar loop.
+
+        inline int mask_bits(int mask) {
+#ifdef _MSC_VER
+            return int(__popcnt(unsigned(mask)));
+#else
+            return __builtin_popcount(unsigned(mask));
+#endif
+        }
+
+        inline size_t lower_bound_scalar(const int64_t* keys, size_t n, int64_t key) {
+            size_t count = 0;
+            for (size_t i = 0; i < n; ++i) {
+                count += keys[i] < key;
+            }
+            return count;
+        }
+
+#if defined(ORDER_MATCHING_KEY_SEARCH_AVX2)
+        inline size_t lower_bound_simd(const int64_t* keys, size_t n, int64_t key) {
+            const __m256i target = _mm256_set1_epi64x(key);
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+                __m256i less = _mm256_cmpgt_epi64(target, block);
+                count += mask_bits(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+            }
+            return count + lower_bound_scalar(keys + i, n - i, key);
+        }
+
+        inline const char* key_search_isa() { return "AVX2"; }
+#elif defined(ORDER_MATCHING_KEY_SEARCH_SSE42)
+        inline size_t lower_bound_simd(const int64_t* keys, size_t n, int64_t key) {
+            const __m128i target = _mm_set1_epi64x(key);
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                __m128i less = _mm_cmpgt_epi64(target, block);
+                count += mask_bits(_mm_movemask_pd(_mm_castsi128_pd(less)));
+            }
+            return count + lower_bound_scalar(keys + i, n - i, key);
+        }
+
+        inline const char* key_search_isa() { return "SSE4.2"; }
+#else
+        inline size_t lower_bound_simd(const int64_t* keys, size_t n, int64_t key) {
+            return lower_bound_scalar(keys, n, key);
+        }
+
+        inline const char* key_search_isa() { return "scalar"; }
+#endif
+
+        // index of the first key >= key, n if there is none
+        inline size_t lower_bound_keys(const int64_t* keys, size_t n, int64_t key) {
+            return lower_bound_simd(keys, n, key);
+        }
+
+        // Same search over a compile-time number of slots, for nodes with
+        // fixed-size key arrays. Unused slots must hold a key greater than
+        // any probe (INT64_MAX); the constant trip count lets the compiler
+        // fully unroll the loop.
+        template <size_t N>
+        inline size_t lower_bound_fixed(const int64_t* keys, int64_t key) {
+            static_assert(N % 4 == 0, "key slots come in whole 256-bit blocks");
+#if defined(ORDER_MATCHING_KEY_SEARCH_AVX2)
+            const __m256i target = _mm256_set1_epi64x(key);
+            size_t count = 0;
+            for (size_t i = 0; i < N; i += 4) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+                __m256i less = _mm256_cmpgt_epi64(target, block);
+                count += mask_bits(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+            }
+            return count;
+#elif defined(ORDER_MATCHING_KEY_SEARCH_SSE42)
+            const __m128i target = _mm_set1_epi64x(key);
+            size_t count = 0;
+            for (size_t i = 0; i < N; i += 2) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                __m128i less = _mm_cmpgt_epi64(target, block);
+                count += mask_bits(_mm_movemask_pd(_mm_castsi128_pd(less)));
+            }
+            return count;
+#else
+            return lower_bound_scalar(keys, N, key);
+#endif
+        }
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ORDER_MATCHING_HAS_MMAP 1
+#endif
+
+namespace order_matching {
+    namespace utils {
+
+        // Read-only view of a whole file: memory-mapped where the platform
+        // has mmap, otherwise read into memory once. Pages of a mapping are
+        // only brought in when touched
+        class MappedFile {
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+            bool open_ = false;
+#ifdef ORDER_MATCHING_HAS_MMAP
+            void* mapping_ = nullptr;
+#else
+            std::vector<char> buffer_;
+#endif
+
+        public:
+            explicit MappedFile(const std::string& path) {
+#ifdef ORDER_MATCHING_HAS_MMAP
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat st;
+                if (::fstat(fd, &st) == 0) {
+                    size_ = size_t(st.st_size);
+                    open_ = true;
+                    if (size_ > 0) {
+                        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (p == MAP_FAILED) {
+                            open_ = false;
+                            size_ = 0;
+                        } else {
+                            mapping_ = p;
+                            data_ = static_cast<const char*>(p);
+                        }
+                    }
+                }
+                ::close(fd);
+#else
+                std::FILE* file = std::fopen(path.c_str(), "rb");
+                if (!file) {
+                    return;
+                }
+                char chunk[65536];
+                size_t n;
+                while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                    buffer_.insert(buffer_.end(), chunk, chunk + n);
+                }
+                std::fclose(file);
+                data_ = buffer_.data();
+                size_ = buffer_.size();
+                open_ = true;
+#endif
+            }
+
+            ~MappedFile() {
+#ifdef ORDER_MATCHING_HAS_MMAP
+                if (mapping_) {
+                    ::munmap(mapping_, size_);
+                }
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool is_open() const { return open_; }
+            const char* data() const { return data_; }
+            size_t size() const { return size_; }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "WaitStrategy.h"
+
+namespace order_matching {
+    namespace utils {
+
+        // Bounded lock-free queue for any number of producer threads and one
+        // consumer thread. Every slot carries a sequence number: a producer
+        // claims a position with one CAS on tail, writes the item, then
+        // publishes it by advancing the slot's sequence; the consumer reads
+        // slots in order while their sequence says they are filled, so it
+        // never touches tail. Slots are cache-line sized, so producers
+        // writing neighbouring slots do not share a line.
+        template <typename T>
+        class MpscQueue {
+        private:
+            struct alignas(CACHE_LINE) Slot {
+                std::atomic<size_t> sequence;   // == position: free, == position + 1: filled
+                T item;
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            size_t mask;
+
+            alignas(CACHE_LINE) std::atomic<size_t> tail{0};   // next position to claim, shared by producers
+            alignas(CACHE_LINE) std::atomic<size_t> head{0};   // next position to pop, written by the consumer
+
+        public:
+            explicit MpscQueue(size_t capacity = 65536) {
+                size_t size = 2;
+                while (size < capacity) {
+                    size <<= 1;
+                }
+                slots.reset(new Slot[size]);
+                for (size_t i = 0; i < size; ++i) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                mask = size - 1;
+            }
+
+            MpscQueue(const MpscQueue&) = delete;
+            MpscQueue& operator=(const MpscQueue&) = delete;
+
+            // producer side, any thread - false if the queue is full
+            bool try_push(const T& item) {
+                size_t pos = tail.load(std::memory_order_relaxed);
+                while (true) {
+                    Slot& slot = slots[pos & mask];
+                    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+                    if (diff == 0) {
+                        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            slot.item = item;
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false;   // the slot still holds the item from one lap ago
+                    } else {
+                        pos = tail.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // consumer side - copies up to max items to out, returns how many.
+            // Stops at the first claimed but not yet published slot, so items
+            // come out in claim order
+            size_t pop_batch(T* out, size_t max) {
+                size_t h = head.load(std::memory_order_relaxed);
+                size_t n = 0;
+                while (n < max) {
+                    Slot& slot = slots[(h + n) & mask];
+                    if (slot.sequence.load(std::memory_order_acquire) != h + n + 1) {
+                        break;
+                    }
+                    out[n] = slot.item;
+                    slot.sequence.store(h + n + mask + 1, std::memory_order_release);
+                    ++n;
+                }
+                if (n > 0) {
+                    head.store(h + n, std::memory_order_relaxed);
+                }
+                return n;
+            }
+
+            bool try_pop(T& item) {
+                return pop_batch(&item, 1) == 1;
+            }
+
+            // exact only when no side is running
+            size_t size() const {
+                return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+            }
+
+            bool empty() const { return size() == 0; }
+            size_t capacity() const { return mask + 1; }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace order_matching {
+    namespace utils {
+
+        // Slab allocator for a single object type. Objects are carved out of
+        // fixed-size slabs that are never moved or handed back to the system
+        // while the pool lives, so an object's address is a stable handle.
+        // Freed slots go on an intrusive free list and are reused LIFO (the
+        // most recently freed slot is still warm in cache), so once the pool
+        // has grown to the working set create/destroy never allocate.
+        //
+        // Objects still live when the pool is destroyed are not destructed;
+        // owners destroy the ones that need it first.
+        template <typename T, size_t SlabBytes = 64 * 1024>
+        class ObjectPool {
+        private:
+            union Slot {
+                Slot* next;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
+
+            static constexpr size_t SLOTS_PER_SLAB =
+                SlabBytes / sizeof(Slot) > 16 ? SlabBytes / sizeof(Slot) : 16;
+
+            std::vector<std::unique_ptr<Slot[]>> slabs;
+            Slot* free_list = nullptr;
+            size_t live = 0;
+
+            void grow() {
+                slabs.emplace_back(new Slot[SLOTS_PER_SLAB]);
+                Slot* slab = slabs.back().get();
+                // thread back to front so the slab is handed out in address order
+                for (size_t i = SLOTS_PER_SLAB; i-- > 0;) {
+                    slab[i].next = free_list;
+                    free_list = &slab[i];
+                }
+            }
+
+        public:
+            ObjectPool() = default;
+            ObjectPool(const ObjectPool&) = delete;
+            ObjectPool& operator=(const ObjectPool&) = delete;
+
+            template <typename... Args>
+            T* create(Args&&... args) {
+                if (free_list == nullptr) {
+                    grow();
+                }
+                Slot* slot = free_list;
+                free_list = slot->next;
+                ++live;
+                return new (slot->storage) T(std::forward<Args>(args)...);
+            }
+
+            void destroy(T* object) {
+                object->~T();
+                Slot* slot = reinterpret_cast<Slot*>(object);
+                slot->next = free_list;
+                free_list = slot;
+                --live;
+            }
+
+            // grow up front so the first count objects don't hit the allocator
+            void reserve(size_t count) {
+                while (capacity() < count) {
+                    grow();
+                }
+            }
+
+            size_t size() const { return live; }
+            size_t capacity() const { return slabs.size() * SLOTS_PER_SLAB; }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace order_matching {
+    namespace utils {
+
+        // Two-level occupancy bitmap: one bit per slot, plus a summary word
+        // with one bit per non-zero slot word. Finding the next occupied slot
+        // in either direction is a couple of find-first-set instructions
+        // instead of a scan over empty slots.
+        class OccupancyBitmap {
+        private:
+            std::vector<uint64_t> words;     // bit per slot
+            std::vector<uint64_t> summary;   // bit per non-zero entry in words
+            size_t slots;
+
+            static int lowest_bit(uint64_t x) {
+#ifdef _MSC_VER
+                unsigned long index;
+                _BitScanForward64(&index, x);
+                return int(index);
+#else
+                return __builtin_ctzll(x);
+#endif
+            }
+
+            static int highest_bit(uint64_t x) {
+#ifdef _MSC_VER
+                unsigned long index;
+                _BitScanReverse64(&index, x);
+                return int(index);
+#else
+                return 63 - __builtin_clzll(x);
+#endif
+            }
+
+            // lowest non-zero word index >= from, or npos
+            size_t next_word(size_t from) const {
+                size_t s = from >> 6;
+                if (s >= summary.size()) {
+                    return npos;
+                }
+                uint64_t bits = summary[s] & (~uint64_t(0) << (from & 63));
+                while (bits == 0) {
+                    if (++s >= summary.size()) {
+                        return npos;
+                    }
+                    bits = summary[s];
+                }
+                return (s << 6) + lowest_bit(bits);
+            }
+
+            // highest non-zero word index <= from, or npos
+            size_t prev_word(size_t from) const {
+                size_t s = from >> 6;
+                int bit = int(from & 63);
+                uint64_t bits = summary[s] & (bit == 63 ? ~uint64_t(0) : ((uint64_t(1) << (bit + 1)) - 1));
+                while (bits == 0) {
+                    if (s == 0) {
+                        return npos;
+                    }
+                    bits = summary[--s];
+                }
+                return (s << 6) + highest_bit(bits);
+            }
+
+        public:
+            static const size_t npos = ~size_t(0);
+
+            explicit OccupancyBitmap(size_t n = 0) {
+                reset(n);
+            }
+
+            // resize to n slots, all clear
+            void reset(size_t n) {
+                slots = n;
+                words.assign((n + 63) / 64, 0);
+                summary.assign((words.size() + 63) / 64, 0);
+            }
+
+            size_t size() const { return slots; }
+
+            bool test(size_t i) const {
+                return (words[i >> 6] >> (i & 63)) & 1;
+            }
+
+            void set(size_t i) {
+                size_t w = i >> 6;
+                words[w] |= uint64_t(1) << (i & 63);
+                summary[w >> 6] |= uint64_t(1) << (w & 63);
+            }
+
+            void clear(size_t i) {
+                size_t w = i >> 6;
+                words[w] &= ~(uint64_t(1) << (i & 63));
+                if (words[w] == 0) {
+                    summary[w >> 6] &= ~(uint64_t(1) << (w & 63));
+                }
+            }
+
+            // lowest set slot >= from, or npos
+            size_t find_next(size_t from) const {
+                if (from >= slots) {
+                    return npos;
+                }
+                size_t w = from >> 6;
+                uint64_t bits = words[w] & (~uint64_t(0) << (from & 63));
+                if (bits != 0) {
+                    return (w << 6) + lowest_bit(bits);
+                }
+                w = next_word(w + 1);
+                return w == npos ? npos : (w << 6) + lowest_bit(words[w]);
+            }
+
+            // highest set slot <= from, or npos
+            size_t find_prev(size_t from) const {
+                if (slots == 0) {
+                    return npos;
+                }
+                if (from >= slots) {
+                    from = slots - 1;
+                }
+                size_t w = from >> 6;
+                int bit = int(from & 63);
+                uint64_t bits = words[w] & (bit == 63 ? ~uint64_t(0) : ((uint64_t(1) << (bit + 1)) - 1));
+                if (bits != 0) {
+                    return (w << 6) + highest_bit(bits);
+                }
+                if (w == 0) {
+                    return npos;
+                }
+                w = prev_word(w - 1);
+                return w == npos ? npos : (w << 6) + highest_bit(words[w]);
+            }
+
+            size_t find_first() const { return find_next(0); }
+            size_t find_last() const { return find_prev(slots - 1); }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace order_matching {
+    namespace utils {
+
+        // Single-threaded FIFO ring over a preallocated power-of-two array.
+        // Producers push, the consumer pops or drains in order; the storage is
+        // reused, so a ring sized for the burst never allocates. It doubles
+        // (keeping FIFO order) only if the consumer falls a full capacity
+        // behind - items are never dropped.
+        template <typename T>
+        class RingBuffer {
+        private:
+            std::vector<T> slots;
+            size_t head = 0;     // oldest item
+            size_t count = 0;
+            size_t mask;
+
+            void grow() {
+                std::vector<T> bigger(slots.size() * 2);
+                for (size_t i = 0; i < count; ++i) {
+                    bigger[i] = slots[(head + i) & mask];
+                }
+                slots.swap(bigger);
+                head = 0;
+                mask = slots.size() - 1;
+            }
+
+        public:
+            explicit RingBuffer(size_t capacity = 1024) {
+                size_t size = 1;
+                while (size < capacity) {
+                    size <<= 1;
+                }
+                slots.resize(size);
+                mask = size - 1;
+            }
+
+            void push(const T& item) {
+                if (count == slots.size()) {
+                    grow();
+                }
+                slots[(head + count) & mask] = item;
+                ++count;
+            }
+
+            bool pop(T& item) {
+                if (count == 0) {
+                    return false;
+                }
+                item = slots[head];
+                head = (head + 1) & mask;
+                --count;
+                return true;
+            }
+
+            // i-th oldest item
+            const T& operator[](size_t i) const { return slots[(head + i) & mask]; }
+            const T& front() const { return slots[head]; }
+
+            // hands every item to f in FIFO order and empties the ring
+            template <typename F>
+            void drain(F&& f) {
+                while (count > 0) {
+                    f(slots[head]);
+                    head = (head + 1) & mask;
+                    --count;
+                }
+            }
+
+            void clear() {
+                head = 0;
+                count = 0;
+            }
+
+            size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+            size_t capacity() const { return slots.size(); }
+        };
+
+    } // namespace utils
+} // namespace order_matching
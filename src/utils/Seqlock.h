@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "WaitStrategy.h"
+
+namespace order_matching {
+    namespace utils {
+
+        // Single-writer, many-reader publication of a small plain struct.
+        // The writer makes the sequence odd, stores the value, then makes it
+        // even again; a reader copies the value between two reads of the
+        // sequence and retries if they differ or were odd. The writer never
+        // waits on readers, and readers never write shared memory, so any
+        // number of them can poll without slowing the writer down. The value
+        // is kept as relaxed atomic words so a torn read is a retry, not a
+        // data race.
+        template <typename T>
+        class Seqlock {
+            static_assert(std::is_trivially_copyable<T>::value, "seqlock values are copied as raw words");
+
+        private:
+            static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+            alignas(CACHE_LINE) std::atomic<uint64_t> sequence{0};
+            std::atomic<uint64_t> words[WORDS] = {};
+
+        public:
+            // writer side, one thread only
+            void store(const T& value) {
+                uint64_t buffer[WORDS] = {};
+                std::memcpy(buffer, &value, sizeof(T));
+
+                uint64_t s = sequence.load(std::memory_order_relaxed);
+                sequence.store(s + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                for (size_t i = 0; i < WORDS; ++i) {
+                    words[i].store(buffer[i], std::memory_order_relaxed);
+                }
+                sequence.store(s + 2, std::memory_order_release);
+            }
+
+            // any thread - spins only while a store is in progress
+            T load() const {
+                uint64_t buffer[WORDS];
+                while (true) {
+                    uint64_t before = sequence.load(std::memory_order_acquire);
+                    if (before & 1) {
+                        cpu_relax();
+                        continue;
+                    }
+                    for (size_t i = 0; i < WORDS; ++i) {
+                        buffer[i] = words[i].load(std::memory_order_relaxed);
+                    }
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (sequence.load(std::memory_order_relaxed) == before) {
+                        break;
+                    }
+                }
+                T value;
+                std::memcpy(&value, buffer, sizeof(T));
+                return value;
+            }
+
+            // number of completed stores
+            uint64_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+        };
+
+    } // namespace utils
+} // namespace order_matching
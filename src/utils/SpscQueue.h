@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "WaitStrategy.h"
+
+namespace order_matching {
+    namespace utils {
+
+        // Bounded lock-free queue for exactly one producer thread and one
+        // consumer thread. The indices live on their own cache lines, and
+        // each side keeps a cached copy of the other's index so it only
+        // touches the shared line when the queue looks full (producer) or
+        // empty (consumer). Indices grow without wrapping; the slot is the
+        // index masked to the power-of-two capacity.
+        template <typename T>
+        class SpscQueue {
+        private:
+            std::vector<T> slots;
+            size_t mask;
+
+            alignas(CACHE_LINE) std::atomic<size_t> head{0};   // next slot to pop, written by the consumer
+            size_t cached_tail = 0;                             // consumer's view of tail
+
+            alignas(CACHE_LINE) std::atomic<size_t> tail{0};   // next slot to push, written by the producer
+            size_t cached_head = 0;                             // producer's view of head
+
+        public:
+            explicit SpscQueue(size_t capacity = 65536) {
+                size_t size = 2;
+                while (size < capacity) {
+                    size <<= 1;
+                }
+                slots.resize(size);
+                mask = size - 1;
+            }
+
+            SpscQueue(const SpscQueue&) = delete;
+            SpscQueue& operator=(const SpscQueue&) = delete;
+
+            // producer side - false if the queue is full
+            bool try_push(const T& item) {
+                size_t t = tail.load(std::memory_order_relaxed);
+                if (t - cached_head > mask) {
+                    cached_head = head.load(std::memory_order_acquire);
+                    if (t - cached_head > mask) {
+                        return false;
+                    }
+                }
+                slots[t & mask] = item;
+                tail.store(t + 1, std::memory_order_release);
+                return true;
+            }
+
+            // consumer side - copies up to max items to out, returns how many
+            size_t pop_batch(T* out, size_t max) {
+                size_t h = head.load(std::memory_order_relaxed);
+                if (h == cached_tail) {
+                    cached_tail = tail.load(std::memory_order_acquire);
+                    if (h == cached_tail) {
+                        return 0;
+                    }
+                }
+                size_t n = cached_tail - h;
+                if (n > max) {
+                    n = max;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = slots[(h + i) & mask];
+                }
+                head.store(h + n, std::memory_order_release);
+                return n;
+            }
+
+            bool try_pop(T& item) {
+                return pop_batch(&item, 1) == 1;
+            }
+
+            // exact only when neither side is running
+            size_t size() const {
+                return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+            }
+
+            bool empty() const { return size() == 0; }
+            size_t capacity() const { return slots.size(); }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace order_matching {
+    namespace utils {
+
+        static constexpr size_t CACHE_LINE = 64;
+
+        // spin-wait hint: lets the sibling hyperthread run and saves power
+        inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        }
+
+        // What a thread does while it waits on a queue - the consumer when it
+        // is empty, a producer when it is full. wait() is called once per
+        // failed attempt, reset() after a successful one.
+
+        // Never gives up the core: lowest latency, burns a core while idle
+        struct BusySpinWait {
+            void wait() { cpu_relax(); }
+            void reset() {}
+        };
+
+        // Spins first, then yields, then sleeps in short naps, so an idle
+        // thread hands its core back. Latency after a long idle spell is
+        // bounded by the nap length
+        class BackoffWait {
+        private:
+            static constexpr unsigned SPIN_LIMIT = 1024;
+            static constexpr unsigned YIELD_LIMIT = SPIN_LIMIT + 64;
+
+            unsigned attempts = 0;
+
+        public:
+            void wait() {
+                if (attempts < SPIN_LIMIT) {
+                    ++attempts;
+                    cpu_relax();
+                } else if (attempts < YIELD_LIMIT) {
+                    ++attempts;
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+
+            void reset() { attempts = 0; }
+        };
+
+    } // namespace utils
+} // namespace order_matching
@@ -1,156 +1,1320 @@
 #include <iostream>
-#include <cassert>
+#include <cstdlib>
 #include <random>
 #include <iomanip>
+#include <type_traits>
+#include <unordered_map>
+#include "../src/core/DepthPublisher.h"
+#include "../src/core/Journal.h"
 #include "../src/core/MatchingEngine.h"
+#include "../src/core/OrderFile.h"
+#include "../src/core/OrderGateway.h"
+#include "../src/core/PushServer.h"
+#include "../src/core/ShardedMatchingEngine.h"
+#include "../src/core/Snapshot.h"
 #include "../src/implementations/BTreeOrderBook.h"
+#include "../src/implementations/PriceLadderOrderBook.h"
 #include "../src/utils/Timer.h"
+#include "../src/utils/FlatIdMap.h"
+#include "../src/utils/KeySearch.h"
+#include "../src/utils/MpscQueue.h"
+#include "../src/utils/ObjectPool.h"
+#include "../src/utils/RingBuffer.h"
+#include "../src/utils/SpscQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <limits>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define TEST_HAS_POSIX_SOCKETS 1
+#endif
 
 using namespace order_matching;
 using namespace order_matching::utils;
 
+// assert() is compiled out under NDEBUG; CHECK evaluates its condition in
+// every build and aborts on failure, so a Release build runs the same checks
+inline void check_condition(bool ok, const char* condition, const char* file, int line) {
+    if (!ok) {
+        std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+        std::abort();
+    }
+}
+
+#define CHECK(condition) check_condition((condition), #condition, __FILE__, __LINE__)
+
 class OrderMatchingTester {
 private:
     std::mt19937 rng;
-    std::uniform_real_distribution<double> price_dist;
-    std::uniform_real_distribution<double> qty_dist;
+    std::uniform_int_distribution<Price> price_dist;
+    std::uniform_int_distribution<Quantity> qty_dist;
     std::uniform_int_distribution<int> side_dist;
 
 public:
     OrderMatchingTester()
         : rng(std::random_device{}()),
-          price_dist(90.0, 110.0),
-          qty_dist(1.0, 1000.0),
+          price_dist(9000, 11000),   // $90.00 - $110.00 in cent ticks
+          qty_dist(1, 1000),
           side_dist(0, 1) {}
 
+    template <typename Book>
     void test_basic_matching() {
         std::cout << "\n=== Test: Basic Order Matching ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
 
         // Add buy order
-        auto buy_order = std::make_shared<Order>(1, BUY, 100.0, 100, "AAPL");
-        assert(book.add_order(buy_order));
+        auto buy_order = std::make_shared<Order>(1, BUY, 10000, 100, book.get_symbol_id());
+        bool added = book.add_order(buy_order);
+        CHECK(added);
 
         // Add sell order at same price
-        auto sell_order = std::make_shared<Order>(2, SELL, 100.0, 50, "AAPL");
-        assert(book.add_order(sell_order));
+        auto sell_order = std::make_shared<Order>(2, SELL, 10000, 50, book.get_symbol_id());
+        added = book.add_order(sell_order);
+        CHECK(added);
 
         // Match orders
         auto trades = book.match_orders();
-        assert(trades.size() == 1);
-        assert(trades[0].get_price() == 100.0);
-        assert(trades[0].get_quantity() == 50.0);
-        assert(trades[0].get_buy_order_id() == 1);
-        assert(trades[0].get_sell_order_id() == 2);
+        CHECK(trades.size() == 1);
+        CHECK(trades[0].get_price() == 10000);
+        CHECK(trades[0].get_quantity() == 50);
+        CHECK(trades[0].get_buy_order_id() == 1);
+        CHECK(trades[0].get_sell_order_id() == 2);
 
-        // Check remaining quantities
-        assert(buy_order->get_remaining_quantity() == 50.0);
-        assert(sell_order->get_remaining_quantity() == 0.0);
-        assert(sell_order->is_filled());
+        // Check remaining quantities - the book owns the resting copies
+        const Order* resting = book.find_order(1);
+        CHECK(resting != nullptr);
+        CHECK(resting->get_remaining_quantity() == 50);
+        CHECK(resting->get_status() == PARTIALLY_FILLED);
+        CHECK(book.find_order(2) == nullptr);   // filled orders leave the book
 
         std::cout << "✓ Basic matching test passed" << std::endl;
     }
 
+    template <typename Book>
     void test_price_priority() {
         std::cout << "\n=== Test: Price Priority ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
 
         // Add multiple buy orders at different prices
-        book.add_order(std::make_shared<Order>(1, BUY, 99.0, 100, "AAPL"));
-        book.add_order(std::make_shared<Order>(2, BUY, 100.0, 100, "AAPL"));
-        book.add_order(std::make_shared<Order>(3, BUY, 98.0, 100, "AAPL"));
+        book.add_order(1, BUY, 9900, 100);
+        book.add_order(2, BUY, 10000, 100);
+        book.add_order(3, BUY, 9800, 100);
 
         // Add sell order
-        book.add_order(std::make_shared<Order>(4, SELL, 99.0, 100, "AAPL"));
+        book.add_order(4, SELL, 9900, 100);
 
-        // Match orders - should match with highest buy price (100.0)
+        // Match orders - should match with highest buy price (10000)
         auto trades = book.match_orders();
-        assert(trades.size() == 1);
-        assert(trades[0].get_buy_order_id() == 2);  // Highest price buy order
+        CHECK(trades.size() == 1);
+        CHECK(trades[0].get_buy_order_id() == 2);  // Highest price buy order
 
         std::cout << "✓ Price priority test passed" << std::endl;
     }
 
+    template <typename Book>
     void test_time_priority() {
         std::cout << "\n=== Test: Time Priority ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
 
         // Add multiple buy orders at same price
-        book.add_order(std::make_shared<Order>(1, BUY, 100.0, 50, "AAPL"));
-        book.add_order(std::make_shared<Order>(2, BUY, 100.0, 50, "AAPL"));
-        book.add_order(std::make_shared<Order>(3, BUY, 100.0, 50, "AAPL"));
+        book.add_order(1, BUY, 10000, 50);
+        book.add_order(2, BUY, 10000, 50);
+        book.add_order(3, BUY, 10000, 50);
 
         // Add sell order
-        book.add_order(std::make_shared<Order>(4, SELL, 100.0, 50, "AAPL"));
+        book.add_order(4, SELL, 10000, 50);
 
         // Match orders - should match with first buy order
         auto trades = book.match_orders();
-        assert(trades.size() == 1);
-        assert(trades[0].get_buy_order_id() == 1);  // First in time
+        CHECK(trades.size() == 1);
+        CHECK(trades[0].get_buy_order_id() == 1);  // First in time
 
         std::cout << "✓ Time priority test passed" << std::endl;
     }
 
+    template <typename Book>
     void test_order_cancellation() {
         std::cout << "\n=== Test: Order Cancellation ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
 
         // Add orders
-        book.add_order(std::make_shared<Order>(1, BUY, 100.0, 100, "AAPL"));
-        book.add_order(std::make_shared<Order>(2, BUY, 101.0, 100, "AAPL"));
+        book.add_order(1, BUY, 10000, 100);
+        book.add_order(2, BUY, 10100, 100);
 
         // Cancel order
-        assert(book.cancel_order(1));
-        assert(!book.cancel_order(1));  // Double cancel should fail
-        assert(!book.cancel_order(999)); // Non-existent order
+        bool cancelled = book.cancel_order(1);
+        CHECK(cancelled);
+        cancelled = book.cancel_order(1);  // Double cancel should fail
+        CHECK(!cancelled);
+        cancelled = book.cancel_order(999); // Non-existent order
+        CHECK(!cancelled);
 
-        // Check best bid is now 101.0
-        assert(book.get_best_bid() == 101.0);
+        // Check best bid is now 101.00
+        CHECK(book.get_best_bid() == 10100);
 
         std::cout << "✓ Order cancellation test passed" << std::endl;
     }
 
+    template <typename Book>
+    void test_cancel_within_level() {
+        std::cout << "\n=== Test: Cancel Within Level Queue ===" << std::endl;
+
+        Book book("AAPL");
+
+        // five orders queued at one price
+        for (Order::OrderId id = 1; id <= 5; ++id) {
+            bool added = book.add_order(id, BUY, 10000, 10);
+            CHECK(added);
+        }
+
+        // cancel from the middle, the head and the tail
+        bool cancelled = book.cancel_order(3);
+        CHECK(cancelled);
+        cancelled = book.cancel_order(1);
+        CHECK(cancelled);
+        cancelled = book.cancel_order(5);
+        CHECK(cancelled);
+        CHECK(book.find_order(3) == nullptr);
+        CHECK(book.find_order(2)->get_level() == book.find_order(4)->get_level());
+        CHECK(book.get_bid_count() == 2);
+
+        // the survivors keep their relative time priority
+        book.add_order(6, SELL, 10000, 20);
+        auto trades = book.match_orders();
+        CHECK(trades.size() == 2);
+        CHECK(trades[0].get_buy_order_id() == 2);
+        CHECK(trades[1].get_buy_order_id() == 4);
+
+        // an id can only rest once
+        auto dup = std::make_shared<Order>(7, BUY, 9900, 10, book.get_symbol_id());
+        bool added = book.add_order(dup);
+        CHECK(added);
+        added = book.add_order(7, BUY, 9800, 10);
+        CHECK(!added);
+
+        std::cout << "✓ Cancel within level test passed" << std::endl;
+    }
+
+    // small degrees force plenty of splits, borrows and merges
+    template <size_t Degree>
+    void check_level_reclamation() {
+        BTreeOrderBook<Degree> book("AAPL");
+        std::vector<Order::OrderId> live;
+        std::uniform_int_distribution<Price> level_dist(9000, 9400);
+
+        for (Order::OrderId id = 1; id <= 4000; ++id) {
+            // mostly adds early on, mostly cancels later
+            bool cancel = !live.empty() && (side_dist(rng) == 0 || id > 2500);
+            if (cancel) {
+                size_t pick = rng() % live.size();
+                bool cancelled = book.cancel_order(live[pick]);
+                CHECK(cancelled);
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                book.add_order(id, BUY, level_dist(rng), 10);
+                live.push_back(id);
+            }
+            if (id % 97 == 0) {
+                CHECK(book.check_invariants());
+            }
+        }
+        CHECK(book.check_invariants());
+
+        while (!live.empty()) {
+            bool cancelled = book.cancel_order(live.back());
+            CHECK(cancelled);
+            live.pop_back();
+        }
+        CHECK(book.check_invariants());
+        CHECK(book.get_level_count(BUY) == 0);
+        CHECK(book.get_tree_height(BUY) == 1);
+        CHECK(book.get_best_bid() == 0);
+    }
+
+    void test_level_reclamation() {
+        std::cout << "\n=== Test: Empty Level Reclamation ===" << std::endl;
+
+        check_level_reclamation<2>();
+        check_level_reclamation<3>();
+        check_level_reclamation<4>();
+        check_level_reclamation<32>();
+
+        // levels drained by matching are reclaimed too
+        BTreeOrderBook<2> book("AAPL");
+        for (int i = 0; i < 50; ++i) {
+            book.add_order(i + 1, SELL, 10000 + i, 10);
+        }
+        book.add_order(100, BUY, 10039, 400);
+        auto trades = book.match_orders();
+        CHECK(trades.size() == 40);
+        CHECK(book.get_level_count(SELL) == 10);
+        CHECK(book.get_level_count(BUY) == 0);
+        CHECK(book.get_best_ask() == 10040);
+        CHECK(book.check_invariants());
+
+        std::cout << "✓ Level reclamation test passed" << std::endl;
+    }
+
+    // tiny window so recentering happens - the B-tree degree is part of
+    // the type, and the suite runs at degree 3 for splits and merges
+    template <typename Book>
+    std::unique_ptr<Book> make_tiny_book() {
+        if constexpr (std::is_same<Book, PriceLadderOrderBook>::value) {
+            return std::make_unique<Book>("AAPL", 3);
+        } else {
+            return std::make_unique<Book>("AAPL");
+        }
+    }
+
+    template <typename Book>
+    void test_top_of_book_cache() {
+        std::cout << "\n=== Test: Top of Book Cache ===" << std::endl;
+
+        auto tiny = make_tiny_book<Book>();
+        Book& book = *tiny;
+
+        book.add_order(1, BUY, 10000, 100);
+        book.add_order(2, BUY, 10000, 50);
+        book.add_order(3, BUY, 9900, 70);
+        CHECK(book.get_best_bid() == 10000);
+        CHECK(book.get_best_bid_size() == 150);
+
+        // a better price takes over, a worse one leaves the cache alone
+        book.add_order(4, BUY, 10100, 10);
+        CHECK(book.get_best_bid() == 10100);
+        CHECK(book.get_best_bid_size() == 10);
+        book.add_order(5, BUY, 9800, 10);
+        CHECK(book.get_best_bid() == 10100);
+
+        // emptying the best level falls back to the next one
+        bool cancelled = book.cancel_order(4);
+        CHECK(cancelled);
+        CHECK(book.get_best_bid() == 10000);
+        CHECK(book.get_best_bid_size() == 150);
+
+        // partial fill shrinks the cached size, a full fill moves the level
+        book.add_order(6, SELL, 10000, 120);
+        book.match_orders();
+        CHECK(book.get_best_bid() == 10000);
+        CHECK(book.get_best_bid_size() == 30);
+        CHECK(book.get_best_ask() == 0);
+        CHECK(book.get_best_ask_size() == 0);
+        CHECK(book.check_invariants());
+
+        // randomized: the cache must always agree with the tree
+        std::uniform_int_distribution<Price> near(9950, 10050);
+        for (Order::OrderId id = 100; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            book.add_order(id, side, near(rng), qty_dist(rng));
+            if (id % 3 == 0) {
+                book.cancel_order(id - 50);
+            }
+            if (id % 7 == 0) {
+                book.match_orders();
+            }
+            if (id % 50 == 0) {
+                CHECK(book.check_invariants());
+            }
+        }
+        book.match_orders();
+        CHECK(book.check_invariants());
+        CHECK(book.get_best_bid() < book.get_best_ask() || book.get_best_ask() == 0);
+
+        std::cout << "✓ Top of book cache test passed" << std::endl;
+    }
+
+    // the snapshot must agree with the book's own queries after every kind
+    // of mutation, and only mutations move the sequence
+    template <typename Book>
+    void assert_top_matches(const Book& book, const TopOfBook& top) {
+        CHECK(top.bid_price == book.get_best_bid() && top.bid_size == book.get_best_bid_size());
+        CHECK(top.ask_price == book.get_best_ask() && top.ask_size == book.get_best_ask_size());
+        std::vector<OrderBook::Level> bids = book.get_bid_levels(1);
+        std::vector<OrderBook::Level> asks = book.get_ask_levels(1);
+        CHECK(top.bid_orders == (bids.empty() ? 0 : bids[0].order_count));
+        CHECK(top.ask_orders == (asks.empty() ? 0 : asks[0].order_count));
+    }
+
+    template <typename Book>
+    void test_published_top_of_book() {
+        std::cout << "\n=== Test: Published Top of Book ===" << std::endl;
+
+        Book book("AAPL");
+        ExecutionRing executions;
+        TopOfBook top = book.get_top_of_book();
+        CHECK(top.sequence == 0 && top.bid_price == 0 && top.ask_price == 0 && top.last_trade_quantity == 0);
+
+        book.add_order(1, BUY, 10000, 100);
+        book.add_order(2, BUY, 10000, 50);
+        book.add_order(3, SELL, 10100, 70);
+        top = book.get_top_of_book();
+        CHECK(top.sequence == 3);
+        CHECK(top.bid_price == 10000 && top.bid_size == 150 && top.bid_orders == 2);
+        CHECK(top.ask_price == 10100 && top.ask_size == 70 && top.ask_orders == 1);
+
+        // a fill publishes once per call, carrying the last trade
+        book.add_order(4, SELL, 9900, 120, executions);
+        top = book.get_top_of_book();
+        CHECK(top.sequence == 4 && executions.size() == 2);
+        CHECK(top.last_trade_price == 10000 && top.last_trade_quantity == 20);
+        CHECK(top.bid_size == 30 && top.bid_orders == 1);
+
+        // refused calls change nothing and publish nothing
+        bool cancelled = book.cancel_order(999);
+        CHECK(!cancelled);
+        bool added = book.add_order(5, BUY, 9000, 10, IOC, executions);
+        CHECK(!added);
+        book.match_orders(executions);
+        CHECK(book.get_top_of_book().sequence == 4);
+
+        const Order* amended = book.modify_order(3, 10050, 40);
+        CHECK(amended);
+        CHECK(book.get_top_of_book().ask_price == 10050 && book.get_top_of_book().ask_size == 40);
+        cancelled = book.cancel_order(2);
+        CHECK(cancelled);
+        top = book.get_top_of_book();
+        CHECK(top.sequence == 6 && top.bid_price == 0 && top.bid_orders == 0);
+        std::vector<OrderMessage> batch = {{0, BUY, 10, 9990, 5}, {0, BUY, 11, 9990, 6}};
+        book.add_orders(batch.data(), batch.size());
+        CHECK(book.get_top_of_book().bid_size == 11 && book.get_top_of_book().sequence == 7);
+
+        std::uniform_int_distribution<Price> near(9950, 10050);
+        for (Order::OrderId id = 100; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            book.add_order(id, side, near(rng), qty_dist(rng), executions);
+            if (id % 3 == 0) {
+                book.cancel_order(id - 50);
+            }
+            if (id % 5 == 0) {
+                book.modify_order(id - 30, near(rng), qty_dist(rng));
+            }
+            assert_top_matches(book, book.get_top_of_book());
+        }
+        if (!executions.empty()) {
+            CHECK(book.get_top_of_book().last_trade_price == executions[executions.size() - 1].price);
+        }
+
+        std::cout << "✓ Published top of book test passed" << std::endl;
+    }
+
+    // every level change reaches the feed: a consumer applying updates on
+    // top of a snapshot holds the book's full depth after every round,
+    // whether it synced at the start or joined late
+    template <typename Book>
+    void test_depth_feed() {
+        std::cout << "\n=== Test: Depth Feed ===" << std::endl;
+
+        auto same_depth = [](const Book& book, const DepthBook& depth) {
+            auto bids = book.get_bid_levels(book.get_bid_count());
+            auto asks = book.get_ask_levels(book.get_ask_count());
+            auto feed_bids = depth.get_bid_levels(bids.size() + 1);
+            auto feed_asks = depth.get_ask_levels(asks.size() + 1);
+            if (bids.size() != feed_bids.size() || asks.size() != feed_asks.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < bids.size(); ++i) {
+                if (bids[i].price != feed_bids[i].price || bids[i].quantity != feed_bids[i].quantity ||
+                    bids[i].order_count != feed_bids[i].order_count) {
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < asks.size(); ++i) {
+                if (asks[i].price != feed_asks[i].price || asks[i].quantity != feed_asks[i].quantity ||
+                    asks[i].order_count != feed_asks[i].order_count) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // one change, one update, carrying the level's new totals
+        {
+            Book book("AAPL");
+            LevelUpdateRing updates;
+            book.set_level_updates(&updates);
+            book.add_order(1, BUY, 10000, 10);
+            book.add_order(2, BUY, 10000, 5);
+            CHECK(updates.size() == 2 && updates[1].sequence == 2 && updates[1].price == 10000);
+            CHECK(updates[1].quantity == 15 && updates[1].order_count == 2 && updates[1].side == BUY);
+            book.cancel_order(1);
+            book.cancel_order(2);
+            CHECK(updates.size() == 4 && updates[3].quantity == 0 && updates[3].order_count == 0);
+            book.set_level_updates(nullptr);
+            book.add_order(3, SELL, 10001, 5);
+            CHECK(updates.size() == 4 && book.get_level_sequence() == 5);
+        }
+
+        Book book("AAPL");
+        DepthPublisher publisher(1000);
+        DepthBook early, late;
+        DepthBook* joining = &early;
+        uint64_t last_sequence = 0;
+        publisher.set_update_handler([&early, &late, &last_sequence](const DepthUpdate& update) {
+            CHECK(update.sequence > last_sequence);
+            last_sequence = update.sequence;
+            early.apply(update);
+            late.apply(update);
+        });
+        publisher.set_snapshot_handler([&joining](const DepthSnapshot& snapshot) {
+            if (joining) {
+                joining->apply(snapshot);
+            }
+            joining = nullptr;
+        });
+        publisher.add_book(&book);
+        publisher.publish();
+        CHECK(early.is_synced() && publisher.get_snapshots_published() == 1);
+
+        ExecutionRing executions;
+        std::uniform_int_distribution<int> op_dist(0, 9);
+        Order::OrderId next_id = 1;
+        for (int round = 0; round < 400; ++round) {
+            for (int k = 0; k < 8; ++k) {
+                Side side = side_dist(rng) ? BUY : SELL;
+                Price price = 10000 + (side == BUY ? -1 : 1) * Price(rng() % 40) + (rng() % 8 == 0 ? (side == BUY ? 30 : -30) : 0);
+                Order::OrderId target = 1 + rng() % next_id;
+                switch (op_dist(rng)) {
+                case 0: case 1: case 2:
+                    book.add_order(next_id++, side, price, qty_dist(rng), executions);
+                    break;
+                case 3: case 4:
+                    book.add_order(next_id++, side, price, qty_dist(rng));
+                    break;
+                case 5: case 6:
+                    book.cancel_order(target);
+                    break;
+                case 7:
+                    book.modify_order(target, price, qty_dist(rng));
+                    break;
+                case 8: {
+                    OrderMessage batch[3] = {{0, side, next_id, price, 5}, {0, side, next_id + 1, price, 7},
+                                             {0, side, next_id + 2, price + (side == BUY ? -1 : 1), 9}};
+                    book.add_orders(batch, 3);
+                    next_id += 3;
+                    break;
+                }
+                default:
+                    book.match_orders(executions);
+                    break;
+                }
+            }
+            publisher.publish();
+            CHECK(same_depth(book, early));
+
+            if (round == 200) {
+                joining = &late;
+                publisher.request_snapshots();
+            }
+            if (round > 200) {
+                CHECK(late.is_synced() && same_depth(book, late));
+            }
+        }
+        executions.clear();
+
+        // repeated changes to a level within a round go out once, at the
+        // last of them, so a level changed in between goes out first
+        uint64_t published = publisher.get_updates_published();
+        Price far_bid = book.get_best_bid() - 1000;
+        for (int i = 0; i < 10; ++i) {
+            book.add_order(next_id++, BUY, far_bid, 1);
+            if (i == 4) {
+                book.add_order(next_id++, BUY, far_bid - 1, 1);
+            }
+        }
+        size_t sent = publisher.publish();
+        CHECK(sent == 2 && publisher.get_updates_published() == published + 2);
+        CHECK(last_sequence == book.get_level_sequence());
+        auto far_levels = early.get_bid_levels(book.get_bid_count());
+        CHECK(same_depth(book, early) && far_levels[far_levels.size() - 2].order_count == 10);
+        CHECK(publisher.get_updates_received() > publisher.get_updates_published());
+
+        // a bulk load reports each level it builds once
+        std::vector<SnapshotOrder> exported;
+        book.export_orders(exported);
+        Book loaded("AAPL");
+        LevelUpdateRing updates;
+        loaded.set_level_updates(&updates);
+        bool restored_orders = loaded.load_orders(exported.data(), exported.size());
+        CHECK(restored_orders);
+        DepthBook rebuilt;
+        rebuilt.apply(DepthSnapshot{0, 0, {}, {}});
+        updates.drain([&rebuilt](const LevelUpdate& u) {
+            rebuilt.apply(DepthUpdate{u.sequence, u.price, u.quantity, u.order_count, 0, u.side, {}});
+        });
+        CHECK(same_depth(loaded, rebuilt));
+        CHECK(loaded.get_level_sequence() == rebuilt.get_level_count(BUY) + rebuilt.get_level_count(SELL));
+
+        std::cout << "✓ Depth feed test passed" << std::endl;
+    }
+
+    // the order events alone rebuild the book order by order: same orders,
+    // same remaining sizes, same queue positions
+    template <typename Book>
+    void test_order_event_feed() {
+        std::cout << "\n=== Test: Order Event Feed ===" << std::endl;
+
+        // a consumer's L3 book: a FIFO of ids per price, best price first
+        struct Resting {
+            Side side;
+            Price price;
+            Quantity remaining;
+            std::list<Order::OrderId>::iterator position;
+        };
+        std::map<Price, std::list<Order::OrderId>, std::greater<Price>> bids;
+        std::map<Price, std::list<Order::OrderId>> asks;
+        std::unordered_map<Order::OrderId, Resting> resting;
+        auto queue_at = [&bids, &asks](Side side, Price price) -> std::list<Order::OrderId>& {
+            return side == BUY ? bids[price] : asks[price];
+        };
+        auto remove = [&](Order::OrderId id) {
+            Resting& r = resting.at(id);
+            std::list<Order::OrderId>& queue = queue_at(r.side, r.price);
+            queue.erase(r.position);
+            if (queue.empty()) {
+                r.side == BUY ? bids.erase(r.price) : asks.erase(r.price);
+            }
+            resting.erase(id);
+        };
+        auto enqueue = [&](Order::OrderId id, Side side, Price price, Quantity quantity) {
+            std::list<Order::OrderId>& queue = queue_at(side, price);
+            queue.push_back(id);
+            resting[id] = Resting{side, price, quantity, std::prev(queue.end())};
+        };
+
+        uint64_t expected_sequence = 1;
+        std::unordered_map<uint64_t, int> execute_trade_ids;
+        auto apply = [&](const OrderEvent& e) {
+            CHECK(e.sequence == expected_sequence);
+            ++expected_sequence;
+            switch (e.type) {
+            case OrderEventType::ADD:
+                CHECK(resting.count(e.order_id) == 0);
+                enqueue(e.order_id, Side(e.side), e.price, e.quantity);
+                break;
+            case OrderEventType::CANCEL:
+                CHECK(resting.at(e.order_id).remaining == e.quantity);
+                remove(e.order_id);
+                break;
+            case OrderEventType::EXECUTE: {
+                Resting& r = resting.at(e.order_id);
+                CHECK(e.quantity > 0 && e.quantity <= r.remaining);
+                ++execute_trade_ids[e.trade_id];
+                r.remaining -= e.quantity;
+                if (r.remaining == 0) {
+                    remove(e.order_id);
+                }
+                break;
+            }
+            case OrderEventType::AMEND:
+                if (e.keeps_priority) {
+                    CHECK(resting.at(e.order_id).price == e.price);
+                    resting.at(e.order_id).remaining = e.quantity;
+                } else {
+                    remove(e.order_id);
+                    enqueue(e.order_id, Side(e.side), e.price, e.quantity);
+                }
+                break;
+            }
+        };
+
+        Book book("AAPL");
+        OrderEventQueue events(1 << 16);
+        book.set_order_events(&events);
+        ExecutionRing executions;
+        std::unordered_map<uint64_t, int> trade_ids;
+        std::uniform_int_distribution<int> op_dist(0, 9);
+        Order::OrderId next_id = 1;
+        OrderEvent batch[64];
+        for (int round = 0; round < 300; ++round) {
+            for (int k = 0; k < 10; ++k) {
+                Side side = side_dist(rng) ? BUY : SELL;
+                Price price = 10000 + (side == BUY ? -1 : 1) * Price(rng() % 30) + (rng() % 6 == 0 ? (side == BUY ? 20 : -20) : 0);
+                Order::OrderId target = 1 + rng() % next_id;
+                switch (op_dist(rng)) {
+                case 0: case 1: case 2:
+                    book.add_order(next_id++, side, price, qty_dist(rng), rng() % 4 ? LIMIT : IOC, executions);
+                    break;
+                case 3: case 4:
+                    book.add_order(next_id++, side, price, qty_dist(rng));
+                    break;
+                case 5: case 6:
+                    book.cancel_order(target);
+                    break;
+                case 7:
+                    if (rng() % 2) {
+                        book.modify_order(target, price, qty_dist(rng), executions);
+                    } else {
+                        book.modify_order(target, rng() % 2 ? price : (book.find_order(target) ? book.find_order(target)->get_price() : price),
+                                          qty_dist(rng));
+                    }
+                    break;
+                case 8: {
+                    OrderMessage messages[2] = {{0, side, next_id, price, 5}, {0, side, next_id + 1, price, 7}};
+                    book.add_orders(messages, 2);
+                    next_id += 2;
+                    break;
+                }
+                default:
+                    book.match_orders(executions);
+                    break;
+                }
+            }
+            executions.drain([&trade_ids](const Execution& e) { ++trade_ids[e.trade_id]; });
+            size_t n;
+            while ((n = events.pop_batch(batch, 64)) > 0) {
+                for (size_t i = 0; i < n; ++i) {
+                    apply(batch[i]);
+                }
+            }
+
+            std::vector<SnapshotOrder> expected;
+            book.export_orders(expected);
+            CHECK(expected.size() == resting.size());
+            size_t i = 0;
+            for (auto& level : bids) {
+                for (Order::OrderId id : level.second) {
+                    CHECK(expected[i].order_id == id && expected[i].price == level.first);
+                    CHECK(expected[i].remaining_quantity == resting.at(id).remaining && expected[i].side == BUY);
+                    ++i;
+                }
+            }
+            for (auto& level : asks) {
+                for (Order::OrderId id : level.second) {
+                    CHECK(expected[i].order_id == id && expected[i].price == level.first);
+                    CHECK(expected[i].remaining_quantity == resting.at(id).remaining && expected[i].side == SELL);
+                    ++i;
+                }
+            }
+        }
+        CHECK(book.get_order_events_dropped() == 0 && book.get_order_sequence() == expected_sequence - 1);
+
+        // each fill executes one resting order, or two when match_orders
+        // crossed two resting orders
+        for (auto& trade : trade_ids) {
+            CHECK(execute_trade_ids.count(trade.first) == 1 && execute_trade_ids[trade.first] >= 1);
+        }
+        CHECK(execute_trade_ids.size() == trade_ids.size());
+
+        // a full queue drops, counts and leaves a gap in the sequence
+        Book small("AAPL");
+        OrderEventQueue two(2);
+        small.set_order_events(&two);
+        for (Order::OrderId id = 1; id <= 5; ++id) {
+            small.add_order(id, BUY, 10000, 10);
+        }
+        CHECK(two.size() == 2 && small.get_order_events_dropped() == 3 && small.get_order_sequence() == 5);
+        two.pop_batch(batch, 2);
+        small.cancel_order(1);
+        bool popped = two.try_pop(batch[0]);
+        CHECK(popped && batch[0].sequence == 6 && batch[0].type == OrderEventType::CANCEL);
+        small.set_order_events(nullptr);
+
+        std::cout << "✓ Order event feed test passed" << std::endl;
+    }
+
+    // export then bulk load must give back the same book - same levels,
+    // same queues, same remaining quantities - for trees of every shape,
+    // and the loaded book must keep working as a normal one
+    template <typename Book>
+    void test_snapshot_round_trip() {
+        std::cout << "\n=== Test: Snapshot Round Trip ===" << std::endl;
+
+        for (size_t levels : {0, 1, 2, 5, 7, 8, 9, 50, 1000}) {
+            Book book("AAPL");
+            Order::OrderId id = 1;
+            for (size_t l = 0; l < levels; ++l) {
+                for (size_t k = 0; k <= l % 3; ++k) {
+                    book.add_order(id++, BUY, 10000 - Price(l), 10 + Quantity(k));
+                    book.add_order(id++, SELL, 10001 + Price(2 * l), 10 + Quantity(k));
+                }
+            }
+            // partial fills and an amend, so remaining differs from quantity
+            ExecutionRing executions;
+            book.add_order(id++, SELL, 9999, 15, executions);
+            book.modify_order(2, 10003, 4);
+
+            std::vector<SnapshotOrder> exported;
+            book.export_orders(exported);
+            CHECK(exported.size() == book.get_bid_count() + book.get_ask_count());
+
+            Book loaded("AAPL");
+            bool restored_orders = loaded.load_orders(exported.data(), exported.size());
+            CHECK(restored_orders);
+            CHECK(loaded.check_invariants());
+            restored_orders = loaded.load_orders(exported.data(), exported.size());     // not empty any more
+            CHECK(!restored_orders);
+
+            std::vector<SnapshotOrder> reexported;
+            loaded.export_orders(reexported);
+            CHECK(reexported.size() == exported.size());
+            for (size_t i = 0; i < exported.size(); ++i) {
+                CHECK(reexported[i].order_id == exported[i].order_id && reexported[i].price == exported[i].price);
+                CHECK(reexported[i].quantity == exported[i].quantity);
+                CHECK(reexported[i].remaining_quantity == exported[i].remaining_quantity);
+            }
+            CHECK(loaded.get_best_bid() == book.get_best_bid() && loaded.get_best_ask() == book.get_best_ask());
+            CHECK(loaded.get_best_bid_size() == book.get_best_bid_size());
+            CHECK(loaded.get_available_quantity(SELL, 10100) == book.get_available_quantity(SELL, 10100));
+            CHECK(loaded.get_top_of_book().bid_price == book.get_best_bid());
+
+            // the same churn on both keeps them identical
+            std::uniform_int_distribution<Price> near(9900, 10100);
+            ExecutionRing loaded_executions;
+            executions.clear();
+            for (Order::OrderId next = id; next < id + 2000; ++next) {
+                Side side = side_dist(rng) == 0 ? BUY : SELL;
+                Price price = near(rng);
+                Quantity qty = qty_dist(rng);
+                book.add_order(next, side, price, qty, executions);
+                loaded.add_order(next, side, price, qty, loaded_executions);
+                Order::OrderId victim = Order::OrderId(rng() % next);
+                bool cancelled = book.cancel_order(victim);
+                bool loaded_cancelled = loaded.cancel_order(victim);
+                CHECK(cancelled == loaded_cancelled);
+            }
+            CHECK(loaded.check_invariants());
+            CHECK(executions.size() == loaded_executions.size());
+            CHECK(book.get_bid_count() == loaded.get_bid_count() && book.get_ask_count() == loaded.get_ask_count());
+            CHECK(book.get_best_bid() == loaded.get_best_bid() && book.get_best_ask() == loaded.get_best_ask());
+        }
+
+        // a sequence out of price-time order is refused before anything loads
+        std::vector<SnapshotOrder> bad = {{1, 10000, 10, 10, BUY, {}}, {2, 10010, 10, 10, BUY, {}}};
+        Book book("AAPL");
+        bool restored_orders = book.load_orders(bad.data(), bad.size());
+        CHECK(!restored_orders);
+        bad = {{1, 10000, 10, 10, SELL, {}}, {2, 9990, 10, 10, BUY, {}}};
+        restored_orders = book.load_orders(bad.data(), bad.size());
+        CHECK(!restored_orders);
+        bad = {{1, 10000, 10, 11, BUY, {}}};
+        restored_orders = book.load_orders(bad.data(), bad.size());
+        CHECK(!restored_orders);
+        CHECK(book.get_bid_count() == 0 && book.check_invariants());
+
+        std::cout << "✓ Snapshot round trip test passed" << std::endl;
+    }
+
+    template <typename Book>
+    void test_match_on_arrival() {
+        std::cout << "\n=== Test: Match on Arrival ===" << std::endl;
+
+        Book book("AAPL");
+        std::vector<Trade> trades;
+
+        book.add_order(1, SELL, 10000, 50);
+        book.add_order(2, SELL, 10001, 30);
+        book.add_order(3, SELL, 10002, 40);
+
+        // walks the asks up to its limit, trading at the resting prices,
+        // and only the remainder rests
+        bool added = book.add_order(10, BUY, 10001, 100, trades);
+        CHECK(added);
+        CHECK(trades.size() == 2);
+        CHECK(trades[0].get_buy_order_id() == 10 && trades[0].get_sell_order_id() == 1);
+        CHECK(trades[0].get_price() == 10000 && trades[0].get_quantity() == 50);
+        CHECK(trades[1].get_sell_order_id() == 2);
+        CHECK(trades[1].get_price() == 10001 && trades[1].get_quantity() == 30);
+        CHECK(book.find_order(1) == nullptr && book.find_order(2) == nullptr);
+        CHECK(book.find_order(10)->get_remaining_quantity() == 20);
+        CHECK(book.get_best_bid() == 10001 && book.get_best_bid_size() == 20);
+        CHECK(book.get_best_ask() == 10002);
+        std::vector<Trade> crossed = book.match_orders();
+        CHECK(crossed.empty());   // never left crossed
+
+        // a fully filled order never rests
+        trades.clear();
+        added = book.add_order(11, SELL, 9000, 20, trades);
+        CHECK(added);
+        CHECK(trades.size() == 1);
+        CHECK(trades[0].get_buy_order_id() == 10 && trades[0].get_price() == 10001);
+        CHECK(book.find_order(11) == nullptr);
+        CHECK(book.get_best_bid() == 0 && book.get_bid_count() == 0);
+
+        // a passive order just rests, duplicates and empty orders are refused
+        trades.clear();
+        added = book.add_order(12, BUY, 9990, 10, trades);
+        CHECK(added);
+        CHECK(trades.empty() && book.get_best_bid() == 9990);
+        added = book.add_order(12, BUY, 10005, 10, trades);
+        CHECK(!added);
+        added = book.add_order(13, BUY, 10005, 0, trades);
+        CHECK(!added);
+        CHECK(trades.empty());
+        CHECK(book.check_invariants());
+
+        // randomized: same fills and final book as resting then matching
+        Book continuous("AAPL");
+        Book on_demand("AAPL");
+        std::uniform_int_distribution<Price> near(9950, 10050);
+        for (Order::OrderId id = 100; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            Price price = near(rng);
+            Quantity qty = qty_dist(rng);
+
+            trades.clear();
+            continuous.add_order(id, side, price, qty, trades);
+            on_demand.add_order(id, side, price, qty);
+            auto expected = on_demand.match_orders();
+
+            CHECK(trades.size() == expected.size());
+            for (size_t i = 0; i < trades.size(); ++i) {
+                CHECK(trades[i].get_buy_order_id() == expected[i].get_buy_order_id());
+                CHECK(trades[i].get_sell_order_id() == expected[i].get_sell_order_id());
+                CHECK(trades[i].get_quantity() == expected[i].get_quantity());
+            }
+            if (id % 5 == 0) {
+                continuous.cancel_order(id - 40);
+                on_demand.cancel_order(id - 40);
+            }
+        }
+        CHECK(continuous.check_invariants());
+        auto bids = continuous.get_bid_levels(50);
+        auto expected_bids = on_demand.get_bid_levels(50);
+        CHECK(bids.size() == expected_bids.size());
+        for (size_t i = 0; i < bids.size(); ++i) {
+            CHECK(bids[i].price == expected_bids[i].price && bids[i].quantity == expected_bids[i].quantity);
+        }
+        CHECK(continuous.get_best_ask() == on_demand.get_best_ask());
+        CHECK(continuous.get_ask_count() == on_demand.get_ask_count());
+
+        std::cout << "✓ Match on arrival test passed" << std::endl;
+    }
+
+    template <typename Book>
+    void test_modify_order() {
+        std::cout << "\n=== Test: Modify Order ===" << std::endl;
+
+        Book book("AAPL");
+        book.add_order(1, BUY, 10000, 100);
+        book.add_order(2, BUY, 10000, 50);
+        book.add_order(3, BUY, 9900, 70);
+        const Order* original = book.find_order(1);
+
+        // quantity down keeps the order (same object) at the head of the queue
+        const Order* amended = book.modify_order(1, 10000, 40);
+        CHECK(amended == original);
+        CHECK(amended->get_remaining_quantity() == 40 && amended->get_price() == 10000);
+        CHECK(book.get_best_bid_size() == 90);
+        CHECK(book.get_available_quantity(BUY, 9900) == 160);
+
+        // quantity up loses priority to order 2
+        amended = book.modify_order(1, 10000, 60);
+        CHECK(amended == original);
+        CHECK(book.get_best_bid_size() == 110);
+        book.add_order(10, SELL, 10000, 50);
+        std::vector<Trade> trades = book.match_orders();
+        CHECK(trades.size() == 1 && trades[0].get_buy_order_id() == 2);
+
+        // a price change moves the order to the back of the new level, and
+        // the old level goes once empty
+        amended = book.modify_order(1, 9900, 60);
+        CHECK(amended == original);
+        CHECK(book.get_best_bid() == 9900 && book.get_best_bid_size() == 130);
+        CHECK(book.get_bid_levels().size() == 1);
+        book.add_order(11, SELL, 9900, 80);
+        trades = book.match_orders();
+        CHECK(trades.size() == 2 && trades[0].get_buy_order_id() == 3 && trades[1].get_buy_order_id() == 1);
+        CHECK(book.find_order(1)->get_remaining_quantity() == 50);
+        CHECK(book.find_order(1)->get_status() == PARTIALLY_FILLED);
+
+        // a better price becomes the new best
+        amended = book.modify_order(1, 10050, 50);
+        CHECK(amended != nullptr);
+        CHECK(book.get_best_bid() == 10050 && book.get_bid_count() == 1);
+
+        // unknown ids and empty quantities are refused
+        amended = book.modify_order(99, 10000, 10);
+        CHECK(amended == nullptr);
+        amended = book.modify_order(1, 10000, 0);
+        CHECK(amended == nullptr);
+        CHECK(book.find_order(1)->get_price() == 10050);
+        CHECK(book.check_invariants());
+
+        // randomized amends keep every aggregate consistent
+        std::uniform_int_distribution<Price> near(9950, 10050);
+        for (Order::OrderId id = 100; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            book.add_order(id, side, side == BUY ? near(rng) - 60 : near(rng) + 60, qty_dist(rng));
+            if (id % 2 == 0) {
+                Order::OrderId target = id - 30;
+                if (const Order* order = book.find_order(target)) {
+                    Price price = order->get_side() == BUY ? near(rng) - 60 : near(rng) + 60;
+                    Quantity qty = qty_dist(rng);
+                    const Order* result = book.modify_order(target, price, qty);
+                    CHECK(result == order && result->get_price() == price && result->get_remaining_quantity() == qty);
+                }
+            }
+            if (id % 50 == 0) {
+                CHECK(book.check_invariants());
+            }
+        }
+        CHECK(book.check_invariants());
+
+        std::cout << "✓ Modify order test passed" << std::endl;
+    }
+
+    // continuous mode: an amend across the spread trades before it rests,
+    // so the book never stays crossed
+    template <typename Book>
+    void test_crossing_amend() {
+        std::cout << "\n=== Test: Crossing Amend ===" << std::endl;
+
+        Book book("AAPL");
+        ExecutionRing executions;
+        book.add_order(1, SELL, 10500, 50, executions);
+        book.add_order(2, SELL, 10600, 30, executions);
+        book.add_order(3, BUY, 10000, 100, executions);
+        CHECK(executions.empty());
+
+        // a bid amended through both asks fills against them, best first,
+        // and the remainder rests at its new price
+        bool amended = book.modify_order(3, 11000, 100, executions);
+        CHECK(amended);
+        CHECK(executions.size() == 2);
+        CHECK(executions[0].buy_order_id == 3 && executions[0].sell_order_id == 1 &&
+               executions[0].price == 10500 && executions[0].quantity == 50);
+        CHECK(executions[1].sell_order_id == 2 && executions[1].price == 10600 && executions[1].quantity == 30);
+        CHECK(book.get_best_bid() == 11000 && book.get_best_bid_size() == 20 && book.get_best_ask() == 0);
+        CHECK(book.find_order(3)->get_remaining_quantity() == 20);
+        CHECK(book.find_order(3)->get_status() == PARTIALLY_FILLED);
+        CHECK(book.get_ask_count() == 0 && book.get_bid_count() == 1);
+
+        // an ask amended down into the bid trades at the bid's price
+        executions.clear();
+        book.add_order(4, SELL, 13000, 5, executions);
+        amended = book.modify_order(4, 10000, 5, executions);
+        CHECK(amended);
+        CHECK(executions.size() == 1 && executions[0].buy_order_id == 3 && executions[0].sell_order_id == 4);
+        CHECK(executions[0].price == 11000 && executions[0].quantity == 5);
+        CHECK(book.find_order(4) == nullptr && book.find_order(3)->get_remaining_quantity() == 15);
+
+        // filled in full, the amended order leaves the book
+        executions.clear();
+        book.add_order(5, SELL, 12000, 40, executions);
+        book.add_order(6, BUY, 10000, 10, executions);
+        amended = book.modify_order(6, 12500, 10, executions);
+        CHECK(amended);
+        CHECK(executions.size() == 1 && executions[0].buy_order_id == 6 && executions[0].price == 12000);
+        CHECK(book.find_order(6) == nullptr && book.get_bid_count() == 1 && book.get_best_ask_size() == 30);
+
+        // amends that do not cross, and refused ones, trade nothing
+        executions.clear();
+        amended = book.modify_order(3, 11500, 15, executions);
+        CHECK(amended && book.get_best_bid() == 11500);
+        amended = book.modify_order(3, 11500, 10, executions);
+        CHECK(amended);
+        amended = book.modify_order(99, 12000, 10, executions);
+        CHECK(!amended);
+        amended = book.modify_order(3, 12000, 0, executions);
+        CHECK(!amended);
+        CHECK(executions.empty());
+
+        // random amends never leave the book crossed
+        std::uniform_int_distribution<Price> near(9900, 10100);
+        for (Order::OrderId id = 100; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            book.add_order(id, side, side == BUY ? near(rng) - 50 : near(rng) + 50, qty_dist(rng), executions);
+            if (const Order* order = book.find_order(id - 1 - rng() % 50)) {
+                book.modify_order(order->get_order_id(), near(rng), qty_dist(rng), executions);
+            }
+            CHECK(book.get_best_bid() == 0 || book.get_best_ask() == 0 || book.get_best_bid() < book.get_best_ask());
+            executions.clear();
+        }
+        CHECK(book.check_invariants());
+
+        std::cout << "✓ Crossing amend test passed" << std::endl;
+    }
+
+    // a batch rests exactly like the same orders added one at a time
+    template <typename Book>
+    void test_add_orders() {
+        std::cout << "\n=== Test: Batched Add ===" << std::endl;
+
+        Book batched("AAPL");
+        Book single("AAPL");
+        std::uniform_int_distribution<Price> near(9990, 10010);
+        std::vector<OrderMessage> batch;
+        Order::OrderId id = 1;
+
+        for (int round = 0; round < 40; ++round) {
+            batch.clear();
+            for (int i = 0; i < 64; ++i) {
+                Side side = side_dist(rng) == 0 ? BUY : SELL;
+                Price price = side == BUY ? near(rng) - 15 : near(rng) + 15;
+                batch.push_back(OrderMessage{0, side, id++, price, qty_dist(rng)});
+            }
+            // an empty order, a repeat inside the batch and an id that already rests
+            batch.push_back(OrderMessage{0, BUY, id++, 9990, 0});
+            batch.push_back(batch[3]);
+            batch.push_back(OrderMessage{0, SELL, 1, 10020, 10});
+
+            size_t accepted = 0;
+            for (const OrderMessage& message : batch) {
+                accepted += single.add_order(message.order_id, message.side, message.price, message.quantity);
+            }
+            size_t batch_accepted = batched.add_orders(batch.data(), batch.size());
+            CHECK(batch_accepted == accepted);
+            CHECK(accepted == 64 || round == 0);
+            CHECK(batched.check_invariants());
+        }
+
+        auto same_levels = [](const std::vector<OrderBook::Level>& a, const std::vector<OrderBook::Level>& b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].price != b[i].price || a[i].quantity != b[i].quantity ||
+                    a[i].order_count != b[i].order_count) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        CHECK(same_levels(batched.get_bid_levels(100), single.get_bid_levels(100)));
+        CHECK(same_levels(batched.get_ask_levels(100), single.get_ask_levels(100)));
+        CHECK(batched.get_bid_count() == single.get_bid_count());
+        CHECK(batched.get_total_orders() == single.get_total_orders());
+
+        // and queues in the same time priority
+        std::vector<Trade> batched_trades;
+        std::vector<Trade> single_trades;
+        batched.add_order(id, BUY, 20000, 1000000, MARKET, batched_trades);
+        single.add_order(id, BUY, 20000, 1000000, MARKET, single_trades);
+        CHECK(batched_trades.size() == single_trades.size());
+        for (size_t i = 0; i < batched_trades.size(); ++i) {
+            CHECK(batched_trades[i].get_sell_order_id() == single_trades[i].get_sell_order_id());
+        }
+
+        std::cout << "✓ Batched add test passed" << std::endl;
+    }
+
+    template <typename Book>
+    void test_order_types() {
+        std::cout << "\n=== Test: Market, IOC and FOK Orders ===" << std::endl;
+
+        Book book("AAPL");
+        std::vector<Trade> trades;
+
+        book.add_order(1, SELL, 10000, 50);
+        book.add_order(2, SELL, 10001, 30);
+        book.add_order(3, SELL, 10005, 40);
+        book.add_order(4, BUY, 9990, 25);
+
+        // FOK that the asks inside its limit cannot cover is refused and
+        // leaves the book exactly as it was
+        bool added = book.add_order(10, BUY, 10001, 81, FOK, trades);
+        CHECK(!added);
+        CHECK(trades.empty());
+        CHECK(book.get_best_ask() == 10000 && book.get_best_ask_size() == 50);
+        CHECK(book.get_ask_count() == 3 && book.get_total_orders() == 4);
+
+        // a coverable FOK fills in full and never rests
+        added = book.add_order(11, BUY, 10001, 60, FOK, trades);
+        CHECK(added);
+        CHECK(trades.size() == 2 && trades[1].get_sell_order_id() == 2 && trades[1].get_quantity() == 10);
+        CHECK(book.find_order(11) == nullptr && book.get_best_bid() == 9990);
+
+        // IOC trades what it can inside its limit and drops the rest
+        trades.clear();
+        added = book.add_order(12, BUY, 10001, 50, IOC, trades);
+        CHECK(added);
+        CHECK(trades.size() == 1 && trades[0].get_quantity() == 20);
+        CHECK(book.find_order(12) == nullptr && book.get_best_ask() == 10005);
+        added = book.add_order(13, BUY, 10001, 50, IOC, trades);   // nothing left inside 10001
+        CHECK(!added);
+        CHECK(trades.size() == 1 && book.get_best_bid() == 9990);
+
+        // market orders ignore the price and sweep the other side
+        trades.clear();
+        added = book.add_order(14, BUY, 0, 100, MARKET, trades);
+        CHECK(added);
+        CHECK(trades.size() == 1 && trades[0].get_price() == 10005 && trades[0].get_quantity() == 40);
+        CHECK(book.get_best_ask() == 0 && book.find_order(14) == nullptr);
+        added = book.add_order(15, SELL, 0, 10, MARKET, trades);
+        CHECK(added);
+        CHECK(trades.back().get_buy_order_id() == 4 && trades.back().get_price() == 9990);
+        added = book.add_order(16, BUY, 0, 10, MARKET, trades);     // no asks left
+        CHECK(!added);
+        CHECK(book.check_invariants());
+
+        // order objects carry their type; only limit orders can rest
+        added = book.add_order(std::make_shared<Order>(17, BUY, 9990, 10, book.get_symbol_id(), IOC));
+        CHECK(!added);
+        added = book.add_order(std::make_shared<Order>(18, BUY, 9990, 10, book.get_symbol_id()));
+        CHECK(added);
+
+        std::cout << "✓ Market, IOC and FOK orders test passed" << std::endl;
+    }
+
+    // the quantity query against a brute-force sum over the depth snapshot,
+    // while adds, fills and cancels (and splits and merges) reshape the book
+    template <typename Book>
+    void test_available_quantity() {
+        std::cout << "\n=== Test: Available Quantity ===" << std::endl;
+
+        Book book("AAPL");
+        std::vector<Trade> trades;
+        auto brute_force = [&book](Side side, Price limit) {
+            Quantity total = 0;
+            for (const auto& level : side == BUY ? book.get_bid_levels(100000) : book.get_ask_levels(100000)) {
+                if (side == BUY ? level.price >= limit : level.price <= limit) {
+                    total += level.quantity;
+                }
+            }
+            return total;
+        };
+
+        CHECK(book.get_available_quantity(BUY, 0) == 0);
+        CHECK(book.get_available_quantity(SELL, std::numeric_limits<Price>::max()) == 0);
+
+        std::uniform_int_distribution<Price> wide(9000, 11000);
+        std::uniform_int_distribution<Price> probe(8900, 11100);
+        for (Order::OrderId id = 1; id < 6000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            Price price = wide(rng);
+            if (id % 4 == 0) {
+                book.add_order(id, side, price, qty_dist(rng), trades);
+            } else {
+                book.add_order(id, side, side == BUY ? std::min<Price>(price, 9999) : std::max<Price>(price, 10001),
+                               qty_dist(rng));
+            }
+            if (id % 3 == 0) {
+                book.cancel_order(id - 40);
+            }
+            if (id % 100 == 0) {
+                for (int i = 0; i < 10; ++i) {
+                    Price limit = probe(rng);
+                    CHECK(book.get_available_quantity(BUY, limit) == brute_force(BUY, limit));
+                    CHECK(book.get_available_quantity(SELL, limit) == brute_force(SELL, limit));
+                }
+                CHECK(book.check_invariants());
+            }
+        }
+
+        // exact level prices are inclusive
+        Price ask = book.get_best_ask();
+        CHECK(book.get_available_quantity(SELL, ask) == book.get_best_ask_size());
+        CHECK(book.get_available_quantity(SELL, ask - 1) == 0);
+
+        std::cout << "✓ Available quantity test passed" << std::endl;
+    }
+
+    template <typename Book>
+    void test_level_aggregates() {
+        std::cout << "\n=== Test: Level Aggregates ===" << std::endl;
+
+        Book book("AAPL");
+
+        book.add_order(1, SELL, 10100, 100);
+        book.add_order(2, SELL, 10100, 200);
+        book.add_order(3, SELL, 10100, 300);
+        book.add_order(4, SELL, 10200, 400);
+
+        // partial fill of the head order
+        book.add_order(5, BUY, 10100, 60);
+        book.match_orders();
+        auto levels = book.get_ask_levels(10);
+        CHECK(levels.size() == 2);
+        CHECK(levels[0].quantity == 540 && levels[0].order_count == 3);
+        CHECK(levels[1].quantity == 400 && levels[1].order_count == 1);
+
+        // cancel takes out the order's remaining quantity only
+        bool cancelled = book.cancel_order(1);
+        CHECK(cancelled);
+        levels = book.get_ask_levels(10);
+        CHECK(levels[0].quantity == 500 && levels[0].order_count == 2);
+        CHECK(book.get_best_ask_size() == 500);
+
+        // sweep through the first level into the second
+        book.add_order(6, BUY, 10200, 550);
+        book.match_orders();
+        levels = book.get_ask_levels(10);
+        CHECK(levels.size() == 1);
+        CHECK(levels[0].price == 10200 && levels[0].quantity == 350 && levels[0].order_count == 1);
+        CHECK(book.check_invariants());
+
+        std::cout << "✓ Level aggregates test passed" << std::endl;
+    }
+
+    template <typename Book>
     void test_market_data_queries() {
         std::cout << "\n=== Test: Market Data Queries ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
 
         // Empty book
-        assert(book.get_best_bid() == 0.0);
-        assert(book.get_best_ask() == 0.0);
-        assert(book.get_total_orders() == 0);
+        CHECK(book.get_best_bid() == 0);
+        CHECK(book.get_best_ask() == 0);
+        CHECK(book.get_total_orders() == 0);
 
         // Add orders
-        book.add_order(std::make_shared<Order>(1, BUY, 99.0, 100, "AAPL"));
-        book.add_order(std::make_shared<Order>(2, BUY, 100.0, 200, "AAPL"));
-        book.add_order(std::make_shared<Order>(3, SELL, 101.0, 150, "AAPL"));
-        book.add_order(std::make_shared<Order>(4, SELL, 102.0, 250, "AAPL"));
+        book.add_order(1, BUY, 9900, 100);
+        book.add_order(2, BUY, 10000, 200);
+        book.add_order(3, SELL, 10100, 150);
+        book.add_order(4, SELL, 10200, 250);
 
-        assert(book.get_best_bid() == 100.0);
-        assert(book.get_best_ask() == 101.0);
-        assert(book.get_bid_count() == 2);
-        assert(book.get_ask_count() == 2);
-        assert(book.get_total_orders() == 4);
+        CHECK(book.get_best_bid() == 10000);
+        CHECK(book.get_best_ask() == 10100);
+        CHECK(book.get_bid_count() == 2);
+        CHECK(book.get_ask_count() == 2);
+        CHECK(book.get_total_orders() == 4);
 
         // Get levels
         auto bid_levels = book.get_bid_levels(10);
-        assert(bid_levels.size() == 2);
-        assert(bid_levels[0].price == 100.0);
-        assert(bid_levels[0].quantity == 200.0);
-        assert(bid_levels[1].price == 99.0);
-        assert(bid_levels[1].quantity == 100.0);
+        CHECK(bid_levels.size() == 2);
+        CHECK(bid_levels[0].price == 10000);
+        CHECK(bid_levels[0].quantity == 200);
+        CHECK(bid_levels[1].price == 9900);
+        CHECK(bid_levels[1].quantity == 100);
 
         std::cout << "✓ Market data queries test passed" << std::endl;
     }
 
+    template <typename Book>
+    void test_tick_conversion() {
+        std::cout << "\n=== Test: Tick/Lot Conversion ===" << std::endl;
+
+        Instrument aapl("AAPL", 0.01, 1.0);
+        Book book(aapl);
+
+        // 100.1 and 100.0 + 0.1 differ in the last bit as doubles but
+        // must land on the same tick and therefore the same level
+        Price p1 = aapl.to_ticks(100.1);
+        Price p2 = aapl.to_ticks(100.0 + 0.1);
+        CHECK(p1 == 10010);
+        CHECK(p1 == p2);
+        CHECK(aapl.to_lots(250.0) == 250);
+
+        book.add_order(1, BUY, p1, 100);
+        book.add_order(2, BUY, p2, 100);
+
+        auto bid_levels = book.get_bid_levels(10);
+        CHECK(bid_levels.size() == 1);
+        CHECK(bid_levels[0].order_count == 2);
+        CHECK(bid_levels[0].quantity == 200);
+        CHECK(aapl.to_price(bid_levels[0].price) > 100.09 && aapl.to_price(bid_levels[0].price) < 100.11);
+
+        std::cout << "✓ Tick/lot conversion test passed" << std::endl;
+    }
+
+    template <typename Book>
     void test_stress_random_orders() {
         std::cout << "\n=== Test: Stress Test with Random Orders ===" << std::endl;
 
-        BTreeOrderBook book("AAPL");
+        Book book("AAPL");
         const int num_orders = 10000;
 
         Timer timer;
@@ -158,11 +1322,10 @@ public:
         // Add random orders
         for (int i = 0; i < num_orders; ++i) {
             Side side = side_dist(rng) == 0 ? BUY : SELL;
-            double price = price_dist(rng);
-            double qty = qty_dist(rng);
+            Price price = price_dist(rng);
+            Quantity qty = qty_dist(rng);
 
-            auto order = std::make_shared<Order>(i, side, price, qty, "AAPL");
-            book.add_order(order);
+            book.add_order(i, side, price, qty);
         }
 
         double add_time = timer.elapsed_milliseconds();
@@ -182,16 +1345,359 @@ public:
         std::cout << "✓ Stress test completed" << std::endl;
     }
 
+    void test_ladder_window() {
+        std::cout << "\n=== Test: Price Ladder Window ===" << std::endl;
+
+        PriceLadderOrderBook book("AAPL", 256);
+
+        // first order centers the window on its price
+        book.add_order(1, BUY, 10000, 10);
+        CHECK(book.get_window_size(BUY) == 256);
+        CHECK(book.get_window_base(BUY) == 10000 - 128);
+
+        // levels far apart in the bitmap are still found in order
+        book.add_order(2, BUY, 9900, 20);
+        book.add_order(3, BUY, 9999, 30);
+        auto levels = book.get_bid_levels(10);
+        CHECK(levels.size() == 3);
+        CHECK(levels[0].price == 10000 && levels[1].price == 9999 && levels[2].price == 9900);
+
+        // a price outside the window grows it around the resting orders
+        book.add_order(4, BUY, 10300, 40);
+        CHECK(book.get_window_size(BUY) >= 512);
+        CHECK(book.get_best_bid() == 10300);
+        CHECK(book.get_level_count(BUY) == 4);
+        CHECK(book.check_invariants());
+
+        // queues survive the relocation with their priority intact
+        bool cancelled = book.cancel_order(4);
+        CHECK(cancelled);
+        book.add_order(5, BUY, 10000, 5);
+        book.add_order(6, SELL, 10000, 12);
+        auto trades = book.match_orders();
+        CHECK(trades.size() == 2);
+        CHECK(trades[0].get_buy_order_id() == 1);
+        CHECK(trades[1].get_buy_order_id() == 5);
+
+        // once a side is empty the window just recenters
+        for (Order::OrderId id : {2, 3, 5}) {
+            book.cancel_order(id);
+        }
+        CHECK(book.get_bid_count() == 0);
+        book.add_order(7, BUY, 50000, 10);
+        CHECK(book.get_best_bid() == 50000);
+        CHECK(book.get_window_base(BUY) + Price(book.get_window_size(BUY) / 2) == 50000);
+
+        // but a price the window could never reach from the resting book is refused
+        Price too_far = 50000 + Price(book.get_max_window_ticks());
+        bool added = book.add_order(8, BUY, too_far, 10);
+        CHECK(!added);
+        CHECK(book.check_invariants());
+
+        // and so is an amend to it, which leaves the order where it was
+        book.add_order(9, BUY, 50000, 5);
+        const Order* amended = book.modify_order(7, too_far, 10);
+        CHECK(amended == nullptr);
+        CHECK(book.find_order(7)->get_price() == 50000);
+        book.add_order(10, SELL, 50000, 10);
+        trades = book.match_orders();
+        CHECK(trades.size() == 1 && trades[0].get_buy_order_id() == 7);
+
+        // an amend that relocates the window keeps the order's own level
+        amended = book.modify_order(9, 50600, 5);
+        CHECK(amended != nullptr);
+        CHECK(book.get_best_bid() == 50600 && book.get_level_count(BUY) == 1);
+        CHECK(book.check_invariants());
+
+        // prices out at the ends of the Price range are refused, not hung on
+        // or wrapped around
+        const Price extremes[] = {Price(6900000000000000000LL), -Price(6900000000000000000LL),
+                                  std::numeric_limits<Price>::max(), std::numeric_limits<Price>::min()};
+        for (Price extreme : extremes) {
+            added = book.add_order(11, BUY, extreme, 10);
+            CHECK(!added);
+            amended = book.modify_order(9, extreme, 5);
+            CHECK(amended == nullptr);
+        }
+        PriceLadderOrderBook empty("AAPL", 256);
+        added = empty.add_order(1, SELL, std::numeric_limits<Price>::max(), 10);
+        CHECK(!added);
+        added = empty.add_order(1, SELL, std::numeric_limits<Price>::min(), 10);
+        CHECK(!added);
+        added = empty.add_order(1, SELL, Price(6900000000000000000LL), 10);
+        CHECK(added);
+        added = empty.add_order(2, SELL, 10000, 10);
+        CHECK(!added);
+        CHECK(empty.get_ask_count() == 1 && empty.check_invariants());
+        CHECK(book.get_best_bid() == 50600 && book.check_invariants());
+
+        // a limit order whose remainder could not rest is refused before it
+        // trades, rather than filling and dropping the rest; an IOC, which
+        // never rests, still trades
+        PriceLadderOrderBook capped("AAPL", 256, 1024);
+        CHECK(capped.get_max_window_ticks() == 1024);
+        ExecutionRing executions;
+        capped.add_order(1, BUY, 10000, 10, executions);
+        capped.add_order(2, SELL, 10600, 5, executions);
+        added = capped.add_order(3, SELL, 9990, 20, executions);
+        CHECK(!added && executions.empty());
+        CHECK(capped.get_best_bid_size() == 10 && capped.get_ask_count() == 1);
+        added = capped.add_order(4, SELL, 9990, 20, IOC, executions);
+        CHECK(added && executions.size() == 1 && executions[0].quantity == 10);
+        CHECK(capped.get_bid_count() == 0 && capped.check_invariants());
+
+        std::cout << "✓ Price ladder window test passed" << std::endl;
+    }
+
+    void test_key_search() {
+        std::cout << "\n=== Test: Node Key Search (" << key_search_isa() << ") ===" << std::endl;
+
+        // every node size up to degree 64, including the odd tails after
+        // the last full SIMD block, against std::lower_bound
+        std::uniform_int_distribution<Price> key_dist(-1000, 1000);
+        for (size_t n = 0; n <= 127; ++n) {
+            std::vector<Price> keys(n);
+            for (auto& key : keys) {
+                key = key_dist(rng);
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            for (Price probe = -1002; probe <= 1002; probe += 7) {
+                size_t expected = std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+                CHECK(lower_bound_scalar(keys.data(), keys.size(), probe) == expected);
+                CHECK(lower_bound_keys(keys.data(), keys.size(), probe) == expected);
+            }
+        }
+
+        // comparisons are signed 64-bit
+        std::vector<Price> extremes = {std::numeric_limits<Price>::min(), -1, 0, 1,
+                                       std::numeric_limits<Price>::max()};
+        CHECK(lower_bound_keys(extremes.data(), extremes.size(), std::numeric_limits<Price>::min()) == 0);
+        CHECK(lower_bound_keys(extremes.data(), extremes.size(), 0) == 2);
+        CHECK(lower_bound_keys(extremes.data(), extremes.size(), std::numeric_limits<Price>::max()) == 4);
+
+        // fixed-width search over padded slots, as used by the B-tree nodes
+        std::vector<Price> padded(8, std::numeric_limits<Price>::max());
+        padded[0] = 100;
+        padded[1] = 200;
+        padded[2] = 300;
+        CHECK(lower_bound_fixed<8>(padded.data(), 50) == 0);
+        CHECK(lower_bound_fixed<8>(padded.data(), 200) == 1);
+        CHECK(lower_bound_fixed<8>(padded.data(), 250) == 2);
+        CHECK(lower_bound_fixed<8>(padded.data(), 1000) == 3);
+
+        std::cout << "✓ Node key search test passed" << std::endl;
+    }
+
+    void test_order_storage() {
+        std::cout << "\n=== Test: Order Pool and Id Index ===" << std::endl;
+
+        // freed slots are handed out again before the pool grows
+        ObjectPool<Order> pool;
+        Order* first = pool.create(1, BUY, 10000, 10, 0);
+        Order* second = pool.create(2, SELL, 10100, 20, 0);
+        size_t capacity = pool.capacity();
+        pool.destroy(first);
+        Order* third = pool.create(3, BUY, 9900, 30, 0);
+        CHECK(third == first);
+        CHECK(third->get_order_id() == 3 && second->get_order_id() == 2);
+        CHECK(pool.size() == 2 && pool.capacity() == capacity);
+        pool.destroy(second);
+        pool.destroy(third);
+
+        // heavy insert/erase churn over a small id range keeps long probe
+        // runs wrapping around the table - check against std::unordered_map
+        FlatIdMap<Order> index;
+        std::unordered_map<Order::OrderId, Order*> expected;
+        std::vector<Order> values;
+        values.reserve(512);
+        for (Order::OrderId id = 0; id < 512; ++id) {
+            values.emplace_back(id, BUY, 10000, 1, 0);
+        }
+        std::uniform_int_distribution<Order::OrderId> id_dist(0, 511);
+        for (int i = 0; i < 20000; ++i) {
+            Order::OrderId id = id_dist(rng);
+            if (side_dist(rng) == 0) {
+                bool inserted = index.insert(id, &values[id]);
+                bool expected_inserted = expected.emplace(id, &values[id]).second;
+                CHECK(inserted == expected_inserted);
+            } else {
+                Order* removed = index.erase(id);
+                auto itr = expected.find(id);
+                CHECK(removed == (itr == expected.end() ? nullptr : itr->second));
+                if (itr != expected.end()) {
+                    expected.erase(itr);
+                }
+            }
+            CHECK(index.size() == expected.size());
+        }
+        for (Order::OrderId id = 0; id < 512; ++id) {
+            auto itr = expected.find(id);
+            CHECK(index.find(id) == (itr == expected.end() ? nullptr : itr->second));
+        }
+
+        // a reserved index does not grow while the working set fits
+        FlatIdMap<Order> reserved;
+        reserved.reserve(1000);
+        capacity = reserved.capacity();
+        for (Order::OrderId id = 0; id < 1000; ++id) {
+            reserved.insert(id * 4096, &values[id % 512]);
+        }
+        CHECK(reserved.capacity() == capacity);
+
+        std::cout << "✓ Order pool and id index test passed" << std::endl;
+    }
+
+    // the execution ring, the inlined sink and the vector adapter report
+    // the same fills for the same flow
+    template <typename Book>
+    void test_execution_sinks() {
+        std::cout << "\n=== Test: Execution Sinks ===" << std::endl;
+
+        Book ring_book("AAPL");
+        Book sink_book("AAPL");
+        Book trade_book("AAPL");
+        ExecutionRing ring(4);    // tiny, so bursts make it grow
+        std::vector<Execution> sunk;
+        std::vector<Trade> trades;
+        auto collect = [&sunk](const Execution& execution) { sunk.push_back(execution); };
+
+        std::uniform_int_distribution<Price> near(9980, 10020);
+        for (Order::OrderId id = 1; id < 3000; ++id) {
+            Side side = side_dist(rng) == 0 ? BUY : SELL;
+            Price price = near(rng);
+            Quantity qty = qty_dist(rng);
+            if (id % 5 == 0) {
+                // resting only, matched in a batch below
+                ring_book.add_order(id, side, price, qty);
+                sink_book.add_order(id, side, price, qty);
+                trade_book.add_order(id, side, price, qty);
+            } else {
+                bool accepted = ring_book.add_order(id, side, price, qty, ring);
+                bool sink_accepted = sink_book.add_order_with(id, side, price, qty, collect);
+                bool trade_accepted = trade_book.add_order(id, side, price, qty, trades);
+                CHECK(sink_accepted == accepted && trade_accepted == accepted);
+            }
+            if (id % 50 == 0) {
+                ring_book.match_orders(ring);
+                sink_book.match_orders_with(collect);
+                trade_book.match_orders(trades);
+            }
+        }
+
+        CHECK(ring.size() == sunk.size() && trades.size() == sunk.size());
+        CHECK(ring.capacity() >= ring.size());
+        for (size_t i = 0; i < sunk.size(); ++i) {
+            const Execution& execution = ring[i];
+            CHECK(execution.buy_order_id == sunk[i].buy_order_id);
+            CHECK(execution.sell_order_id == sunk[i].sell_order_id);
+            CHECK(execution.price == sunk[i].price && execution.quantity == sunk[i].quantity);
+            CHECK(trades[i].get_buy_order_id() == sunk[i].buy_order_id);
+            CHECK(trades[i].get_sell_order_id() == sunk[i].sell_order_id);
+            CHECK(trades[i].get_price() == sunk[i].price && trades[i].get_quantity() == sunk[i].quantity);
+        }
+
+        // draining hands the executions over oldest first and empties the ring
+        size_t drained = 0;
+        ring.drain([&](const Execution& execution) {
+            CHECK(execution.buy_order_id == sunk[drained].buy_order_id);
+            ++drained;
+        });
+        CHECK(drained == sunk.size() && ring.empty());
+        CHECK(ring_book.get_total_orders() == sink_book.get_total_orders());
+        CHECK(ring_book.check_invariants() && sink_book.check_invariants());
+
+        std::cout << "✓ Execution sinks test passed" << std::endl;
+    }
+
+    void test_ring_buffer() {
+        std::cout << "\n=== Test: Ring Buffer ===" << std::endl;
+
+        // wraps around in place, and grows keeping FIFO order once full
+        RingBuffer<int> ring(3);
+        CHECK(ring.capacity() == 4);
+        int next_in = 0;
+        int next_out = 0;
+        int item;
+        for (int round = 0; round < 10; ++round) {
+            ring.push(next_in++);
+            ring.push(next_in++);
+            ring.push(next_in++);
+            bool popped = ring.pop(item);
+            CHECK(popped && item == next_out);
+            popped = ring.pop(item);
+            CHECK(popped && item == next_out + 1);
+            next_out += 2;
+            CHECK(ring.front() == next_out);
+            popped = ring.pop(item);
+            CHECK(popped && item == next_out);
+            ++next_out;
+        }
+        bool popped = ring.pop(item);
+        CHECK(ring.capacity() == 4 && ring.empty() && !popped);
+
+        ring.push(next_in++);
+        ring.push(next_in++);
+        popped = ring.pop(item);   // head off slot 0
+        CHECK(popped && item == next_out);
+        ++next_out;
+        for (int i = 0; i < 6; ++i) {
+            ring.push(next_in++);
+        }
+        CHECK(ring.capacity() == 8 && ring.size() == 7);
+        for (size_t i = 0; i < ring.size(); ++i) {
+            CHECK(ring[i] == next_out + int(i));
+        }
+        while (ring.pop(item)) {
+            CHECK(item == next_out);
+            ++next_out;
+        }
+        CHECK(next_out == next_in);
+
+        std::cout << "✓ Ring buffer test passed" << std::endl;
+    }
+
+    template <typename Book>
+    void run_book_tests(const char* name) {
+        std::cout << "\n--- " << name << " ---" << std::endl;
+
+        test_basic_matching<Book>();
+        test_price_priority<Book>();
+        test_time_priority<Book>();
+        test_order_cancellation<Book>();
+        test_cancel_within_level<Book>();
+        test_modify_order<Book>();
+        test_crossing_amend<Book>();
+        test_add_orders<Book>();
+        test_top_of_book_cache<Book>();
+        test_published_top_of_book<Book>();
+        test_snapshot_round_trip<Book>();
+        test_depth_feed<Book>();
+        test_order_event_feed<Book>();
+        test_match_on_arrival<Book>();
+        test_execution_sinks<Book>();
+        test_order_types<Book>();
+        test_available_quantity<Book>();
+        test_level_aggregates<Book>();
+        test_market_data_queries<Book>();
+        test_tick_conversion<Book>();
+        test_stress_random_orders<Book>();
+    }
+
     void run_all_tests() {
         std::cout << "Running Order Matching Engine Tests" << std::endl;
         std::cout << "===================================" << std::endl;
 
-        test_basic_matching();
-        test_price_priority();
-        test_time_priority();
-        test_order_cancellation();
-        test_market_data_queries();
-        test_stress_random_orders();
+        run_book_tests<BTreeOrderBook<3>>("BTreeOrderBook<3>");
+        run_book_tests<BTreeOrderBook<>>("BTreeOrderBook<32>");
+        test_level_reclamation();
+        test_key_search();
+        test_order_storage();
+        test_ring_buffer();
+
+        run_book_tests<PriceLadderOrderBook>("PriceLadderOrderBook");
+        test_ladder_window();
 
         std::cout << "\n✓ All tests passed!" << std::endl;
     }
@@ -202,37 +1708,1061 @@ void test_matching_engine() {
 
     MatchingEngine engine;
 
-    // Create order books for multiple symbols
-    engine.create_order_book("AAPL", std::make_unique<BTreeOrderBook>("AAPL"));
-    engine.create_order_book("GOOGL", std::make_unique<BTreeOrderBook>("GOOGL"));
+    // Create order books for multiple symbols - implementation chosen per symbol
+    SymbolId aapl = engine.create_order_book("AAPL", std::make_unique<BTreeOrderBook<>>("AAPL"));
+    SymbolId googl = engine.create_order_book(Instrument("GOOGL"), OrderBookType::PRICE_LADDER);
+    CHECK(dynamic_cast<PriceLadderOrderBook*>(engine.get_order_book("GOOGL")) != nullptr);
+
+    // symbols are interned densely, and re-creating a book keeps the id
+    CHECK(aapl == 0 && googl == 1);
+    CHECK(engine.get_symbol_id("GOOGL") == googl);
+    CHECK(engine.get_symbol(aapl) == "AAPL");
+    CHECK(engine.get_order_book(googl)->get_symbol_id() == googl);
 
     // Test AAPL orders
-    engine.submit_order(std::make_shared<Order>(1, BUY, 150.0, 100, "AAPL"));
-    engine.submit_order(std::make_shared<Order>(2, SELL, 150.0, 50, "AAPL"));
+    bool submitted = engine.submit_order(aapl, 1, BUY, 15000, 100);
+    CHECK(submitted);
+    submitted = engine.submit_order(std::make_shared<Order>(2, SELL, 15000, 50, aapl));
+    CHECK(submitted);
 
-    auto aapl_trades = engine.match_orders("AAPL");
-    assert(aapl_trades.size() == 1);
+    auto aapl_trades = engine.match_orders(aapl);
+    CHECK(aapl_trades.size() == 1);
+    CHECK(aapl_trades[0].get_symbol_id() == aapl);
 
     // Test GOOGL orders
-    engine.submit_order(std::make_shared<Order>(3, BUY, 2800.0, 10, "GOOGL"));
-    engine.submit_order(std::make_shared<Order>(4, SELL, 2799.0, 10, "GOOGL"));
+    engine.submit_order(googl, 3, BUY, 280000, 10);
+    engine.submit_order(googl, 4, SELL, 279900, 10);
 
     auto googl_trades = engine.match_orders("GOOGL");
-    assert(googl_trades.size() == 1);
+    CHECK(googl_trades.size() == 1);
+    CHECK(googl_trades[0].get_symbol_id() == googl);
+
+    // amends route like cancels
+    const Order* amended = engine.modify_order("GOOGL", 3, 280000, 5);   // already filled
+    CHECK(amended == nullptr);
+    submitted = engine.submit_order(googl, 6, BUY, 279000, 10);
+    CHECK(submitted);
+    amended = engine.modify_order(googl, 6, 279500, 4);
+    CHECK(amended->get_price() == 279500);
+    CHECK(engine.get_best_bid(googl) == 279500);
+    bool cancelled = engine.cancel_order(googl, 6);
+    CHECK(cancelled);
+
+    // batches are split into chunks, grouped per book and matched once per
+    // chunk; unknown symbols and bad orders are skipped
+    engine.set_batch_size(3);
+    std::vector<OrderMessage> batch = {
+        {aapl, BUY, 100, 15100, 10}, {googl, SELL, 101, 281000, 5}, {aapl, BUY, 102, 15100, 20},
+        {INVALID_SYMBOL, BUY, 103, 15000, 20}, {aapl, SELL, 104, 14900, 25}, {googl, BUY, 105, 281000, 0},
+    };
+    ExecutionRing batch_executions;
+    size_t accepted = engine.submit_batch(batch, batch_executions);
+    CHECK(accepted == 4);
+    CHECK(batch_executions.size() == 2);
+    CHECK(batch_executions[0].buy_order_id == 100 && batch_executions[1].buy_order_id == 102);
+    CHECK(engine.get_best_bid(aapl) == 15100 && engine.get_order_book(aapl)->get_best_bid_size() == 5);
+    std::vector<CancelMessage> cancels = {{aapl, 102}, {googl, 101}, {googl, 999}, {INVALID_SYMBOL, 1}};
+    size_t batch_cancelled = engine.cancel_batch(cancels);
+    CHECK(batch_cancelled == 2);
+    CHECK(engine.get_best_bid(aapl) == 15000 && engine.get_best_ask(googl) == 0);
+
+    // executions can go to a caller-owned ring instead
+    ExecutionRing executions;
+    submitted = engine.submit_order(googl, 7, SELL, 280000, 5);
+    CHECK(submitted);
+    submitted = engine.submit_order(googl, 8, BUY, 280100, 8, executions);
+    CHECK(submitted);
+    CHECK(executions.size() == 1 && executions.front().sell_order_id == 7);
+    CHECK(executions.front().symbol_id == googl && executions.front().quantity == 5);
+    submitted = engine.submit_order(googl, 9, SELL, 280100, 2);
+    CHECK(submitted);
+    bool matched = engine.match_orders(googl, executions);
+    CHECK(matched && executions.size() == 2);
+    matched = engine.match_orders(INVALID_SYMBOL, executions);
+    CHECK(!matched);
 
     // Test invalid symbol
-    auto invalid_order = std::make_shared<Order>(5, BUY, 100.0, 10, "TSLA");
-    assert(!engine.submit_order(invalid_order));
+    CHECK(engine.get_symbol_id("TSLA") == INVALID_SYMBOL);
+    submitted = engine.submit_order(INVALID_SYMBOL, 5, BUY, 10000, 10);
+    CHECK(!submitted);
+    submitted = engine.submit_order(std::make_shared<Order>(5, BUY, 10000, 10, SymbolId(7)));
+    CHECK(!submitted);
+    cancelled = engine.cancel_order("TSLA", 5);
+    CHECK(!cancelled);
+
+    // an order stamped with another book's id is refused by the adapter
+    bool added = engine.get_order_book(aapl)->add_order(std::make_shared<Order>(6, BUY, 15000, 10, googl));
+    CHECK(!added);
 
     std::cout << "✓ Matching engine integration test passed" << std::endl;
 }
 
+void test_spsc_queue() {
+    std::cout << "\n=== Test: SPSC Queue ===" << std::endl;
+
+    // a small queue so the producer keeps running into a full ring
+    SpscQueue<uint64_t> queue(64);
+    const uint64_t count = 500000;
+    std::thread producer([&queue] {
+        BackoffWait wait;
+        for (uint64_t i = 0; i < count; ++i) {
+            while (!queue.try_push(i)) {
+                wait.wait();
+            }
+            wait.reset();
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t batch[16];
+    BackoffWait wait;
+    while (expected < count) {
+        size_t n = queue.pop_batch(batch, 16);
+        if (n == 0) {
+            wait.wait();
+            continue;
+        }
+        wait.reset();
+        for (size_t i = 0; i < n; ++i) {
+            CHECK(batch[i] == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    CHECK(queue.empty() && queue.capacity() == 64);
+
+    std::cout << "✓ SPSC queue test passed" << std::endl;
+}
+
+// the sharded engine must end in exactly the state a single-threaded
+// engine reaches on the same flow, with the same fills per symbol in the
+// same order
+void test_sharded_engine() {
+    std::cout << "\n=== Test: Sharded Matching Engine ===" << std::endl;
+
+    const char* names[] = {"AAPL", "MSFT", "GOOGL", "TSLA", "AMZN", "META"};
+    const size_t symbol_count = 6;
+
+    ShardedMatchingEngine sharded(3, false, 256);
+    MatchingEngine reference;
+    for (size_t s = 0; s < symbol_count; ++s) {
+        OrderBookType type = s % 2 == 0 ? OrderBookType::BTREE : OrderBookType::PRICE_LADDER;
+        SymbolId id = sharded.create_order_book(Instrument(names[s]), type);
+        SymbolId reference_id = reference.create_order_book(Instrument(names[s]), type);
+        CHECK(id == reference_id);
+    }
+    CHECK(sharded.get_worker_of(0) == 0 && sharded.get_worker_of(4) == 1);
+
+    // each symbol lives on one worker, so its vector is only written there
+    std::vector<std::vector<Execution>> fills(symbol_count);
+    sharded.set_execution_handler([&fills](const Execution& e) { fills[e.symbol_id].push_back(e); });
+    bool submitted = sharded.submit_order(0, 1, BUY, 10000, 10);    // not running yet
+    CHECK(!submitted);
+    sharded.start();
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<Price> price_dist(9950, 10050);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 100);
+    std::vector<std::vector<Execution>> expected(symbol_count);
+    ExecutionRing executions;
+    const OrderType types[] = {LIMIT, LIMIT, LIMIT, IOC, FOK, MARKET};
+
+    for (Order::OrderId id = 1; id <= 30000; ++id) {
+        SymbolId symbol = SymbolId(rng() % symbol_count);
+        Side side = rng() & 1 ? BUY : SELL;
+        Price price = price_dist(rng);
+        Quantity qty = qty_dist(rng);
+        OrderType type = types[rng() % 6];
+        submitted = sharded.submit_order(symbol, id, side, price, qty, type);
+        CHECK(submitted);
+        reference.submit_order(symbol, id, side, price, qty, type, executions);
+
+        if (id % 5 == 0) {
+            bool cancelled = sharded.cancel_order(symbol, id - 20);
+            CHECK(cancelled);
+            reference.cancel_order(symbol, id - 20);
+        }
+        if (id % 7 == 0) {
+            Price amended = price_dist(rng);
+            bool queued = sharded.modify_order(symbol, id - 10, amended, qty);
+            CHECK(queued);
+            reference.modify_order(symbol, id - 10, amended, qty, executions);
+        }
+        executions.drain([&expected](const Execution& e) { expected[e.symbol_id].push_back(e); });
+    }
+    submitted = sharded.submit_order(INVALID_SYMBOL, 1, BUY, 10000, 10);
+    CHECK(!submitted);
+
+    sharded.flush();
+    size_t total_fills = 0;
+    for (SymbolId symbol = 0; symbol < symbol_count; ++symbol) {
+        CHECK(fills[symbol].size() == expected[symbol].size());
+        for (size_t i = 0; i < fills[symbol].size(); ++i) {
+            CHECK(fills[symbol][i].buy_order_id == expected[symbol][i].buy_order_id);
+            CHECK(fills[symbol][i].sell_order_id == expected[symbol][i].sell_order_id);
+            CHECK(fills[symbol][i].price == expected[symbol][i].price);
+            CHECK(fills[symbol][i].quantity == expected[symbol][i].quantity);
+        }
+        total_fills += fills[symbol].size();
+
+        OrderBook* book = sharded.get_order_book(symbol);
+        OrderBook* ref = reference.get_order_book(symbol);
+        CHECK(book->get_best_bid() == ref->get_best_bid() && book->get_best_ask() == ref->get_best_ask());
+        CHECK(book->get_bid_count() == ref->get_bid_count() && book->get_ask_count() == ref->get_ask_count());
+        CHECK(book->get_total_orders() == ref->get_total_orders());
+    }
+    CHECK(sharded.get_execution_count() == total_fills);
+    CHECK(total_fills > 0);
+
+    // an amend across the spread matches on the worker instead of leaving
+    // the book crossed, and its fill reaches the handler
+    OrderBook* crossed = sharded.get_order_book(0);
+    Price ask = crossed->get_best_ask();
+    CHECK(ask > 0);
+    Order::OrderId bid_id = 40000;
+    sharded.submit_order(0, bid_id, BUY, crossed->get_best_bid() > 0 ? crossed->get_best_bid() : ask - 10, 1);
+    sharded.flush();
+    size_t before = fills[0].size();
+    bool queued = sharded.modify_order(0, bid_id, ask + 5, 1);
+    CHECK(queued);
+    sharded.flush();
+    CHECK(fills[0].size() == before + 1 && fills[0].back().buy_order_id == bid_id && fills[0].back().price == ask);
+    CHECK(crossed->find_order(bid_id) == nullptr);
+    CHECK(crossed->get_best_bid() < crossed->get_best_ask() || crossed->get_best_ask() == 0);
+
+    sharded.stop();
+    submitted = sharded.submit_order(0, 1, BUY, 10000, 10);
+    CHECK(!submitted);
+
+    std::cout << "✓ Sharded matching engine test passed" << std::endl;
+}
+
+void test_mpsc_queue() {
+    std::cout << "\n=== Test: MPSC Queue ===" << std::endl;
+
+    // item = producer * count + sequence: each producer's items must come
+    // out in its own order, whatever the interleaving
+    MpscQueue<uint64_t> queue(64);
+    const uint64_t producers = 4;
+    const uint64_t count = 100000;
+    std::vector<std::thread> threads;
+    for (uint64_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            BackoffWait wait;
+            for (uint64_t i = 0; i < count; ++i) {
+                while (!queue.try_push(p * count + i)) {
+                    wait.wait();
+                }
+                wait.reset();
+            }
+        });
+    }
+
+    std::vector<uint64_t> next(producers, 0);
+    uint64_t received = 0;
+    uint64_t batch[16];
+    BackoffWait wait;
+    while (received < producers * count) {
+        size_t n = queue.pop_batch(batch, 16);
+        if (n == 0) {
+            wait.wait();
+            continue;
+        }
+        wait.reset();
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t p = batch[i] / count;
+            CHECK(batch[i] % count == next[p]);
+            ++next[p];
+        }
+        received += n;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bool popped = queue.try_pop(batch[0]);
+    CHECK(queue.empty() && !popped);
+
+    std::cout << "✓ MPSC queue test passed" << std::endl;
+}
+
+// Random add/cancel/modify flow over the given symbols; ids start at first_id
+std::vector<OrderCommand> make_command_flow(uint32_t seed, const std::vector<SymbolId>& symbols,
+                                            Order::OrderId first_id, size_t count) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<Price> price_dist(9950, 10050);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 100);
+    const OrderType types[] = {LIMIT, LIMIT, LIMIT, IOC, FOK, MARKET};
+    std::vector<OrderCommand> commands;
+    for (Order::OrderId id = first_id; id < first_id + count; ++id) {
+        SymbolId symbol = symbols[rng() % symbols.size()];
+        Side side = rng() & 1 ? BUY : SELL;
+        commands.push_back(OrderCommand{CommandType::ADD, types[rng() % 6],
+                                        OrderMessage{symbol, side, id, price_dist(rng), qty_dist(rng)}});
+        if (id % 5 == 0) {
+            commands.push_back(OrderCommand{CommandType::CANCEL, LIMIT, OrderMessage{symbol, BUY, id - 20, 0, 0}});
+        }
+        if (id % 7 == 0) {
+            commands.push_back(OrderCommand{CommandType::MODIFY, LIMIT,
+                                            OrderMessage{symbol, BUY, id - 10, price_dist(rng), qty_dist(rng)}});
+        }
+    }
+    return commands;
+}
+
+void apply_command(MatchingEngine& engine, const OrderCommand& c, ExecutionRing& executions) {
+    const OrderMessage& m = c.order;
+    switch (c.type) {
+    case CommandType::ADD:
+        engine.submit_order(m.symbol_id, m.order_id, m.side, m.price, m.quantity, c.order_type, executions);
+        break;
+    case CommandType::CANCEL:
+        engine.cancel_order(m.symbol_id, m.order_id);
+        break;
+    case CommandType::MODIFY:
+        engine.modify_order(m.symbol_id, m.order_id, m.price, m.quantity, executions);
+        break;
+    }
+}
+
+void assert_same_books(MatchingEngine& engine, MatchingEngine& reference, size_t symbol_count) {
+    for (SymbolId symbol = 0; symbol < symbol_count; ++symbol) {
+        OrderBook* book = engine.get_order_book(symbol);
+        OrderBook* ref = reference.get_order_book(symbol);
+        CHECK(book->get_best_bid() == ref->get_best_bid() && book->get_best_ask() == ref->get_best_ask());
+        CHECK(book->get_bid_count() == ref->get_bid_count() && book->get_ask_count() == ref->get_ask_count());
+        CHECK(book->get_total_orders() == ref->get_total_orders());
+    }
+}
+
+// a gateway-fed engine ends where direct calls leave an identical engine
+void test_order_gateway() {
+    std::cout << "\n=== Test: Order Gateway ===" << std::endl;
+
+    const char* names[] = {"AAPL", "MSFT", "GOOGL", "TSLA"};
+    std::vector<SymbolId> symbols = {0, 1, 2, 3};
+
+    // SPSC: one producer, the full flow in order, fills in the same order
+    {
+        MatchingEngine engine, reference;
+        for (const char* name : names) {
+            engine.create_order_book(Instrument(name));
+            reference.create_order_book(Instrument(name));
+        }
+        std::vector<Execution> fills;
+        size_t applied = 0;
+        SpscOrderGateway<BackoffWait> gateway(engine, 128);
+        gateway.set_execution_handler([&fills](const Execution& e) { fills.push_back(e); });
+        gateway.set_command_handler([&applied](const OrderCommand&) { ++applied; });
+
+        // the first command is queued before start
+        std::vector<OrderCommand> commands = make_command_flow(3, symbols, 1, 20000);
+        bool submitted = gateway.submit_order(0, 999999, BUY, 9000, 5);
+        CHECK(submitted);
+        gateway.start();
+        for (const OrderCommand& c : commands) {
+            bool sent = gateway.send(c);
+            CHECK(sent);
+        }
+        gateway.stop();
+        CHECK(gateway.get_commands_processed() == commands.size() + 1 && applied == commands.size() + 1);
+
+        std::vector<Execution> expected;
+        ExecutionRing executions;
+        reference.submit_order(0, 999999, BUY, 9000, 5, LIMIT, executions);
+        for (const OrderCommand& c : commands) {
+            apply_command(reference, c, executions);
+            executions.drain([&expected](const Execution& e) { expected.push_back(e); });
+        }
+        CHECK(fills.size() == expected.size() && !fills.empty());
+        for (size_t i = 0; i < fills.size(); ++i) {
+            CHECK(fills[i].buy_order_id == expected[i].buy_order_id);
+            CHECK(fills[i].sell_order_id == expected[i].sell_order_id);
+            CHECK(fills[i].quantity == expected[i].quantity && fills[i].price == expected[i].price);
+        }
+        assert_same_books(engine, reference, symbols.size());
+    }
+
+    // MPSC: one session per symbol, so each symbol still sees one ordered
+    // stream however the sessions interleave; driven through poll()
+    {
+        MatchingEngine engine, reference;
+        for (const char* name : names) {
+            engine.create_order_book(Instrument(name));
+            reference.create_order_book(Instrument(name));
+        }
+        MpscOrderGateway<BackoffWait> gateway(engine, 64);
+        std::vector<std::vector<OrderCommand>> flows;
+        size_t total = 0;
+        for (SymbolId symbol : symbols) {
+            flows.push_back(make_command_flow(10 + symbol, {symbol}, 1 + symbol * 100000, 5000));
+            total += flows.back().size();
+        }
+
+        std::vector<std::thread> sessions;
+        for (const auto& flow : flows) {
+            sessions.emplace_back([&gateway, &flow] {
+                for (const OrderCommand& c : flow) {
+                    gateway.send(c);
+                }
+            });
+        }
+        BackoffWait wait;
+        while (gateway.get_commands_processed() < total) {
+            if (gateway.poll() == 0) {
+                wait.wait();
+            } else {
+                wait.reset();
+            }
+        }
+        for (auto& session : sessions) {
+            session.join();
+        }
+        size_t leftover = gateway.poll();
+        CHECK(leftover == 0 && gateway.get_commands_processed() == total);
+
+        ExecutionRing executions;
+        for (const auto& flow : flows) {
+            for (const OrderCommand& c : flow) {
+                apply_command(reference, c, executions);
+            }
+        }
+        assert_same_books(engine, reference, symbols.size());
+    }
+
+    // an amend command across the spread matches instead of leaving the
+    // engine's book crossed
+    {
+        MatchingEngine engine;
+        engine.create_order_book(Instrument("AAPL"));
+        SpscOrderGateway<> gateway(engine, 16);
+        std::vector<Execution> fills;
+        gateway.set_execution_handler([&fills](const Execution& e) { fills.push_back(e); });
+        gateway.submit_order(0, 1, SELL, 10500, 10);
+        gateway.submit_order(0, 2, BUY, 10000, 4);
+        gateway.modify_order(0, 2, 11000, 4);
+        while (gateway.poll() > 0) {
+        }
+        CHECK(fills.size() == 1 && fills[0].buy_order_id == 2 && fills[0].sell_order_id == 1);
+        CHECK(fills[0].price == 10500 && fills[0].quantity == 4);
+        CHECK(engine.get_best_bid(0) == 0 && engine.get_best_ask(0) == 10500);
+    }
+
+    std::cout << "✓ Order gateway test passed" << std::endl;
+}
+
+// readers on other threads must never see a torn snapshot. Every order
+// rests with quantity = price - 9000, so a consistent side always has
+// size == (price - 9000) * orders at its best level
+void test_top_of_book_readers() {
+    std::cout << "\n=== Test: Concurrent Top of Book Readers ===" << std::endl;
+
+    BTreeOrderBook<> book("AAPL");
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    std::atomic<size_t> snapshots{0};
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&book, &done, &snapshots] {
+            uint64_t last_sequence = 0;
+            size_t taken = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                TopOfBook top = book.get_top_of_book();
+                CHECK(top.sequence >= last_sequence);
+                CHECK(top.bid_size == (top.bid_orders ? (top.bid_price - 9000) * top.bid_orders : 0));
+                CHECK(top.ask_size == (top.ask_orders ? (top.ask_price - 9000) * top.ask_orders : 0));
+                CHECK(top.bid_price == 0 || top.ask_price == 0 || top.bid_price < top.ask_price);
+                last_sequence = top.sequence;
+                ++taken;
+            }
+            snapshots += taken;
+        });
+    }
+
+    std::mt19937 rng(11);
+    for (Order::OrderId id = 1; id <= 200000; ++id) {
+        Price price = 9950 + Price(rng() % 50);
+        Side side = price < 9975 ? BUY : SELL;
+        book.add_order(id, side, price, price - 9000);
+        if (id > 500) {
+            book.cancel_order(id - 500);
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(snapshots.load() > 0);
+    CHECK(book.get_top_of_book().sequence == 200000 + 199500);
+
+    std::cout << "✓ Concurrent top of book readers test passed" << std::endl;
+}
+
+// a journal replayed into fresh books must rebuild exactly the books that
+// wrote it, through every entry path the engine journals
+void test_journal() {
+    std::cout << "\n=== Test: Journal ===" << std::endl;
+
+    const std::string path = "test_journal.bin";
+    std::remove(path.c_str());
+    const char* names[] = {"AAPL", "MSFT", "GOOGL"};
+    std::vector<SymbolId> symbols = {0, 1, 2};
+
+    MatchingEngine engine;
+    for (size_t s = 0; s < 3; ++s) {
+        engine.create_order_book(Instrument(names[s]), s == 1 ? OrderBookType::PRICE_LADDER : OrderBookType::BTREE);
+    }
+    size_t fills = 0;
+    size_t batch_accepted = 0;
+    {
+        Journal journal(path, 256);
+        CHECK(journal.is_open());
+        engine.set_journal(&journal);
+
+        // continuous adds, cancels and amends
+        ExecutionRing executions;
+        for (const OrderCommand& c : make_command_flow(5, symbols, 1, 5000)) {
+            apply_command(engine, c, executions);
+        }
+        fills += executions.size();
+
+        // an amend across the spread matches before it rests
+        executions.clear();
+        engine.submit_order(SymbolId(0), 30000, SELL, 10990, 5, LIMIT, executions);
+        engine.submit_order(SymbolId(0), 30001, BUY, 9000, 25, LIMIT, executions);
+        fills += executions.size();
+        executions.clear();
+        bool amended = engine.modify_order(SymbolId(0), 30001, 11000, 25, executions);
+        CHECK(amended && !executions.empty());
+        fills += executions.size();
+
+        // resting adds with explicit match passes
+        for (Order::OrderId id = 10000; id < 10200; ++id) {
+            engine.submit_order(SymbolId(id % 3), id, id % 2 ? BUY : SELL, 9990 + Price(id % 21), 10);
+            if (id % 10 == 0) {
+                fills += engine.match_orders(SymbolId(id % 3)).size();
+            }
+        }
+
+        // batches, including a refused duplicate id and an empty order,
+        // then batched cancels
+        std::vector<OrderMessage> batch;
+        std::vector<CancelMessage> cancels;
+        for (Order::OrderId id = 20000; id < 20300; ++id) {
+            batch.push_back(OrderMessage{SymbolId(id % 3), id % 2 ? BUY : SELL, id, 9990 + Price(id % 21), 7});
+            cancels.push_back(CancelMessage{SymbolId(id % 3), id - 150});
+        }
+        engine.submit_order(SymbolId(2), 20998, BUY, 8000, 5);
+        batch.push_back(OrderMessage{SymbolId(2), BUY, 20998, 8000, 5});
+        batch.push_back(OrderMessage{SymbolId(1), BUY, 20999, 9995, 0});
+        engine.set_batch_size(64);
+        executions.clear();
+        batch_accepted = engine.submit_batch(batch, executions);
+        CHECK(batch_accepted == batch.size() - 2);
+        engine.cancel_batch(cancels);
+        fills += executions.size();
+
+        journal.flush();
+        CHECK(journal.get_records_written() == journal.get_records_appended());
+        CHECK(journal.get_bytes_written() == journal.get_records_written() * sizeof(JournalRecord));
+        engine.set_journal(nullptr);
+    }
+
+    std::vector<JournalRecord> records;
+    bool read_back = Journal::read(path, records);
+    CHECK(read_back);
+    size_t trades = 0;
+    size_t batch_adds = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        CHECK(records[i].sequence == i);
+        trades += records[i].type == JournalRecordType::TRADE;
+        batch_adds += records[i].type == JournalRecordType::BATCH_ADD;
+    }
+    CHECK(trades == fills && fills > 0);
+    CHECK(batch_adds == batch_accepted);     // refused messages are not journaled
+
+    MatchingEngine recovered;
+    for (size_t s = 0; s < 3; ++s) {
+        recovered.create_order_book(Instrument(names[s]), s == 1 ? OrderBookType::PRICE_LADDER : OrderBookType::BTREE);
+    }
+    size_t replayed = replay_journal(path, recovered);
+    CHECK(replayed == records.size() - trades);
+    assert_same_books(recovered, engine, 3);
+    for (SymbolId symbol : symbols) {
+        auto bids = recovered.get_order_book(symbol)->get_bid_levels(50);
+        auto expected = engine.get_order_book(symbol)->get_bid_levels(50);
+        CHECK(bids.size() == expected.size());
+        for (size_t i = 0; i < bids.size(); ++i) {
+            CHECK(bids[i].price == expected[i].price && bids[i].quantity == expected[i].quantity);
+        }
+    }
+
+    // a record cut short by a crash is dropped on read
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    std::fwrite(&records.front(), 1, sizeof(JournalRecord) / 2, file);
+    std::fclose(file);
+    std::vector<JournalRecord> reread;
+    read_back = Journal::read(path, reread);
+    CHECK(read_back && reread.size() == records.size());
+
+    // reopening cuts the torn record off, so new records line up again
+    {
+        Journal reopened(path);
+        CHECK(reopened.is_open() && reopened.get_records_appended() == records.size());
+        JournalRecord record{JournalRecordType::CANCEL, 0, 0, 0, 1, 0, 4242, 0, 0, 0, 0};
+        reopened.append(record);
+        bool flushed = reopened.flush();
+        CHECK(flushed && !reopened.has_failed());
+    }
+    reread.clear();
+    read_back = Journal::read(path, reread);
+    CHECK(read_back && reread.size() == records.size() + 1);
+    CHECK(reread.back().sequence == records.size() && reread.back().order_id == 4242);
+    CHECK(reread.back().type == JournalRecordType::CANCEL && reread.back().symbol_id == 1);
+    CHECK(reread[records.size() - 1].sequence == records.size() - 1);
+
+#ifdef __linux__
+    // a full disk is reported, not swallowed: nothing counts as written
+    {
+        Journal full("/dev/full");
+        CHECK(full.is_open());
+        for (uint64_t id = 0; id < 10000; ++id) {
+            full.append(JournalRecord{JournalRecordType::CANCEL, 0, 0, 0, 0, 0, id, 0, 0, 0, 0});
+        }
+        bool flushed = full.flush();
+        CHECK(!flushed && full.has_failed() && full.get_records_written() == 0);
+        full.append(JournalRecord{});   // dropped, and does not block
+    }
+#endif
+
+    std::remove(path.c_str());
+    std::cout << "✓ Journal test passed" << std::endl;
+}
+
+// snapshot file plus the journal written after it rebuild the engine
+void test_snapshot_file() {
+    std::cout << "\n=== Test: Snapshot File ===" << std::endl;
+
+    const std::string snapshot_path = "test_snapshot.bin";
+    const std::string journal_path = "test_snapshot_journal.bin";
+    std::remove(snapshot_path.c_str());
+    std::remove(journal_path.c_str());
+    std::vector<SymbolId> symbols = {0, 1, 2};
+    auto make_engine = [](MatchingEngine& engine) {
+        engine.create_order_book("AAPL", std::make_unique<BTreeOrderBook<3>>("AAPL"));
+        engine.create_order_book(Instrument("MSFT"), OrderBookType::PRICE_LADDER);
+        engine.create_order_book(Instrument("GOOGL"));
+    };
+
+    MatchingEngine engine;
+    make_engine(engine);
+    uint64_t trade_id_before;
+    {
+        Journal journal(journal_path, 256);
+        engine.set_journal(&journal);
+        ExecutionRing executions;
+        for (const OrderCommand& c : make_command_flow(21, symbols, 1, 6000)) {
+            apply_command(engine, c, executions);
+        }
+        bool written = write_snapshot(snapshot_path, engine);
+        CHECK(written);
+        trade_id_before = engine.get_order_book(0)->get_next_trade_id();
+        for (const OrderCommand& c : make_command_flow(22, symbols, 100000, 2000)) {
+            apply_command(engine, c, executions);
+        }
+        engine.set_journal(nullptr);
+    }
+
+    MatchingEngine recovered;
+    make_engine(recovered);
+    uint64_t sequence = 0;
+    bool restored = restore_snapshot(snapshot_path, recovered, &sequence);
+    CHECK(restored && sequence > 0);
+    CHECK(recovered.get_order_book(0)->get_next_trade_id() == trade_id_before);
+    restored = restore_snapshot(snapshot_path, recovered);     // books are no longer empty
+    CHECK(!restored);
+    replay_journal(journal_path, recovered, sequence);
+    // the processed counters start again from the snapshot, so compare what rests
+    for (SymbolId symbol : symbols) {
+        std::vector<SnapshotOrder> expected, actual;
+        engine.get_order_book(symbol)->export_orders(expected);
+        recovered.get_order_book(symbol)->export_orders(actual);
+        CHECK(expected.size() == actual.size() && !expected.empty());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            CHECK(actual[i].order_id == expected[i].order_id && actual[i].price == expected[i].price);
+            CHECK(actual[i].remaining_quantity == expected[i].remaining_quantity);
+        }
+        CHECK(recovered.get_order_book(symbol)->get_next_trade_id() ==
+               engine.get_order_book(symbol)->get_next_trade_id());
+    }
+    CHECK(static_cast<BTreeOrderBook<3>*>(recovered.get_order_book(0))->check_invariants());
+
+    // unknown symbols and foreign files are refused, before any book is
+    // loaded: AAPL comes first in the file and stays empty
+    MatchingEngine other;
+    other.create_order_book(Instrument("AAPL"));
+    restored = restore_snapshot(snapshot_path, other);
+    CHECK(!restored && other.get_order_book(0)->get_total_orders() == 0);
+    restored = restore_snapshot(journal_path, other);
+    CHECK(!restored);
+    restored = restore_snapshot("no_such_snapshot.bin", other);
+    CHECK(!restored);
+
+    // a refusal on the last book leaves the earlier ones untouched
+    MatchingEngine partial;
+    make_engine(partial);
+    partial.submit_order(2, 1, BUY, 9000, 5);
+    restored = restore_snapshot(snapshot_path, partial);
+    CHECK(!restored);
+    CHECK(partial.get_order_book(0)->get_total_orders() == 0 && partial.get_order_book(1)->get_total_orders() == 0);
+    CHECK(partial.get_order_book(0)->get_next_trade_id() == 1);
+
+    // books that held orders and were drained count as empty, even though
+    // their processed counters have moved on
+    MatchingEngine drained;
+    make_engine(drained);
+    for (SymbolId symbol : symbols) {
+        drained.submit_order(symbol, 1, BUY, 9000, 5);
+        drained.submit_order(symbol, 2, SELL, 9100, 5);
+        drained.cancel_order(symbol, 1);
+        drained.cancel_order(symbol, 2);
+        CHECK(drained.get_order_book(symbol)->get_total_orders() != 0);
+    }
+    restored = restore_snapshot(snapshot_path, drained);
+    CHECK(restored);
+    MatchingEngine fresh;
+    make_engine(fresh);
+    restored = restore_snapshot(snapshot_path, fresh);
+    CHECK(restored);
+    for (SymbolId symbol : symbols) {
+        std::vector<SnapshotOrder> expected, actual;
+        fresh.get_order_book(symbol)->export_orders(expected);
+        drained.get_order_book(symbol)->export_orders(actual);
+        CHECK(expected.size() == actual.size() && !expected.empty());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            CHECK(actual[i].order_id == expected[i].order_id && actual[i].price == expected[i].price);
+        }
+    }
+
+    // a B-tree side wider than a ladder's window cap is refused up front,
+    // rather than restored with the far orders missing
+    const std::string wide_path = "test_snapshot_wide.bin";
+    MatchingEngine wide;
+    wide.create_order_book(Instrument("AAPL"));
+    wide.create_order_book(Instrument("MSFT"));
+    wide.submit_order(0, 1, BUY, 10000, 5);
+    wide.submit_order(1, 2, BUY, 100000, 5);
+    wide.submit_order(1, 3, BUY, 100000 - Price(PriceLadderOrderBook::DEFAULT_MAX_WINDOW_TICKS), 5);
+    wide.submit_order(1, 4, SELL, 200000, 5);
+    bool wide_written = write_snapshot(wide_path, wide);
+    CHECK(wide_written);
+    MatchingEngine narrow;
+    narrow.create_order_book(Instrument("AAPL"));
+    narrow.create_order_book(Instrument("MSFT"), OrderBookType::PRICE_LADDER);
+    restored = restore_snapshot(wide_path, narrow);
+    CHECK(!restored);
+    CHECK(narrow.get_order_book(0)->get_bid_count() == 0 && narrow.get_order_book(1)->get_bid_count() == 0);
+    std::vector<SnapshotOrder> wide_orders;
+    wide.get_order_book(1)->export_orders(wide_orders);
+    bool loaded = narrow.get_order_book(1)->load_orders(wide_orders.data(), wide_orders.size());
+    CHECK(!loaded && narrow.get_order_book(1)->get_ask_count() == 0);
+    // a ladder with a wider cap takes it
+    MatchingEngine roomy;
+    roomy.create_order_book(Instrument("AAPL"));
+    roomy.create_order_book("MSFT", std::make_unique<PriceLadderOrderBook>(
+                                        "MSFT", 4096, 4 * PriceLadderOrderBook::DEFAULT_MAX_WINDOW_TICKS));
+    restored = restore_snapshot(wide_path, roomy);
+    CHECK(restored);
+    CHECK(roomy.get_order_book(1)->get_bid_count() == 2 && roomy.get_order_book(1)->get_ask_count() == 1);
+    CHECK(roomy.get_order_book(1)->get_best_bid() == 100000 && roomy.get_order_book(1)->get_best_ask() == 200000);
+    std::remove(wide_path.c_str());
+
+    // and so does an out-of-order sequence in it: the file's last order, an
+    // ask, turned into a bid
+    std::vector<char> bytes;
+    {
+        utils::MappedFile mapped(snapshot_path);
+        bytes.assign(mapped.data(), mapped.data() + mapped.size());
+    }
+    SnapshotOrder last;
+    std::memcpy(&last, bytes.data() + bytes.size() - sizeof(last), sizeof(last));
+    CHECK(last.side == SELL);
+    last.side = BUY;
+    std::memcpy(bytes.data() + bytes.size() - sizeof(last), &last, sizeof(last));
+    std::FILE* corrupt = std::fopen(snapshot_path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), corrupt);
+    std::fclose(corrupt);
+    MatchingEngine unordered;
+    make_engine(unordered);
+    restored = restore_snapshot(snapshot_path, unordered);
+    CHECK(!restored);
+    for (SymbolId symbol : symbols) {
+        CHECK(unordered.get_order_book(symbol)->get_total_orders() == 0);
+    }
+
+    std::remove(snapshot_path.c_str());
+    std::remove(journal_path.c_str());
+    std::cout << "✓ Snapshot file test passed" << std::endl;
+}
+
+void test_order_file() {
+    std::cout << "\n=== Test: Order File ===" << std::endl;
+
+    const std::string csv_path = "test_orders.csv";
+    const std::string bin_path = "test_orders.bin";
+    // columns in the downloader's order, one Windows line ending, two bad
+    // rows and a fractional size that rounds to 3 lots of 0.001
+    std::FILE* csv = std::fopen(csv_path.c_str(), "wb");
+    std::fputs("order_id,timestamp,symbol,side,price,quantity\r\n"
+               "1,1700000000000000,AAPL,BUY,150.01,100\n"
+               "2,1700000000000250,MSFT,SELL,400.5,7\n"
+               "3,1700000000000500,AAPL,SELL,149.999,12\n"
+               "4,1700000000000750,AAPL,HOLD,150.00,5\n"
+               "5,not_a_time,MSFT,BUY,400.00,5\n"
+               "\n"
+               "6,1700000000001000,BTCUSDT,buy,67000.12,0.0031", csv);
+    std::fclose(csv);
+
+    size_t skipped = 0;
+    bool converted = convert_order_csv(csv_path, bin_path, 0.01, 0.001, &skipped);
+    CHECK(converted);
+    CHECK(skipped == 2);
+    {
+        OrderFile file(bin_path);
+        CHECK(file.is_open() && file.size() == 4);
+        CHECK(file.symbols().size() == 3 && file.symbols()[0] == "AAPL" && file.symbols()[2] == "BTCUSDT");
+        CHECK(file.tick_size() == 0.01 && file.lot_size() == 0.001);
+        const OrderFileRecord* r = file.records();
+        CHECK(r[0].order_id == 1 && r[0].timestamp_us == 1700000000000000ULL && r[0].symbol == 0);
+        CHECK(r[0].side == BUY && r[0].price == 15001 && r[0].quantity == 100000);
+        CHECK(r[1].symbol == 1 && r[1].side == SELL && r[1].price == 40050 && r[1].quantity == 7000);
+        CHECK(r[2].price == 15000 && r[2].symbol == 0);
+        CHECK(r[3].symbol == 2 && r[3].side == BUY && r[3].price == 6700012 && r[3].quantity == 3);
+
+        // the records feed the engine directly
+        MatchingEngine engine;
+        for (const std::string& name : file.symbols()) {
+            engine.create_order_book(Instrument(name, file.tick_size(), file.lot_size()));
+        }
+        ExecutionRing executions;
+        for (size_t i = 0; i < file.size(); ++i) {
+            bool submitted = engine.submit_order(SymbolId(r[i].symbol), r[i].order_id, Side(r[i].side), r[i].price,
+                                                 r[i].quantity, LIMIT, executions);
+            CHECK(submitted);
+        }
+        CHECK(executions.size() == 1 && executions[0].price == 15001 && executions[0].quantity == 12000);
+    }
+
+    // ids and timestamps past uint64_t are bad rows, not wrapped values
+    csv = std::fopen(csv_path.c_str(), "wb");
+    std::fputs("order_id,timestamp,symbol,side,price,quantity\n"
+               "18446744073709551615,1,AAPL,BUY,1.00,1\n"
+               "18446744073709551616,2,AAPL,BUY,1.00,1\n"
+               "3,100000000000000000000,AAPL,BUY,1.00,1\n"
+               "4,1e20,AAPL,BUY,1.00,1\n", csv);
+    std::fclose(csv);
+    converted = convert_order_csv(csv_path, bin_path, 0.01, 0.001, &skipped);
+    CHECK(converted && skipped == 3);
+    {
+        OrderFile file(bin_path);
+        CHECK(file.size() == 1 && file.records()[0].order_id == 18446744073709551615ULL);
+    }
+
+    // an empty file, a missing column, a missing file and a foreign file are refused
+    csv = std::fopen(csv_path.c_str(), "wb");
+    std::fputs("order_id,timestamp,symbol,side,price\n1,0,AAPL,BUY,1.00\n", csv);
+    std::fclose(csv);
+    converted = convert_order_csv(csv_path, bin_path);
+    CHECK(!converted);
+    csv = std::fopen(csv_path.c_str(), "wb");
+    std::fclose(csv);
+    converted = convert_order_csv(csv_path, bin_path);
+    CHECK(!converted);
+    converted = convert_order_csv("no_such_orders.csv", bin_path);
+    CHECK(!converted);
+    CHECK(!OrderFile("no_such_orders.bin").is_open());
+    CHECK(!OrderFile(csv_path).is_open());
+
+    std::remove(csv_path.c_str());
+    std::remove(bin_path.c_str());
+    std::cout << "✓ Order file test passed" << std::endl;
+}
+
+#ifdef TEST_HAS_POSIX_SOCKETS
+// a browser stand-in: a plain socket on the server's port
+int connect_local(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int connected = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    CHECK(connected == 0);
+    return fd;
+}
+
+void send_request(int fd, const std::string& request) {
+    ssize_t sent = ::send(fd, request.data(), request.size(), 0);
+    CHECK(sent == ssize_t(request.size()));
+}
+
+// reads into received until it ends with suffix (or, for an empty suffix,
+// the server closes); false on timeout
+bool read_until(int fd, std::string& received, const std::string& suffix, int timeout_ms = 5000) {
+    char buffer[65536];
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!suffix.empty() && received.size() >= suffix.size() &&
+            received.compare(received.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            return true;
+        }
+        pollfd entry{fd, POLLIN, 0};
+        if (::poll(&entry, 1, 50) <= 0) {
+            continue;
+        }
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return suffix.empty();
+        }
+        received.append(buffer, size_t(n));
+    }
+    return false;
+}
+
+template <typename Condition>
+bool wait_for(Condition condition, int timeout_ms = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+size_t count_of(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+        ++count;
+    }
+    return count;
+}
+#endif
+
+void test_push_server() {
+    std::cout << "\n=== Test: Push Server ===" << std::endl;
+#ifdef TEST_HAS_POSIX_SOCKETS
+    const std::string page_path = "test_push_page.html";
+    std::FILE* page = std::fopen(page_path.c_str(), "wb");
+    std::fputs("<html>live book</html>", page);
+    std::fclose(page);
+
+    PushServer server(0, page_path);
+    bool started = server.start();
+    CHECK(started && server.is_running() && server.get_port() != 0);
+    // the port is taken while it runs
+    PushServer second(server.get_port(), page_path);
+    started = second.start();
+    CHECK(!started);
+
+    // plain requests get one response and a close
+    std::string received;
+    int fd = connect_local(server.get_port());
+    send_request(fd, "GET /?t=1 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    bool arrived = read_until(fd, received, "");
+    CHECK(arrived);
+    CHECK(received.find("HTTP/1.1 200 OK") == 0 && received.find("\r\n\r\n<html>live book</html>") != std::string::npos);
+    ::close(fd);
+    received.clear();
+    fd = connect_local(server.get_port());
+    send_request(fd, "GET /data/orderbook.json HTTP/1.1\r\n\r\n");
+    arrived = read_until(fd, received, "");
+    CHECK(arrived && received.find("HTTP/1.1 404") == 0);
+    ::close(fd);
+    received.clear();
+    fd = connect_local(server.get_port());
+    send_request(fd, "POST /events HTTP/1.1\r\n\r\n");
+    arrived = read_until(fd, received, "");
+    CHECK(arrived && received.find("HTTP/1.1 405") == 0);
+    ::close(fd);
+
+    // two streams: one keeps up, one never reads until the end
+    int fast = connect_local(server.get_port());
+    int slow = connect_local(server.get_port());
+    std::string fast_received, slow_received;
+    send_request(fast, "GET /events HTTP/1.1\r\n\r\n");
+    send_request(slow, "GET /events HTTP/1.1\r\n\r\n");
+    arrived = read_until(fast, fast_received, "retry: 1000\n\n");
+    CHECK(arrived);
+    arrived = read_until(slow, slow_received, "retry: 1000\n\n");
+    CHECK(arrived);
+    CHECK(fast_received.find("Content-Type: text/event-stream") != std::string::npos);
+    bool settled = wait_for([&server] { return server.get_client_count() == 2; });
+    CHECK(settled);
+
+    // a frame spanning lines arrives as one event
+    server.publish("{\"bestBid\": 1}\n{\"bestAsk\": 2}");
+    fast_received.clear();
+    arrived = read_until(fast, fast_received, "data: {\"bestBid\": 1}\ndata: {\"bestAsk\": 2}\n\n");
+    CHECK(arrived);
+    settled = wait_for([&server] { return server.get_frames_sent() == 2; });
+    CHECK(settled);
+
+    // a burst far bigger than the socket buffers: each stream ends on the
+    // newest frame, having skipped what it could not take in time
+    const int burst = 500;
+    const std::string filler(64 * 1024, 'x');
+    for (int i = 0; i < burst; ++i) {
+        server.publish(filler);
+        if (i % 10 == 0) {
+            std::string ignored;
+            read_until(fast, ignored, "\n\n", 1);
+        }
+    }
+    server.publish("last");
+    fast_received.clear();
+    arrived = read_until(fast, fast_received, "data: last\n\n");
+    CHECK(arrived);
+    arrived = read_until(slow, slow_received, "data: last\n\n");
+    CHECK(arrived);
+    CHECK(count_of(slow_received, "data: ") < size_t(burst));
+    CHECK(server.get_frames_published() == size_t(burst) + 2);
+    CHECK(server.get_frames_conflated() > 0);
+    CHECK(server.get_frames_sent() + server.get_frames_conflated() == 2 * (size_t(burst) + 2));
+
+    // a closed browser is noticed and forgotten
+    ::close(fast);
+    settled = wait_for([&server] { return server.get_client_count() == 1; });
+    CHECK(settled);
+
+    // stopping closes the remaining stream
+    server.stop();
+    CHECK(!server.is_running() && server.get_client_count() == 0);
+    std::string tail;
+    arrived = read_until(slow, tail, "");
+    CHECK(arrived);
+    ::close(slow);
+    std::remove(page_path.c_str());
+    std::cout << "✓ Push server test passed" << std::endl;
+#else
+    std::cout << "(skipped: no POSIX sockets)" << std::endl;
+#endif
+}
+
 int main() {
     try {
         OrderMatchingTester tester;
         tester.run_all_tests();
 
         test_matching_engine();
+        test_spsc_queue();
+        test_sharded_engine();
+        test_mpsc_queue();
+        test_order_gateway();
+        test_top_of_book_readers();
+        test_journal();
+        test_snapshot_file();
+        test_order_file();
+        test_push_server();
 
         std::cout << "\n========================================" << std::endl;
         std::cout << "All tests completed successfully!" << std::endl;